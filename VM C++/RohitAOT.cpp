@@ -0,0 +1,317 @@
+// RohitAOT.cpp
+// This file implements the ahead-of-time translator (RohitVM bytecode -> C++).
+// The translator walks the program exactly the way the interpreter would
+// fetch it and prints one small block of C++ per guest instruction.
+
+#include "RohitAOT.hpp"
+#include <sstream>       // For building the generated source
+#include <set>           // Reachable instructions, return points, referenced labels
+#include <cstdio>        // For snprintf
+
+namespace {
+
+    // -------------------------------
+    // Function: hex4
+    // Purpose: Formats a 16-bit value as 0x1234 for the generated code
+    std::string hex4(uint16_t v) {
+        char buf[8];
+        snprintf(buf, sizeof(buf), "0x%04x", v);
+        return buf;
+    }
+
+    // -------------------------------
+    // Function: mnemonic
+    // Purpose: Instruction name for the comment above each translated block
+    const char* mnemonic(Opcode op) {
+        switch (op) {
+            case Opcode::NOP: return "NOP";        case Opcode::HLT: return "HLT";
+            case Opcode::MOV: return "MOV AX,";    case Opcode::MOV_BX: return "MOV BX,";
+            case Opcode::MOV_CX: return "MOV CX,"; case Opcode::MOV_DX: return "MOV DX,";
+            case Opcode::MOV_SP: return "MOV SP,";
+            case Opcode::STE: return "STE"; case Opcode::CLE: return "CLE";
+            case Opcode::STG: return "STG"; case Opcode::CLG: return "CLG";
+            case Opcode::STH: return "STH"; case Opcode::CLH: return "CLH";
+            case Opcode::STL: return "STL"; case Opcode::CLL: return "CLL";
+            case Opcode::PUSH: return "PUSH"; case Opcode::POP: return "POP";
+            case Opcode::PUSHF: return "PUSHF"; case Opcode::POPF: return "POPF";
+            case Opcode::ADD: return "ADD"; case Opcode::SUB: return "SUB";
+            case Opcode::MUL: return "MUL"; case Opcode::DIV: return "DIV";
+            case Opcode::CMP: return "CMP";
+            case Opcode::JMP: return "JMP"; case Opcode::CALL: return "CALL";
+            case Opcode::RET: return "RET";
+            case Opcode::JE: return "JE";   case Opcode::JNE: return "JNE";
+            case Opcode::JG: return "JG";   case Opcode::JL: return "JL";
+            case Opcode::IN: return "IN"; case Opcode::OUT: return "OUT";
+            case Opcode::BSWAP16: return "BSWAP16"; case Opcode::BSWAP32: return "BSWAP32";
+            case Opcode::BSWAP64: return "BSWAP64";
+            case Opcode::BRK: return "BRK";
+        }
+        return "???";
+    }
+
+    const char* regName[4] = {"ax", "bx", "cx", "dx"};
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Function: AotTranslator::translate
+// Purpose: Emits the C++ function for the image.
+std::string AotTranslator::translate(const uint8_t* image, uint16_t size,
+                                     const std::string& functionName) {
+    std::ostringstream out;
+
+    // Bytes past the image read as zero, just like freshly loaded VM memory
+    auto byteAt = [&](uint32_t addr) -> uint8_t { return addr < size ? image[addr] : 0; };
+
+    out << "Trap " << functionName << "(Registers& r, Memory& m) {\n";
+    out << "    // Guest registers are kept in locals and written back on exit\n";
+    out << "    uint16_t ax = r.ax, bx = r.bx, cx = r.cx, dx = r.dx;\n";
+    out << "    uint16_t sp = r.sp, flags = r.flags;\n";
+    out << "    uint8_t* mem = m.raw();\n";
+    out << "    (void)mem;\n\n";
+    out << "    auto leave = [&](uint16_t ip, Trap trap) {\n";
+    out << "        r.ax = ax; r.bx = bx; r.cx = cx; r.dx = dx;\n";
+    out << "        r.sp = sp; r.ip = ip; r.flags = flags;\n";
+    out << "        return trap;\n";
+    out << "    };\n\n";
+
+    // ----------- Find every reachable instruction -----------
+    // Follows fall-through, jump/call targets and CALL return points, exactly
+    // like the interpreter would. Addresses past the image aren't followed.
+    std::set<uint32_t> reachable;       // Instruction addresses (ordered, for emission)
+    std::set<uint32_t> returnPoints;
+    std::vector<uint32_t> work{0};
+    while (!work.empty()) {
+        uint32_t ip = work.back();
+        work.pop_back();
+        if (ip >= size || reachable.count(ip)) continue;
+        reachable.insert(ip);
+
+        Opcode op = static_cast<Opcode>(image[ip]);
+        uint8_t len = VM::getInstructionSize(op);
+        if (len == 0) continue;                       // Illegal: execution stops here
+        uint16_t a1 = (len >= 3) ? (byteAt(ip + 1) | (byteAt(ip + 2) << 8)) : 0;
+
+        bool conditional = op == Opcode::JE || op == Opcode::JNE || op == Opcode::JG || op == Opcode::JL;
+        if (op == Opcode::JMP || op == Opcode::CALL || conditional) work.push_back(a1);
+        if (op == Opcode::CALL) returnPoints.insert(ip + len);
+        bool regOperand = op == Opcode::PUSH || op == Opcode::POP ||
+                          op == Opcode::IN || op == Opcode::OUT;
+        bool stops = op == Opcode::HLT || op == Opcode::JMP || op == Opcode::RET ||
+                     (regOperand && a1 > 3);
+        if (!stops) work.push_back(ip + len);
+    }
+
+    // ----------- Translate each instruction -----------
+    std::set<uint32_t> labels;   // Addresses some goto refers to
+    bool usesIo = false;         // Any IN/OUT translated (needs the host hooks)
+    std::vector<std::pair<uint32_t, std::string>> blocks;
+
+    // Control transfer to 'addr': a goto, or an exit if it leaves the image
+    auto jumpTo = [&](uint32_t addr) -> std::string {
+        if (addr >= size)
+            return "return leave(" + hex4(static_cast<uint16_t>(addr)) + ", Trap::IllegalInstruction); // past end of image\n";
+        labels.insert(addr);
+        return "goto L_" + hex4(static_cast<uint16_t>(addr)).substr(2) + ";\n";
+    };
+
+    for (auto it = reachable.begin(); it != reachable.end(); ++it) {
+        uint32_t ip = *it;
+        std::ostringstream code;
+
+        Opcode op = static_cast<Opcode>(image[ip]);
+        uint8_t len = VM::getInstructionSize(op);
+        if (len == 0) {
+            // The interpreter doesn't advance IP past an unknown opcode
+            code << "    // " << hex4(ip) << ": illegal opcode " << int(image[ip]) << "\n";
+            code << "    return leave(" << hex4(ip) << ", Trap::IllegalInstruction);\n";
+            blocks.emplace_back(ip, code.str());
+            continue;
+        }
+
+        uint16_t a1 = 0, a2 = 0;
+        if (len >= 3) a1 = byteAt(ip + 1) | (byteAt(ip + 2) << 8);
+        if (len == 5) a2 = byteAt(ip + 3) | (byteAt(ip + 4) << 8);
+        uint32_t nextIp = ip + len;
+        std::string next = hex4(static_cast<uint16_t>(nextIp));
+
+        code << "    // " << hex4(ip) << ": " << mnemonic(op);
+        if (len >= 3) code << " " << hex4(a1);
+        if (len == 5) code << ", " << hex4(a2);
+        code << "\n";
+
+        bool fallsThrough = true;
+        switch (op) {
+            case Opcode::NOP: break;
+            case Opcode::HLT:
+                code << "    return leave(" << next << ", Trap::None);\n";
+                fallsThrough = false;
+                break;
+
+            case Opcode::MOV:    code << "    ax = " << hex4(a1) << ";\n"; break;
+            case Opcode::MOV_BX: code << "    bx = " << hex4(a1) << ";\n"; break;
+            case Opcode::MOV_CX: code << "    cx = " << hex4(a1) << ";\n"; break;
+            case Opcode::MOV_DX: code << "    dx = " << hex4(a1) << ";\n"; break;
+            case Opcode::MOV_SP: code << "    sp = " << hex4(a1) << ";\n"; break;
+
+            case Opcode::STE: code << "    flags |= Registers::Equal;\n"; break;
+            case Opcode::CLE: code << "    flags &= ~Registers::Equal;\n"; break;
+            case Opcode::STG: code << "    flags |= Registers::Greater;\n"; break;
+            case Opcode::CLG: code << "    flags &= ~Registers::Greater;\n"; break;
+            case Opcode::STH: code << "    flags |= Registers::Higher;\n"; break;
+            case Opcode::CLH: code << "    flags &= ~Registers::Higher;\n"; break;
+            case Opcode::STL: code << "    flags |= Registers::Lower;\n"; break;
+            case Opcode::CLL: code << "    flags &= ~Registers::Lower;\n"; break;
+
+            case Opcode::PUSH:
+                if (a1 > 3) {
+                    code << "    return leave(" << next << ", Trap::InvalidRegister);\n";
+                    fallsThrough = false;
+                    break;
+                }
+                code << "    if (sp < 2) return leave(" << next << ", Trap::StackOverflow);\n";
+                code << "    sp -= 2;\n";
+                code << "    mem[sp] = " << regName[a1] << " & 0xff;\n";
+                code << "    mem[uint16_t(sp + 1)] = " << regName[a1] << " >> 8;\n";
+                break;
+
+            case Opcode::POP:
+                if (a1 > 3) {
+                    code << "    return leave(" << next << ", Trap::InvalidRegister);\n";
+                    fallsThrough = false;
+                    break;
+                }
+                code << "    if (sp > 0xfffe) return leave(" << next << ", Trap::StackUnderflow);\n";
+                code << "    " << regName[a1] << " = mem[sp] | (mem[uint16_t(sp + 1)] << 8);\n";
+                code << "    sp += 2;\n";
+                break;
+
+            case Opcode::PUSHF:
+                code << "    if (sp < 2) return leave(" << next << ", Trap::StackOverflow);\n";
+                code << "    sp -= 2;\n";
+                code << "    mem[sp] = flags & 0xff;\n";
+                code << "    mem[uint16_t(sp + 1)] = flags >> 8;\n";
+                break;
+
+            case Opcode::POPF:
+                code << "    if (sp > 0xfffe) return leave(" << next << ", Trap::StackUnderflow);\n";
+                code << "    flags = (mem[sp] | (mem[uint16_t(sp + 1)] << 8)) & Registers::AllFlags;\n";
+                code << "    sp += 2;\n";
+                break;
+
+            // The flags are computed eagerly here: the host compiler drops
+            // the ones nothing reads, which is what lazy flags do at runtime
+            case Opcode::ADD: code << "    flags = CPU::flagsFor(FlagOp::Add, ax, bx);\n    ax += bx;\n"; break;
+            case Opcode::SUB: code << "    flags = CPU::flagsFor(FlagOp::Sub, ax, bx);\n    ax -= bx;\n"; break;
+            case Opcode::MUL: code << "    flags = CPU::flagsFor(FlagOp::Mul, ax, bx);\n    ax *= bx;\n"; break;
+            case Opcode::CMP: code << "    flags = CPU::flagsFor(FlagOp::Sub, ax, bx);\n"; break;
+            case Opcode::DIV:
+                code << "    if (bx == 0) return leave(" << next << ", Trap::DivideByZero);\n";
+                code << "    ax /= bx;\n";
+                break;
+
+            case Opcode::JMP:
+                code << "    " << jumpTo(a1);
+                fallsThrough = false;
+                break;
+
+            case Opcode::JE:  code << "    if (flags & Registers::Equal) " << jumpTo(a1); break;
+            case Opcode::JNE: code << "    if (!(flags & Registers::Equal)) " << jumpTo(a1); break;
+            case Opcode::JG:  code << "    if (flags & Registers::Greater) " << jumpTo(a1); break;
+            case Opcode::JL:  code << "    if (flags & Registers::Lower) " << jumpTo(a1); break;
+
+            case Opcode::CALL:
+                code << "    if (sp < 2) return leave(" << next << ", Trap::StackOverflow);\n";
+                code << "    sp -= 2;\n";
+                code << "    mem[sp] = " << hex4(nextIp & 0xff) << ";\n";
+                code << "    mem[uint16_t(sp + 1)] = " << hex4(nextIp >> 8) << ";\n";
+                code << "    " << jumpTo(a1);
+                fallsThrough = false;
+                break;
+
+            case Opcode::RET:
+                // Dispatch on the popped address; the translated return points
+                // are the only places a RET can continue in this function.
+                code << "    if (sp > 0xfffe) return leave(" << next << ", Trap::StackUnderflow);\n";
+                code << "    {\n";
+                code << "        uint16_t target = mem[sp] | (mem[uint16_t(sp + 1)] << 8);\n";
+                code << "        sp += 2;\n";
+                code << "        switch (target) {\n";
+                for (uint32_t rp : returnPoints)
+                    code << "            case " << hex4(static_cast<uint16_t>(rp)) << ": " << jumpTo(rp);
+                code << "        }\n";
+                code << "        return leave(target, Trap::IllegalInstruction); // not a return point\n";
+                code << "    }\n";
+                fallsThrough = false;
+                break;
+
+            case Opcode::IN:
+            case Opcode::OUT:
+                if (a1 > 3) {
+                    code << "    return leave(" << next << ", Trap::InvalidRegister);\n";
+                    fallsThrough = false;
+                    break;
+                }
+                usesIo = true;
+                if (op == Opcode::IN)
+                    code << "    " << regName[a1] << " = rohit_aot_in(" << hex4(a2) << ");\n";
+                else
+                    code << "    rohit_aot_out(" << hex4(a2) << ", " << regName[a1] << ");\n";
+                break;
+
+            case Opcode::BSWAP16:
+            case Opcode::BSWAP32:
+            case Opcode::BSWAP64: {
+                // Same bounds rule as the interpreter (no wraparound), then
+                // the vectorized swap straight on the memory image
+                int width = op == Opcode::BSWAP16 ? 2 : op == Opcode::BSWAP32 ? 4 : 8;
+                code << "    if (uint32_t(dx) + uint32_t(cx) * " << width
+                     << " > 0x10000) return leave(" << next << ", Trap::MemoryFault);\n";
+                code << "    RohitUtils::bswap" << width * 8 << "(mem + dx, mem + dx, cx);\n";
+                break;
+            }
+
+            case Opcode::BRK:
+                // No debugger in translated code: leave with IP on the BRK
+                code << "    return leave(" << hex4(ip) << ", Trap::Breakpoint);\n";
+                fallsThrough = false;
+                break;
+        }
+
+        // Fall-through is free only if the next instruction is emitted right after this one
+        if (fallsThrough) {
+            auto following = std::next(it);
+            if (following == reachable.end() || *following != nextIp)
+                code << "    " << jumpTo(nextIp);
+        }
+        blocks.emplace_back(ip, code.str());
+    }
+
+    if (size == 0) out << "    return leave(0x0000, Trap::IllegalInstruction); // empty image\n";
+    for (const auto& [ip, code] : blocks) {
+        if (labels.count(ip)) out << "L_" << hex4(static_cast<uint16_t>(ip)).substr(2) << ":\n";
+        out << code;
+    }
+
+    out << "}\n";
+
+    std::ostringstream head;
+    head << "// Generated by RohitAOT from a " << size << "-byte RohitVM image. Do not edit.\n";
+    head << "#include \"RohitVM.hpp\"\n\n";
+    if (usesIo) {
+        head << "// IN/OUT call into the host; rohit_aot_in blocks until the port has data\n";
+        head << "uint16_t rohit_aot_in(uint16_t port);\n";
+        head << "void rohit_aot_out(uint16_t port, uint16_t value);\n\n";
+    }
+    return head.str() + out.str();
+}
+
+// ---------------------------------------------------------------------------
+// Function: AotTranslator::translate (Instruction vector)
+// Purpose: Encodes the program like VM::loadProgram does, then translates the image.
+std::string AotTranslator::translate(const std::vector<Instruction>& program,
+                                     const std::string& functionName) {
+    std::vector<uint8_t> image = VM::encode(program);
+    if (image.size() > Memory::SIZE) image.resize(Memory::SIZE); // loadProgram would wrap; keep what fits
+    return translate(image.data(), static_cast<uint16_t>(image.size()), functionName);
+}
@@ -0,0 +1,52 @@
+// RohitAOT.hpp
+#pragma once  // Ensures this header is only included once during compilation
+
+#include <cstdint>      // For fixed-width integer types like uint16_t
+#include <string>       // The translator produces C++ source as a string
+#include <vector>       // Programs are std::vector<Instruction>
+
+#include "RohitVM.hpp"  // Opcode, Instruction, Trap
+
+// ===========================================================================
+// Author: Rohit Yadav
+// Description: Ahead-of-time translator from RohitVM bytecode to C++ source.
+//              Every guest instruction becomes straight-line host code inside
+//              one function with the signature
+//
+//                  Trap name(Registers& r, Memory& m);
+//
+//              Registers live in local variables for the whole run and are
+//              written back to 'r' when the function returns. HLT returns
+//              Trap::None; every runtime error the interpreter would report
+//              returns the matching Trap instead (with IP left where the
+//              interpreter would leave it). Compiled with -O3 this is the
+//              fastest way to run a fixed program, and because it follows the
+//              interpreter exactly it also serves as a reference for any JIT.
+//
+//              JMP and CALL become gotos. RET dispatches on the popped address
+//              over the CALL return points; returning anywhere else leaves the
+//              translated code and returns Trap::IllegalInstruction with IP set
+//              to that address.
+//
+//              IN and OUT call two functions the host links in:
+//                  uint16_t rohit_aot_in(uint16_t port);   // blocks until data is there
+//                  void rohit_aot_out(uint16_t port, uint16_t value);
+//              Translated code runs to completion; embedders that need to
+//              suspend on input use VM::run or RohitCoroutine.hpp instead.
+//              BRK returns Trap::Breakpoint with IP on the BRK.
+//              BSWAP16/32/64 call RohitUtils::bswap16/32/64 on the block.
+//
+//              The code is translated from the image as loaded: programs that
+//              overwrite their own bytes (e.g. a stack grown into the code,
+//              or a BSWAP over it) are not modelled.
+
+class AotTranslator {
+public:
+    // Translate the program stored in image[0 .. size), entered at IP 0.
+    static std::string translate(const uint8_t* image, uint16_t size,
+                                 const std::string& functionName);
+
+    // Convenience overload: encodes the program the same way VM::loadProgram does.
+    static std::string translate(const std::vector<Instruction>& program,
+                                 const std::string& functionName);
+};
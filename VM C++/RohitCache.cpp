@@ -0,0 +1,201 @@
+// RohitCache.cpp
+// This file implements the verified-program cache and the result cache:
+// keys, lookups and what gets stored on a miss. The sharded LRU map they
+// share is in the header (LruShards).
+
+#include "RohitCache.hpp"
+#include "RohitUtils.hpp"    // hash64
+#include <cstring>           // For memcmp
+
+namespace {
+
+    // -------------------------------
+    // Function: footprint
+    // Purpose: Roughly what one cached program keeps alive
+    size_t footprint(size_t imageSize, const VerifiedProgram* p) {
+        size_t bytes = 128 + imageSize;   // Entry, list and map nodes, control block
+        if (p) {
+            bytes += sizeof(VerifiedProgram) + p->code.capacity() * sizeof(DecodedInstruction) +
+                     p->indexOf.capacity() * sizeof(int32_t) + p->blocks.capacity() * sizeof(BasicBlock) +
+                     p->blockOf.capacity() * sizeof(uint32_t);
+        }
+        return bytes;
+    }
+
+    bool sameRegisters(const Registers& a, const Registers& b) {
+        return a.ax == b.ax && a.bx == b.bx && a.cx == b.cx && a.dx == b.dx && a.sp == b.sp && a.ip == b.ip &&
+               a.flags == b.flags;
+    }
+
+    // -------------------------------
+    // Function: diff
+    // Purpose: The runs of bytes where 'memory' differs from the image
+    // followed by zeros. Whole 64-byte chunks are compared first, so the
+    // untouched bulk of memory costs one memcmp per chunk.
+    void diff(const uint8_t* memory, const uint8_t* image, size_t imageSize,
+              std::vector<std::pair<uint16_t, std::vector<uint8_t>>>& delta) {
+        static const uint8_t zeros[64] = {};
+        constexpr size_t CHUNK = 64;
+        auto initial = [&](size_t addr) -> uint8_t { return addr < imageSize ? image[addr] : 0; };
+
+        bool open = false;   // The last run reaches the byte before this chunk
+        for (size_t base = 0; base < Memory::SIZE; base += CHUNK) {
+            bool same;
+            if (base + CHUNK <= imageSize) same = memcmp(memory + base, image + base, CHUNK) == 0;
+            else if (base >= imageSize) same = memcmp(memory + base, zeros, CHUNK) == 0;
+            else same = false;   // Straddles the end of the image: byte by byte
+            if (same) {
+                open = false;
+                continue;
+            }
+            for (size_t addr = base; addr < base + CHUNK; ++addr) {
+                if (memory[addr] == initial(addr)) {
+                    open = false;
+                } else {
+                    if (!open) delta.push_back({static_cast<uint16_t>(addr), {}});
+                    delta.back().second.push_back(memory[addr]);
+                    open = true;
+                }
+            }
+        }
+    }
+
+}
+
+// ===========================================================================
+// ProgramCache
+// ===========================================================================
+
+ProgramCache& ProgramCache::global() {
+    static ProgramCache cache;
+    return cache;
+}
+
+// ---------------------------------------------------------------------------
+// Function: ProgramCache::verify
+// Purpose: Look the image up; verify and insert it on a miss
+std::shared_ptr<const VerifiedProgram> ProgramCache::verify(const uint8_t* image, uint16_t size,
+                                                            uint16_t entryIp, uint16_t entrySp) {
+    // The proof depends on where the program starts as well as its bytes
+    const uint64_t hash = RohitUtils::hash64(image, size, (uint64_t(entryIp) << 16) | entrySp);
+
+    // Different bytes under the same hash: treated as a miss, and the new
+    // program replaces the old one
+    std::shared_ptr<const Program> found = entries.find(hash);
+    if (found && found->entryIp == entryIp && found->entrySp == entrySp && found->image.size() == size &&
+        memcmp(found->image.data(), image, size) == 0) {
+        hits++;
+        return found->verified;
+    }
+
+    misses++;
+    auto program = std::make_shared<Program>();
+    program->image.assign(image, image + size);
+    program->entryIp = entryIp;
+    program->entrySp = entrySp;
+    program->verified = Verifier::verify(image, size, entryIp, entrySp);
+    size_t bytes = footprint(size, program->verified.get());
+    entries.insert(hash, program, bytes);
+    return program->verified;
+}
+
+ProgramCache::Stats ProgramCache::stats() const {
+    Stats s;
+    s.hits = hits;
+    s.misses = misses;
+    s.evictions = entries.evictions;
+    entries.usage(s.entries, s.bytes);
+    return s;
+}
+
+// ===========================================================================
+// ResultCache
+// ===========================================================================
+
+// ---------------------------------------------------------------------------
+// Function: ResultCache::hashOf
+// Purpose: The key's hash: the image, then the registers (the budget isn't
+// part of it: one entry answers every budget it is valid for)
+uint64_t ResultCache::hashOf(const uint8_t* image, uint16_t size, const Registers& regs) {
+    uint16_t words[7] = {regs.ax, regs.bx, regs.cx, regs.dx, regs.sp, regs.ip,
+                         static_cast<uint16_t>(regs.flags & Registers::AllFlags)};
+    return RohitUtils::hash64(reinterpret_cast<const uint8_t*>(words), sizeof(words),
+                              RohitUtils::hash64(image, size));
+}
+
+// ---------------------------------------------------------------------------
+// Function: ResultCache::lookup
+std::shared_ptr<const MemoizedRun> ResultCache::lookup(const uint8_t* image, uint16_t size,
+                                                       const Registers& regs, uint64_t budget) {
+    Registers key = regs;
+    key.flags &= Registers::AllFlags;   // What prepare() starts the VM with
+    std::shared_ptr<const Entry> found = entries.find(hashOf(image, size, key));
+
+    // Same budget: exactly the same run. Otherwise the recorded run must
+    // have stopped on its own with budget to spare, so the new budget can't
+    // change where it stops. (A trap or IN isn't counted, so '>' rather
+    // than '>=': the new budget must cover the instruction that stopped it.)
+    if (found && sameRegisters(found->regs, key) && found->image.size() == size &&
+        (budget == found->budget ||
+         (found->run.status != RunStatus::BudgetExhausted && budget > found->run.instructions)) &&
+        memcmp(found->image.data(), image, size) == 0) {
+        hits++;
+        return std::shared_ptr<const MemoizedRun>(found, &found->run);   // Keeps the entry alive
+    }
+    misses++;
+    return nullptr;
+}
+
+// ---------------------------------------------------------------------------
+// Function: ResultCache::store
+void ResultCache::store(const uint8_t* image, uint16_t size, const Registers& regs, uint64_t budget,
+                        RunStatus status, const VM& vm, const std::vector<std::pair<uint16_t, uint16_t>>& output,
+                        bool truncated) {
+    auto entry = std::make_shared<Entry>();
+    entry->image.assign(image, image + size);
+    entry->regs = regs;
+    entry->regs.flags &= Registers::AllFlags;
+    entry->budget = budget;
+
+    MemoizedRun& run = entry->run;
+    run.status = status;
+    run.trap = vm.trap;
+    run.trapMessage = vm.trapMessage;
+    run.regs = vm.cpu.r;
+    run.instructions = vm.instructionsExecuted;
+    run.ioPort = vm.ioPort;
+    run.truncated = truncated;
+    run.output = output;
+    diff(vm.memory.raw(), image, size, run.delta);
+
+    size_t bytes = 192 + size + run.trapMessage.size() + run.output.size() * sizeof(run.output[0]);
+    for (const auto& change : run.delta) bytes += sizeof(change) + change.second.size();
+
+    stores++;
+    entries.insert(hashOf(image, size, entry->regs), entry, bytes);
+}
+
+ResultCache::Stats ResultCache::stats() const {
+    Stats s;
+    s.hits = hits;
+    s.misses = misses;
+    s.stores = stores;
+    s.evictions = entries.evictions;
+    entries.usage(s.entries, s.bytes);
+    return s;
+}
+
+// ---------------------------------------------------------------------------
+// Function: MemoizedRun::applyTo
+void MemoizedRun::applyTo(VM& vm) const {
+    for (const auto& change : delta) {
+        RohitUtils::copy(vm.memory.raw() + change.first, change.second.data(), change.second.size());
+        // The real run would have dropped a proof for code it overwrote
+        if (change.first < vm.breakLine) vm.verified = nullptr;
+    }
+    vm.cpu.r = regs;
+    vm.instructionsExecuted = instructions;
+    vm.trap = trap;
+    vm.trapMessage = trapMessage;
+    vm.ioPort = ioPort;
+}
@@ -0,0 +1,287 @@
+// RohitCache.hpp
+#pragma once  // Ensures this header is only included once during compilation
+
+#include <atomic>         // Hit / miss counters
+#include <cstdint>        // For fixed-width integer types like uint16_t
+#include <list>           // LRU order
+#include <memory>         // Cached values are shared with whoever uses them
+#include <mutex>          // One lock per shard
+#include <string>         // Trap messages
+#include <unordered_map>  // Hash -> entry
+#include <utility>        // std::pair (OUT values)
+#include <vector>         // Image copies, memory deltas
+
+#include "RohitVerifier.hpp"  // VerifiedProgram, Verifier
+
+// ===========================================================================
+// Author: Rohit Yadav
+// Description: Content-addressed caches for the job transports.
+//
+//              ProgramCache: Services see the same few programs over and
+//              over, and every job used to verify, decode and split its
+//              image into blocks again. ProgramCache::verify() answers
+//              exactly like Verifier::verify(), but keeps the result keyed
+//              by a 64-bit hash (RohitUtils::hash64) of the image bytes and
+//              the entry IP/SP, so a program seen before costs one hash, one
+//              lookup and one compare of the bytes instead of a
+//              verification. Programs the verifier rejects are cached too
+//              (as nullptr): they run on the checked interpreter, and
+//              finding that out again is the same cost.
+//
+//              ResultCache: A job on the transports is a pure function of
+//              its image, registers and budget (memory starts as the image
+//              followed by zeros, and IN never has data), so a repeated job
+//              can be answered without running it at all. Opt-in: pass one
+//              to JobServer / RingWorkers.
+//
+//              Both are split into shards by hash, each with its own lock
+//              and LRU list (LruShards below), so worker threads rarely
+//              contend; a lock is only held to find and re-link an entry
+//              (the key bytes are compared after it is released). Each shard
+//              evicts its least recently used entries once the shard's share
+//              of the memory cap is used up. Whatever is computed on a miss
+//              is computed without any lock: two threads missing on the same
+//              key may both compute it, and the second result replaces the
+//              first. Everything handed out is immutable and reference
+//              counted, so evicting or clearing never affects its users.
+
+// ===========================================================================
+// CLASS: LruShards
+// The bounded concurrent map both caches are built on: 64-bit hash ->
+// shared immutable value, with a byte cap and LRU eviction. A hash is not
+// proof of a match: values carry their key and callers compare it.
+// ===========================================================================
+
+template <typename T>
+class LruShards {
+public:
+    explicit LruShards(size_t limit) : capacityBytes(limit) {}
+
+    // The value stored under 'hash' (now the most recently used), or nullptr
+    std::shared_ptr<const T> find(uint64_t hash) {
+        Shard& shard = shardOf(hash);
+        std::lock_guard<std::mutex> guard(shard.lock);
+        auto it = shard.index.find(hash);
+        if (it == shard.index.end()) return nullptr;
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        return it->second->value;
+    }
+
+    // Stores 'value' (replacing whatever had that hash), then evicts down to
+    // the shard's share of the cap. 'bytes' is what the value keeps alive.
+    void insert(uint64_t hash, std::shared_ptr<const T> value, size_t bytes) {
+        Shard& shard = shardOf(hash);
+        std::lock_guard<std::mutex> guard(shard.lock);
+        auto it = shard.index.find(hash);
+        if (it != shard.index.end()) {
+            shard.bytes -= it->second->bytes;
+            shard.lru.erase(it->second);
+            shard.index.erase(it);
+        }
+        shard.lru.push_front({hash, std::move(value), bytes});
+        shard.index.emplace(hash, shard.lru.begin());
+        shard.bytes += bytes;
+        trim(shard);
+    }
+
+    void setCapacity(size_t bytes) {
+        capacityBytes = bytes;
+        for (Shard& shard : shards) {
+            std::lock_guard<std::mutex> guard(shard.lock);
+            trim(shard);
+        }
+    }
+
+    void clear() {
+        for (Shard& shard : shards) {
+            std::lock_guard<std::mutex> guard(shard.lock);
+            shard.index.clear();
+            shard.lru.clear();
+            shard.bytes = 0;
+        }
+    }
+
+    size_t capacity() const { return capacityBytes.load(); }
+
+    // Entries and bytes held right now (adds up every shard)
+    void usage(size_t& entries, size_t& bytes) const {
+        entries = bytes = 0;
+        for (const Shard& shard : shards) {
+            std::lock_guard<std::mutex> guard(shard.lock);
+            entries += shard.index.size();
+            bytes += shard.bytes;
+        }
+    }
+
+    std::atomic<uint64_t> evictions{0};
+
+private:
+    static constexpr size_t SHARDS = 16;
+
+    struct Entry {
+        uint64_t hash;
+        std::shared_ptr<const T> value;
+        size_t bytes;
+    };
+
+    struct Shard {
+        mutable std::mutex lock;
+        std::list<Entry> lru;      // Most recently used first
+        std::unordered_map<uint64_t, typename std::list<Entry>::iterator> index;
+        size_t bytes = 0;
+    };
+
+    Shard shards[SHARDS];
+    std::atomic<size_t> capacityBytes;
+
+    Shard& shardOf(uint64_t hash) { return shards[hash % SHARDS]; }
+
+    // Drops least recently used entries until the shard is within its share
+    // of the cap (a value bigger than the share is not kept at all)
+    void trim(Shard& shard) {
+        const size_t share = capacityBytes.load(std::memory_order_relaxed) / SHARDS;
+        while (shard.bytes > share && !shard.lru.empty()) {
+            const Entry& victim = shard.lru.back();
+            shard.bytes -= victim.bytes;
+            shard.index.erase(victim.hash);
+            shard.lru.pop_back();
+            evictions++;
+        }
+    }
+};
+
+// ===========================================================================
+// CLASS: ProgramCache
+//
+//     auto program = ProgramCache::global().verify(image, size, ip, sp);
+//     // ... same as Verifier::verify(image, size, ip, sp)
+// ===========================================================================
+
+class ProgramCache {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = size_t(64) << 20;   // 64 MiB
+
+    explicit ProgramCache(size_t capacityBytes = DEFAULT_CAPACITY) : entries(capacityBytes) {}
+    ProgramCache(const ProgramCache&) = delete;
+    ProgramCache& operator=(const ProgramCache&) = delete;
+
+    // The process-wide cache (created on first use, DEFAULT_CAPACITY)
+    static ProgramCache& global();
+
+    // Verifier::verify, memoized. Safe to call from any number of threads.
+    std::shared_ptr<const VerifiedProgram> verify(const uint8_t* image, uint16_t size,
+                                                  uint16_t entryIp, uint16_t entrySp);
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;       // Verifications run
+        uint64_t evictions = 0;
+        size_t entries = 0;
+        size_t bytes = 0;          // Estimated memory held (images + decoded programs)
+    };
+    Stats stats() const;
+
+    void setCapacity(size_t bytes) { entries.setCapacity(bytes); }   // Evicts down to the new cap right away
+    size_t capacity() const { return entries.capacity(); }
+    void clear() { entries.clear(); }
+
+private:
+    // One cached verification: the exact bytes it was done for and the result
+    struct Program {
+        std::vector<uint8_t> image;
+        uint16_t entryIp = 0;
+        uint16_t entrySp = 0;
+        std::shared_ptr<const VerifiedProgram> verified;   // nullptr = rejected
+    };
+
+    LruShards<Program> entries;
+    std::atomic<uint64_t> hits{0}, misses{0};
+};
+
+// ===========================================================================
+// STRUCT: MemoizedRun
+// Everything a job's run produced, as ResultCache keeps it.
+// ===========================================================================
+
+struct MemoizedRun {
+    RunStatus status = RunStatus::BudgetExhausted;
+    Trap trap = Trap::None;
+    std::string trapMessage;
+    Registers regs;                // Registers when the run stopped
+    uint64_t instructions = 0;
+    uint16_t ioPort = 0;           // WaitingForInput: the port
+    bool truncated = false;        // The transport dropped OUT values past its limit
+    std::vector<std::pair<uint16_t, uint16_t>> output;   // (port, value) per OUT, in order
+
+    // Memory the run changed, relative to the image followed by zeros:
+    // (address, new bytes) for each run of changed bytes, in address order
+    std::vector<std::pair<uint16_t, std::vector<uint8_t>>> delta;
+
+    // Puts a VM prepared for the same job (JobServer::prepare) into the
+    // state the run left it in: memory, registers, counters, trap
+    void applyTo(VM& vm) const;
+};
+
+// ===========================================================================
+// CLASS: ResultCache
+//
+//     if (auto hit = results.lookup(image, size, regs, budget)) {
+//         ... answer with *hit, nothing runs
+//     } else {
+//         JobServer::prepare(vm, image, size, regs);
+//         RunStatus status = vm.run(budget);
+//         results.store(image, size, regs, budget, status, vm, output, truncated);
+//     }
+//
+// A result is reused for another budget when it can't make a difference:
+// the run stopped on its own (halt, trap, breakpoint, IN) before using up
+// the budget. Only use it where jobs really are pure: a VM whose onInput
+// returns data, or whose memory doesn't start as just the image, must not
+// be memoized.
+// ===========================================================================
+
+class ResultCache {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = size_t(16) << 20;   // 16 MiB
+
+    explicit ResultCache(size_t capacityBytes = DEFAULT_CAPACITY) : entries(capacityBytes) {}
+    ResultCache(const ResultCache&) = delete;
+    ResultCache& operator=(const ResultCache&) = delete;
+
+    // The recorded result of this job, or nullptr
+    std::shared_ptr<const MemoizedRun> lookup(const uint8_t* image, uint16_t size, const Registers& regs,
+                                              uint64_t budget);
+
+    // Records a job that was just run on 'vm' (prepared from image / regs,
+    // run with 'budget'); 'output' / 'truncated' are what the transport kept
+    void store(const uint8_t* image, uint16_t size, const Registers& regs, uint64_t budget,
+               RunStatus status, const VM& vm, const std::vector<std::pair<uint16_t, uint16_t>>& output,
+               bool truncated);
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t stores = 0;
+        uint64_t evictions = 0;
+        size_t entries = 0;
+        size_t bytes = 0;
+    };
+    Stats stats() const;
+
+    void setCapacity(size_t bytes) { entries.setCapacity(bytes); }
+    size_t capacity() const { return entries.capacity(); }
+    void clear() { entries.clear(); }
+
+private:
+    struct Entry {
+        std::vector<uint8_t> image;   // The key: image, registers, budget it ran with
+        Registers regs;
+        uint64_t budget = 0;
+        MemoizedRun run;
+    };
+
+    LruShards<Entry> entries;
+    std::atomic<uint64_t> hits{0}, misses{0}, stores{0};
+
+    static uint64_t hashOf(const uint8_t* image, uint16_t size, const Registers& regs);
+};
@@ -0,0 +1,113 @@
+// RohitCoroutine.hpp
+#pragma once  // Ensures this header is only included once during compilation
+
+#include "RohitVM.hpp"  // VM, RunStatus
+
+// ===========================================================================
+// Author: Rohit Yadav
+// Description: C++20 coroutine wrapper around VM::run for event-loop hosts.
+//              A VMTask runs its VM one slice of 'slice' instructions per
+//              resume() and suspends when
+//                - the slice is used up          (RunStatus::BudgetExhausted)
+//                - an IN has no data yet         (RunStatus::WaitingForInput)
+//                - the code is still arriving    (RunStatus::WaitingForCode)
+//                - the program halts, traps or   (final: task.done() is true)
+//                  reaches a BRK
+//              so one reactor thread can drive thousands of VMs:
+//
+//                  VMTask task = runAsync(vm, 10000);
+//                  while (task.resume()) {
+//                      if (task.status() == RunStatus::WaitingForInput)
+//                          ...park until vm.ioPort has data...
+//                  }
+//
+//              A BRK ends the task as well: the IP stays on it, so run()
+//              would only stop there again. To carry on, step off it (a
+//              Debugger breakpoint: dbg.step(), see RohitDebugger.hpp; a BRK
+//              in the program itself: vm.cpu.r.ip += 1) and start a new task:
+//
+//                  if (task.status() == RunStatus::Breakpoint) {
+//                      dbg.step();
+//                      task = runAsync(vm, 10000);
+//                  }
+//
+//              The coroutine frame is allocated once, when the task is
+//              created. Suspending and resuming never allocate: the status
+//              lives in the promise and VM::run keeps all other state in
+//              the VM itself.
+//
+//              Needs -std=c++20 (the rest of the VM builds with C++17).
+
+#if __cplusplus >= 202002L && __has_include(<coroutine>)
+
+#include <coroutine>   // std::coroutine_handle, std::suspend_always
+#include <exception>   // std::exception_ptr
+#include <utility>     // std::exchange
+
+// ===========================================================================
+// CLASS: VMTask
+// Owns the coroutine running one VM. Move-only.
+// ===========================================================================
+
+class VMTask {
+public:
+    struct promise_type {
+        RunStatus status = RunStatus::BudgetExhausted; // Why the task last suspended
+        std::exception_ptr error;                       // Anything VM::run threw besides a trap
+
+        VMTask get_return_object() {
+            return VMTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; } // Nothing runs until resume()
+        std::suspend_always final_suspend() noexcept { return {}; }   // Keep status readable after the end
+        std::suspend_always yield_value(RunStatus s) noexcept { status = s; return {}; }
+        void return_value(RunStatus s) noexcept { status = s; }
+        void unhandled_exception() noexcept { error = std::current_exception(); }
+    };
+
+    VMTask(VMTask&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+    VMTask& operator=(VMTask&& other) noexcept {
+        if (this != &other) {
+            if (handle) handle.destroy();
+            handle = std::exchange(other.handle, {});
+        }
+        return *this;
+    }
+    VMTask(const VMTask&) = delete;
+    VMTask& operator=(const VMTask&) = delete;
+    ~VMTask() { if (handle) handle.destroy(); }
+
+    // Runs the next slice. Returns false once the program has halted,
+    // trapped or hit a BRK (status() says which); calling it again then
+    // does nothing.
+    bool resume() {
+        if (!handle || handle.done()) return false;
+        handle.resume();
+        if (handle.promise().error) std::rethrow_exception(std::exchange(handle.promise().error, {}));
+        return !handle.done();
+    }
+
+    bool done() const { return !handle || handle.done(); }
+    RunStatus status() const { return handle.promise().status; }
+
+private:
+    explicit VMTask(std::coroutine_handle<promise_type> h) : handle(h) {}
+    std::coroutine_handle<promise_type> handle;
+};
+
+// ---------------------------------------------------------------------------
+// Function: runAsync
+// Purpose: Runs 'vm' (already loaded) as a coroutine, 'slice' instructions
+// per resume. The VM must outlive the task. Works for every BasicVM
+// (VM, VM32 and the paged machines).
+template <typename Word, typename Mem>
+VMTask runAsync(BasicVM<Word, Mem>& vm, uint64_t slice) {
+    while (true) {
+        RunStatus status = vm.run(slice);
+        if (status == RunStatus::Halted || status == RunStatus::Trapped || status == RunStatus::Breakpoint)
+            co_return status;   // Running again would stop on the same BRK
+        co_yield status; // Budget used up or waiting for input: let the host decide
+    }
+}
+
+#endif // C++20 coroutines
@@ -0,0 +1,583 @@
+// RohitDebugger.cpp
+// This file implements the debugger (breakpoint patching, step, continue,
+// register/memory access) and the GDB remote protocol stub.
+
+#include "RohitDebugger.hpp"
+#include "RohitMMU.hpp"     // PagedMemory (instantiated below)
+#include <cstring>          // For strncpy
+#include <netinet/in.h>     // sockaddr_in
+#include <netinet/tcp.h>    // TCP_NODELAY
+#include <poll.h>           // poll (Ctrl-C while running)
+#include <sys/socket.h>     // socket, bind, listen, accept, send, recv
+#include <sys/un.h>         // sockaddr_un
+#include <unistd.h>         // close, unlink
+
+namespace {
+    // Instructions per run() slice while continuing, between Ctrl-C checks
+    constexpr uint64_t SLICE = 1 << 16;
+
+    const char* hexDigits = "0123456789abcdef";
+
+    // -------------------------------
+    // Function: hexByte / hexValue
+    // Purpose: Encodes bytes and little-endian values the way GDB expects
+    void hexByte(std::string& out, uint8_t b) {
+        out += hexDigits[b >> 4];
+        out += hexDigits[b & 0xf];
+    }
+
+    template <typename Word>
+    void hexValue(std::string& out, Word v) {
+        for (size_t i = 0; i < sizeof(Word); ++i) hexByte(out, (v >> (8 * i)) & 0xff);
+    }
+
+    int hexDigit(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    // -------------------------------
+    // Function: parseHex
+    // Purpose: Reads a big-endian hex number at s[pos], advancing pos
+    bool parseHex(const std::string& s, size_t& pos, uint64_t& out) {
+        size_t start = pos;
+        out = 0;
+        while (pos < s.size() && hexDigit(s[pos]) >= 0) out = (out << 4) | hexDigit(s[pos++]);
+        return pos > start;
+    }
+
+    // -------------------------------
+    // Function: parseLittleEndian
+    // Purpose: Reads one register value (sizeof(Word) bytes, low byte first)
+    template <typename Word>
+    bool parseLittleEndian(const std::string& s, size_t& pos, Word& out) {
+        if (pos + 2 * sizeof(Word) > s.size()) return false;
+        out = 0;
+        for (size_t i = 0; i < sizeof(Word); ++i, pos += 2) {
+            int hi = hexDigit(s[pos]), lo = hexDigit(s[pos + 1]);
+            if (hi < 0 || lo < 0) return false;
+            out |= static_cast<Word>((hi << 4) | lo) << (8 * i);
+        }
+        return true;
+    }
+
+    // -------------------------------
+    // Function: escape
+    // Purpose: Binary-escapes the characters that frame packets
+    std::string escape(const std::string& s) {
+        std::string out;
+        for (char c : s) {
+            if (c == '$' || c == '#' || c == '}' || c == '*') {
+                out += '}';
+                out += static_cast<char>(c ^ 0x20);
+            } else {
+                out += c;
+            }
+        }
+        return out;
+    }
+}
+
+// ===========================================================================
+// Debugger
+// ===========================================================================
+
+// ---------------------------------------------------------------------------
+// Function: Debugger::Debugger / ~Debugger
+template <typename Word, typename Mem>
+Debugger<Word, Mem>::Debugger(BasicVM<Word, Mem>& vm) : vm(vm) {}
+
+template <typename Word, typename Mem>
+Debugger<Word, Mem>::~Debugger() {
+    clearBreakpoints();
+}
+
+// ---------------------------------------------------------------------------
+// Function: ownDecoded
+// Purpose: Copy-on-write for the decoded program. vm.verified may be shared
+// with other VMs (see CodeSegment), so breakpoints go into a private copy.
+template <typename Word, typename Mem>
+void Debugger<Word, Mem>::ownDecoded() {
+    if constexpr (BasicVM<Word, Mem>::IS_16BIT) {
+        if (!vm.verified || vm.verified == decoded) return;
+        decoded = std::make_shared<VerifiedProgram>(*vm.verified);
+        vm.verified = decoded;
+        for (auto& [addr, bp] : breakpoints) patchDecoded(addr, bp);
+    }
+}
+
+template <typename Word, typename Mem>
+void Debugger<Word, Mem>::dropDecoded() {
+    vm.verified = nullptr;
+    decoded.reset();
+    for (auto& entry : breakpoints) entry.second.index = -1;
+}
+
+// ---------------------------------------------------------------------------
+// Function: patchDecoded / insert / remove
+// Purpose: Put a breakpoint into (or take it out of) memory and the decoded stream
+template <typename Word, typename Mem>
+void Debugger<Word, Mem>::patchDecoded(Word addr, Breakpoint& bp) {
+    bp.index = -1;
+    if (!decoded || addr >= decoded->imageSize) return;
+    int32_t index = decoded->indexOf[addr];
+    if (index < 0) return;   // Not an instruction the verified handlers can reach
+
+    bp.index = index;
+    bp.savedHandler = decoded->code[index].handler;
+    decoded->code[index].handler = Handler::BREAK;
+}
+
+template <typename Word, typename Mem>
+void Debugger<Word, Mem>::insert(Word addr, Breakpoint& bp) {
+    bp.savedByte = vm.memory.peek(addr);
+    vm.memory.poke(addr, static_cast<uint8_t>(Opcode::BRK));
+    patchDecoded(addr, bp);
+}
+
+template <typename Word, typename Mem>
+void Debugger<Word, Mem>::remove(Word addr, Breakpoint& bp) {
+    vm.memory.poke(addr, bp.savedByte);
+    if (bp.index >= 0 && decoded) decoded->code[bp.index].handler = bp.savedHandler;
+    bp.index = -1;
+}
+
+// ---------------------------------------------------------------------------
+// Function: setBreakpoint / clearBreakpoint / clearBreakpoints
+template <typename Word, typename Mem>
+bool Debugger<Word, Mem>::setBreakpoint(Word addr) {
+    if (hasBreakpoint(addr) || size_t(addr) >= vm.memory.size()) return false;
+    ownDecoded();
+    Breakpoint bp;
+    insert(addr, bp);
+    breakpoints[addr] = bp;
+    return true;
+}
+
+template <typename Word, typename Mem>
+bool Debugger<Word, Mem>::clearBreakpoint(Word addr) {
+    auto it = breakpoints.find(addr);
+    if (it == breakpoints.end()) return false;
+    ownDecoded();
+    remove(addr, it->second);
+    breakpoints.erase(it);
+    return true;
+}
+
+template <typename Word, typename Mem>
+void Debugger<Word, Mem>::clearBreakpoints() {
+    ownDecoded();
+    for (auto& [addr, bp] : breakpoints) remove(addr, bp);
+    breakpoints.clear();
+}
+
+// ---------------------------------------------------------------------------
+// Function: step
+// Purpose: One instruction. A breakpoint on it is lifted for that instruction only.
+template <typename Word, typename Mem>
+RunStatus Debugger<Word, Mem>::step() {
+    ownDecoded();
+    Word at = vm.cpu.r.ip;
+    auto it = breakpoints.find(at);
+    if (it == breakpoints.end()) return vm.run(1);
+
+    remove(at, it->second);
+    RunStatus status = vm.run(1);
+    insert(at, it->second);
+    return status;
+}
+
+// ---------------------------------------------------------------------------
+// Function: cont
+template <typename Word, typename Mem>
+RunStatus Debugger<Word, Mem>::cont(uint64_t budget) {
+    ownDecoded();
+    if (hasBreakpoint(vm.cpu.r.ip)) {
+        // Step off the breakpoint we're sitting on, or we'd stop on it again
+        if (budget == 0) return RunStatus::BudgetExhausted;
+        RunStatus status = step();
+        if (status != RunStatus::BudgetExhausted) return status;
+        if (budget != BasicVM<Word, Mem>::UNLIMITED) budget--;
+    }
+    return vm.run(budget);
+}
+
+// ---------------------------------------------------------------------------
+// Function: readRegister / writeRegister
+template <typename Word, typename Mem>
+Word Debugger<Word, Mem>::readRegister(Register r) const {
+    switch (r) {
+        case AX: return vm.cpu.r.ax;
+        case BX: return vm.cpu.r.bx;
+        case CX: return vm.cpu.r.cx;
+        case DX: return vm.cpu.r.dx;
+        case SP: return vm.cpu.r.sp;
+        case IP: return vm.cpu.r.ip;
+        case FLAGS: return vm.cpu.r.flags;
+        default: return 0;
+    }
+}
+
+template <typename Word, typename Mem>
+void Debugger<Word, Mem>::writeRegister(Register r, Word value) {
+    if (readRegister(r) == value) return;
+    if (vm.verified) dropDecoded();  // The proof may depend on the old value
+
+    switch (r) {
+        case AX: vm.cpu.r.ax = value; break;
+        case BX: vm.cpu.r.bx = value; break;
+        case CX: vm.cpu.r.cx = value; break;
+        case DX: vm.cpu.r.dx = value; break;
+        case SP: vm.cpu.r.sp = value; break;
+        case IP: vm.cpu.r.ip = value; break;
+        case FLAGS: vm.cpu.r.flags = static_cast<uint16_t>(value); break;
+        default: break;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Function: readMemory / writeMemory
+// Purpose: Host view of memory with the breakpoints hidden
+template <typename Word, typename Mem>
+uint8_t Debugger<Word, Mem>::readMemory(Word addr) const {
+    auto it = breakpoints.find(addr);
+    return it != breakpoints.end() ? it->second.savedByte : vm.memory.peek(addr);
+}
+
+template <typename Word, typename Mem>
+void Debugger<Word, Mem>::writeMemory(Word addr, uint8_t value) {
+    // Changing the code the verifier looked at invalidates the proof
+    if (vm.verified && addr < vm.verified->imageSize) dropDecoded();
+
+    auto it = breakpoints.find(addr);
+    if (it != breakpoints.end())
+        it->second.savedByte = value;   // Memory keeps the BRK until the breakpoint goes
+    else
+        vm.memory.poke(addr, value);
+}
+
+// ===========================================================================
+// GdbStub
+// ===========================================================================
+
+// ---------------------------------------------------------------------------
+// Function: GdbStub::~GdbStub
+template <typename Word, typename Mem>
+GdbStub<Word, Mem>::~GdbStub() {
+    if (clientFd >= 0) close(clientFd);
+    if (listenFd >= 0) close(listenFd);
+    if (!unixPath.empty()) unlink(unixPath.c_str());
+}
+
+// ---------------------------------------------------------------------------
+// Function: listenTcp / listenUnix
+template <typename Word, typename Mem>
+bool GdbStub<Word, Mem>::listenTcp(uint16_t port) {
+    listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenFd < 0) return false;
+
+    int one = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);  // Local debugging only
+    return bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0 &&
+           listen(listenFd, 1) == 0;
+}
+
+template <typename Word, typename Mem>
+bool GdbStub<Word, Mem>::listenUnix(const std::string& path) {
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) return false;
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0) return false;
+
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    unlink(path.c_str());   // Left over from an earlier run
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) return false;
+    unixPath = path;
+    return listen(listenFd, 1) == 0;
+}
+
+// ---------------------------------------------------------------------------
+// Function: serve
+// Purpose: One debugging session
+template <typename Word, typename Mem>
+bool GdbStub<Word, Mem>::serve() {
+    if (listenFd < 0) return false;
+    clientFd = accept(listenFd, nullptr, nullptr);
+    if (clientFd < 0) return false;
+
+    int one = 1;
+    setsockopt(clientFd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)); // Fails harmlessly on Unix sockets
+
+    std::string packet;
+    bool done = false;
+    while (!done && readPacket(packet)) {
+        if (!packet.empty() && packet[0] == 'k') break;  // Kill: no reply
+        if (!sendPacket(handle(packet, done))) break;
+    }
+
+    dbg.clearBreakpoints();
+    close(clientFd);
+    clientFd = -1;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Function: readByte / readPacket / sendPacket / interrupted
+// Purpose: Packet framing ($data#checksum) and acknowledgements
+template <typename Word, typename Mem>
+int GdbStub<Word, Mem>::readByte() {
+    uint8_t c;
+    return recv(clientFd, &c, 1, 0) == 1 ? c : -1;
+}
+
+template <typename Word, typename Mem>
+bool GdbStub<Word, Mem>::readPacket(std::string& packet) {
+    while (true) {
+        int c = readByte();
+        if (c < 0) return false;
+        if (c != '$') continue;   // Acks and stray Ctrl-C while stopped
+
+        packet.clear();
+        uint8_t sum = 0;
+        while ((c = readByte()) >= 0 && c != '#') {
+            packet += static_cast<char>(c);
+            sum += static_cast<uint8_t>(c);
+        }
+        int hi = readByte(), lo = readByte();
+        if (c < 0 || hi < 0 || lo < 0) return false;
+
+        bool ok = hexDigit(static_cast<char>(hi)) >= 0 && hexDigit(static_cast<char>(lo)) >= 0 &&
+                  ((hexDigit(static_cast<char>(hi)) << 4) | hexDigit(static_cast<char>(lo))) == sum;
+        char ack = ok ? '+' : '-';
+        if (send(clientFd, &ack, 1, MSG_NOSIGNAL) != 1) return false;
+        if (ok) return true;
+    }
+}
+
+template <typename Word, typename Mem>
+bool GdbStub<Word, Mem>::sendPacket(const std::string& data) {
+    uint8_t sum = 0;
+    for (char c : data) sum += static_cast<uint8_t>(c);
+
+    std::string frame = "$" + data + "#";
+    hexByte(frame, sum);
+
+    for (int attempt = 0; attempt < 3; ++attempt) {
+        if (send(clientFd, frame.data(), frame.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(frame.size()))
+            return false;
+        int c;
+        while ((c = readByte()) >= 0 && c != '+' && c != '-') {}
+        if (c < 0) return false;
+        if (c == '+') return true;
+    }
+    return false;
+}
+
+template <typename Word, typename Mem>
+bool GdbStub<Word, Mem>::interrupted() {
+    pollfd p{clientFd, POLLIN, 0};
+    while (poll(&p, 1, 0) > 0 && (p.revents & POLLIN)) {
+        int c = readByte();
+        if (c < 0) return true;     // Client went away: stop running
+        if (c == 0x03) return true;
+    }
+    return false;
+}
+
+// ---------------------------------------------------------------------------
+// Function: resume / describe
+// Purpose: c and s, and the stop reply that goes with their result
+template <typename Word, typename Mem>
+std::string GdbStub<Word, Mem>::resume(bool singleStep) {
+    if (singleStep) return describe(dbg.step());
+
+    while (true) {
+        RunStatus status = dbg.cont(SLICE);
+        if (status != RunStatus::BudgetExhausted) return describe(status);
+        if (interrupted()) return stopReply = "S02";  // SIGINT
+    }
+}
+
+template <typename Word, typename Mem>
+std::string GdbStub<Word, Mem>::describe(RunStatus status) {
+    switch (status) {
+        case RunStatus::Halted:
+            return stopReply = "W00";   // Program exited
+        case RunStatus::WaitingForInput:
+        case RunStatus::WaitingForCode:
+            return stopReply = "S17";   // SIGIO
+        case RunStatus::Trapped:
+            switch (dbg.target().trap) {
+                case Trap::DivideByZero: return stopReply = "S08";  // SIGFPE
+                case Trap::StackOverflow:
+                case Trap::StackUnderflow:
+                case Trap::MemoryFault:  return stopReply = "S0b";  // SIGSEGV
+                default:                 return stopReply = "S04";  // SIGILL
+            }
+        case RunStatus::Breakpoint:
+        case RunStatus::BudgetExhausted:
+            break;
+    }
+    return stopReply = "S05";           // SIGTRAP: breakpoint or finished step
+}
+
+// ---------------------------------------------------------------------------
+// Function: targetXml
+// Purpose: Register description for qXfer:features:read:target.xml
+template <typename Word, typename Mem>
+std::string GdbStub<Word, Mem>::targetXml() const {
+    static const char* names[] = {"ax", "bx", "cx", "dx", "sp", "ip", "flags"};
+    static const char* types[] = {"int", "int", "int", "int", "data_ptr", "code_ptr", "int"};
+    std::string bits = std::to_string(8 * sizeof(Word));
+
+    std::string xml = "<?xml version=\"1.0\"?>\n"
+                      "<!DOCTYPE target SYSTEM \"gdb-target.dtd\">\n"
+                      "<target version=\"1.0\">\n"
+                      "  <feature name=\"org.rohitvm.core\">\n";
+    for (int i = 0; i < Debugger<Word, Mem>::REGISTER_COUNT; ++i) {
+        xml += "    <reg name=\"" + std::string(names[i]) + "\" bitsize=\"" + bits +
+               "\" type=\"" + types[i] + "\"/>\n";
+    }
+    xml += "  </feature>\n</target>\n";
+    return xml;
+}
+
+// ---------------------------------------------------------------------------
+// Function: handle
+// Purpose: Answers one packet ("" = not supported)
+template <typename Word, typename Mem>
+std::string GdbStub<Word, Mem>::handle(const std::string& packet, bool& done) {
+    using Reg = typename Debugger<Word, Mem>::Register;
+    const int regCount = Debugger<Word, Mem>::REGISTER_COUNT;
+    const size_t memSize = dbg.target().memory.size();
+    std::string out;
+    size_t pos = 1;
+    uint64_t a = 0, b = 0;
+
+    if (packet.empty()) return "";
+    switch (packet[0]) {
+        case '?':
+            return stopReply;
+
+        // ----------- Registers -----------
+        case 'g':
+            for (int r = 0; r < regCount; ++r) hexValue(out, dbg.readRegister(static_cast<Reg>(r)));
+            return out;
+
+        case 'G':
+            for (int r = 0; r < regCount; ++r) {
+                Word v;
+                if (!parseLittleEndian(packet, pos, v)) return "E01";
+                dbg.writeRegister(static_cast<Reg>(r), v);
+            }
+            return "OK";
+
+        case 'p':
+            if (!parseHex(packet, pos, a) || a >= uint64_t(regCount)) return "E01";
+            hexValue(out, dbg.readRegister(static_cast<Reg>(a)));
+            return out;
+
+        case 'P': {
+            Word v;
+            if (!parseHex(packet, pos, a) || a >= uint64_t(regCount) || pos >= packet.size() ||
+                packet[pos++] != '=' || !parseLittleEndian(packet, pos, v))
+                return "E01";
+            dbg.writeRegister(static_cast<Reg>(a), v);
+            return "OK";
+        }
+
+        // ----------- Memory -----------
+        // The range has to lie inside memory: a + b can't be trusted not
+        // to wrap, and a + i has to fit in a Word
+        case 'm':
+            if (!parseHex(packet, pos, a) || pos >= packet.size() || packet[pos++] != ',' ||
+                !parseHex(packet, pos, b) || b > 0x800 || a >= memSize || b > memSize - a)
+                return "E01";
+            {
+                uint8_t bytes[0x800];
+                for (uint64_t i = 0; i < b; ++i) bytes[i] = dbg.readMemory(static_cast<Word>(a + i));
+                out.resize(RohitUtils::hexSize(b));
+                RohitUtils::tohex(&out[0], bytes, b);
+            }
+            return out;
+
+        case 'M':
+            if (!parseHex(packet, pos, a) || pos >= packet.size() || packet[pos++] != ',' ||
+                !parseHex(packet, pos, b) || pos >= packet.size() || packet[pos++] != ':' ||
+                a >= memSize || b > memSize - a || packet.size() - pos < 2 * b)
+                return "E01";
+            for (uint64_t i = 0; i < b; ++i, pos += 2) {
+                int hi = hexDigit(packet[pos]), lo = hexDigit(packet[pos + 1]);
+                if (hi < 0 || lo < 0) return "E01";
+                dbg.writeMemory(static_cast<Word>(a + i), static_cast<uint8_t>((hi << 4) | lo));
+            }
+            return "OK";
+
+        // ----------- Execution -----------
+        case 'c':
+        case 's':
+            if (parseHex(packet, pos, a)) dbg.writeRegister(Debugger<Word, Mem>::IP, static_cast<Word>(a));
+            return resume(packet[0] == 's');
+
+        // ----------- Breakpoints (software and "hardware" are the same here) -----------
+        case 'Z':
+        case 'z':
+            if (packet.size() < 2 || (packet[1] != '0' && packet[1] != '1')) return "";
+            pos = 2;
+            if (pos >= packet.size() || packet[pos++] != ',' || !parseHex(packet, pos, a) || a >= memSize)
+                return "E01";
+            if (packet[0] == 'Z') dbg.setBreakpoint(static_cast<Word>(a));
+            else dbg.clearBreakpoint(static_cast<Word>(a));
+            return "OK";   // Already set / not set is fine too
+
+        // ----------- Session -----------
+        case 'D':
+            dbg.clearBreakpoints();
+            done = true;
+            return "OK";
+
+        case 'H':
+        case 'T':
+            return "OK";   // One thread
+
+        case 'q':
+            if (packet.rfind("qSupported", 0) == 0) return "PacketSize=1000;qXfer:features:read+";
+            if (packet == "qAttached") return "1";
+            if (packet == "qC") return "QC1";
+            if (packet == "qfThreadInfo") return "m1";
+            if (packet == "qsThreadInfo") return "l";
+            if (packet.rfind("qXfer:features:read:target.xml:", 0) == 0) {
+                pos = sizeof("qXfer:features:read:target.xml:") - 1;
+                if (!parseHex(packet, pos, a) || pos >= packet.size() || packet[pos++] != ',' ||
+                    !parseHex(packet, pos, b))
+                    return "E01";
+                std::string xml = targetXml();
+                if (a >= xml.size()) return "l";
+                std::string chunk = xml.substr(a, b);
+                return (a + chunk.size() >= xml.size() ? "l" : "m") + escape(chunk);
+            }
+            return "";
+
+        default:
+            return "";
+    }
+}
+
+// The debuggable machines
+template class Debugger<uint16_t, Memory>;
+template class Debugger<uint32_t, MappedMemory>;
+template class Debugger<uint16_t, PagedMemory>;
+template class Debugger<uint32_t, PagedMemory>;
+template class GdbStub<uint16_t, Memory>;
+template class GdbStub<uint32_t, MappedMemory>;
+template class GdbStub<uint16_t, PagedMemory>;
+template class GdbStub<uint32_t, PagedMemory>;
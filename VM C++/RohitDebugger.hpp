@@ -0,0 +1,141 @@
+// RohitDebugger.hpp
+#pragma once  // Ensures this header is only included once during compilation
+
+#include <cstdint>      // For fixed-width integer types like uint16_t
+#include <map>          // Address -> breakpoint
+#include <memory>       // For std::shared_ptr (private copy of the decoded program)
+#include <string>       // Packets and socket paths
+
+#include "RohitVM.hpp"       // BasicVM, Opcode::BRK, RunStatus
+#include "RohitVerifier.hpp" // VerifiedProgram, Handler::BREAK
+
+// ===========================================================================
+// Author: Rohit Yadav
+// Description: Debugger for RohitVM: breakpoints, single-step, continue and
+//              register/memory access, plus a GDB remote protocol stub on
+//              top of it.
+//
+//              Breakpoints cost nothing while they aren't hit. Setting one
+//              patches the program itself instead of adding a check to the
+//              interpreter loop:
+//                - the byte in memory becomes BRK (for the checked interpreter)
+//                - the decoded instruction becomes Handler::BREAK (for the
+//                  verified handlers; the debugger works on its own copy of
+//                  the decoded program, so other VMs sharing it see nothing)
+//              Either way run() stops with RunStatus::Breakpoint and IP on
+//              the instruction. Stepping over a breakpoint puts the original
+//              instruction back for exactly one instruction.
+//
+//              Attach after loadProgram: loading again drops the breakpoints'
+//              bookkeeping on the floor.
+
+// ===========================================================================
+// CLASS: Debugger
+// Controls one VM (VM, VM32, PagedVM or PagedVM32):
+//
+//     Debugger dbg(vm);
+//     dbg.setBreakpoint(0x0010);
+//     while (dbg.cont() == RunStatus::Breakpoint) { ...inspect, dbg.step()... }
+// ===========================================================================
+
+template <typename Word, typename Mem>
+class Debugger {
+public:
+    // Register numbers (also the GDB register numbers used by GdbStub)
+    enum Register { AX, BX, CX, DX, SP, IP, FLAGS, REGISTER_COUNT };
+
+    explicit Debugger(BasicVM<Word, Mem>& vm);
+    ~Debugger();  // Removes all breakpoints, restoring the program
+    Debugger(const Debugger&) = delete;
+    Debugger& operator=(const Debugger&) = delete;
+
+    // ----------- Breakpoints -----------
+    bool setBreakpoint(Word addr);    // false if one is already set there or addr is outside memory
+    bool clearBreakpoint(Word addr);  // false if none was set there
+    void clearBreakpoints();
+    bool hasBreakpoint(Word addr) const { return breakpoints.count(addr) != 0; }
+
+    // ----------- Execution -----------
+    // Runs exactly one instruction, even if it has a breakpoint on it.
+    // Returns RunStatus::BudgetExhausted after a normal step.
+    RunStatus step();
+
+    // Runs until a breakpoint, HLT, a trap, an input wait or the budget
+    // runs out. A breakpoint at the current IP is stepped over first.
+    RunStatus cont(uint64_t budget = BasicVM<Word, Mem>::UNLIMITED);
+
+    // ----------- State -----------
+    // Writing a register (or code the verifier proved) makes the VM drop
+    // its verified program and carry on with the checked interpreter.
+    Word readRegister(Register r) const;
+    void writeRegister(Register r, Word value);
+    uint8_t readMemory(Word addr) const;           // The program's bytes, not the patched BRKs
+    void writeMemory(Word addr, uint8_t value);
+
+    BasicVM<Word, Mem>& target() { return vm; }
+
+private:
+    struct Breakpoint {
+        uint8_t savedByte = 0;              // Memory byte under the BRK
+        int32_t index = -1;                 // Decoded instruction patched (-1 = none)
+        Handler savedHandler = Handler::NOP;
+    };
+
+    BasicVM<Word, Mem>& vm;
+    std::map<Word, Breakpoint> breakpoints;
+    std::shared_ptr<VerifiedProgram> decoded; // Our copy of vm.verified (nullptr = not copied)
+
+    void ownDecoded();                   // Makes vm.verified our private copy, with the breakpoints in it
+    void dropDecoded();                  // The proof no longer holds: use the checked interpreter
+    void patchDecoded(Word addr, Breakpoint& bp);
+    void insert(Word addr, Breakpoint& bp);
+    void remove(Word addr, Breakpoint& bp);
+};
+
+// ===========================================================================
+// CLASS: GdbStub
+// GDB remote serial protocol over TCP (127.0.0.1 only) or a Unix socket:
+//
+//     GdbStub stub(dbg);
+//     stub.listenTcp(1234);     // then in gdb: target remote :1234
+//     stub.serve();
+//
+// Supports ?, g/G, p/P, m/M, c, s, Z0/z0 (software breakpoints), D, k,
+// Ctrl-C while running, and qXfer:features:read:target.xml describing the
+// registers ax, bx, cx, dx, sp, ip, flags (each one word wide). HLT is
+// reported as an exit (W00); traps as SIGFPE/SIGSEGV/SIGILL; an IN without
+// data as SIGIO.
+// ===========================================================================
+
+template <typename Word, typename Mem>
+class GdbStub {
+public:
+    explicit GdbStub(Debugger<Word, Mem>& debugger) : dbg(debugger) {}
+    ~GdbStub();
+    GdbStub(const GdbStub&) = delete;
+    GdbStub& operator=(const GdbStub&) = delete;
+
+    // Open the listening socket (false on error, see errno)
+    bool listenTcp(uint16_t port);
+    bool listenUnix(const std::string& path);
+
+    // Waits for one client and serves it until it detaches, kills the
+    // target or disconnects. Returns false on a socket error.
+    bool serve();
+
+private:
+    Debugger<Word, Mem>& dbg;
+    int listenFd = -1;
+    int clientFd = -1;
+    std::string unixPath;              // Removed again in the destructor
+    std::string stopReply = "S05";     // Answer to '?'
+
+    int readByte();                                  // -1 on disconnect
+    bool readPacket(std::string& packet);            // Acks it; false on disconnect
+    bool sendPacket(const std::string& data);        // Waits for the ack
+    bool interrupted();                              // Has the client sent Ctrl-C?
+    std::string handle(const std::string& packet, bool& done);
+    std::string resume(bool singleStep);
+    std::string describe(RunStatus status);          // Stop reply for a run result
+    std::string targetXml() const;
+};
@@ -0,0 +1,540 @@
+// RohitFuzz.cpp
+// This file implements the differential fuzzer: the program generator, the
+// reference model and the comparison against the production VM.
+// The reference model is kept as plain as possible on purpose. It is the
+// ISA as documented in RohitVM.hpp, not a copy of the interpreter: if the
+// two ever disagree, one of them has drifted.
+
+#include "RohitFuzz.hpp"
+#include "RohitVerifier.hpp" // Verifier (the "verified" engine)
+#include "RohitLoader.hpp"   // StreamLoader (the "streamed" engine)
+#include "RohitCache.hpp"    // ResultCache (the "memoized" engine)
+#include "RohitServer.hpp"   // JobServer::prepare (how the transports set up a job)
+#include "RohitUtils.hpp"    // hash64 (the engines' chunk and slice sizes)
+#include <cstdio>        // For snprintf
+#include <cstring>       // For memcpy
+#include <utility>       // For std::swap
+
+namespace {
+
+    // -------------------------------
+    // Struct: ByteReader
+    // Hands out the fuzz input a byte or a word at a time (zeros once it runs out)
+    struct ByteReader {
+        const uint8_t* data;
+        size_t size;
+        size_t pos = 0;
+
+        bool done() const { return pos >= size; }
+        uint8_t byte() { return pos < size ? data[pos++] : 0; }
+        uint16_t word() { uint16_t lo = byte(); return static_cast<uint16_t>(lo | (byte() << 8)); }
+    };
+
+    // -------------------------------
+    // Function: referenceSize
+    // Purpose: Encoded size of an opcode, straight from the opcode table
+    // (0 = illegal). Deliberately not VM::getInstructionSize.
+    int referenceSize(uint8_t op) {
+        switch (op) {
+            case 0x01: case 0x02:                                   // NOP HLT
+            case 0x10: case 0x11: case 0x12: case 0x13:             // STE CLE STG CLG
+            case 0x14: case 0x15: case 0x16: case 0x17:             // STH CLH STL CLL
+            case 0x1C: case 0x1D:                                   // PUSHF POPF
+            case 0x20: case 0x21: case 0x22: case 0x23: case 0x24:  // ADD SUB MUL DIV CMP
+            case 0x32:                                              // RET
+            case 0x3A: case 0x3B: case 0x3C:                        // BSWAP16 BSWAP32 BSWAP64
+            case 0xCC:                                              // BRK
+                return 1;
+            case 0x08: case 0x09: case 0x0A: case 0x0B: case 0x0C:  // MOV AX..SP
+            case 0x1A: case 0x1B:                                   // PUSH POP
+            case 0x30: case 0x31:                                   // JMP CALL
+            case 0x33: case 0x34: case 0x35: case 0x36:             // JE JNE JG JL
+                return 3;
+            case 0x38: case 0x39:                                   // IN OUT
+                return 5;
+            default:
+                return 0;
+        }
+    }
+
+    // Opcodes the generator picks from (BRK and IN/OUT included, so every
+    // way run() can stop gets exercised)
+    const Opcode generated[] = {
+        Opcode::NOP, Opcode::HLT,
+        Opcode::MOV, Opcode::MOV_BX, Opcode::MOV_CX, Opcode::MOV_DX, Opcode::MOV_SP,
+        Opcode::STE, Opcode::CLE, Opcode::STG, Opcode::CLG,
+        Opcode::STH, Opcode::CLH, Opcode::STL, Opcode::CLL,
+        Opcode::PUSH, Opcode::POP, Opcode::PUSHF, Opcode::POPF,
+        Opcode::ADD, Opcode::SUB, Opcode::MUL, Opcode::DIV, Opcode::CMP,
+        Opcode::JMP, Opcode::CALL, Opcode::RET,
+        Opcode::JE, Opcode::JNE, Opcode::JG, Opcode::JL,
+        Opcode::IN, Opcode::OUT, Opcode::BSWAP16, Opcode::BSWAP32, Opcode::BSWAP64, Opcode::BRK
+    };
+    constexpr size_t GENERATED_COUNT = sizeof(generated) / sizeof(generated[0]);
+
+    // Stack pointers worth trying with MOV SP (edges of both stack checks)
+    const uint16_t interestingSp[] = {0xFFFF, 0xFFFE, 0xFFFD, 0x8000, 0x0003, 0x0002, 0x0001, 0x0000};
+
+    const char* statusName[] = {"Halted", "BudgetExhausted", "WaitingForInput", "Breakpoint", "Trapped",
+                                "WaitingForCode"};
+    static_assert(sizeof(statusName) / sizeof(statusName[0]) == RUN_STATUS_COUNT, "One name per RunStatus");
+
+    // -------------------------------
+    // Function: runVM
+    // Purpose: The production VM engines. Loads the image like rohit-gdbserver
+    // does (raw bytes, then the verifier) and runs it once.
+    std::optional<FuzzOutcome> runVM(const std::vector<uint8_t>& image, uint64_t budget, bool useVerified) {
+        VM vm;
+        for (uint8_t byte : image) vm.memory.poke(vm.breakLine++, byte);
+        vm.verified = Verifier::verify(image.data(), vm.breakLine, vm.cpu.r.ip, vm.cpu.r.sp);
+        if (useVerified && !vm.verified) return std::nullopt; // Would just repeat "checked"
+        if (!useVerified) vm.verified = nullptr;
+
+        FuzzOutcome out;
+        out.outputHash = FuzzHost::HASH_SEED;
+        vm.onInput = [](uint16_t port, uint16_t& value) { return FuzzHost::input(port, value); };
+        vm.onOutput = [&out](uint16_t port, uint16_t value) { FuzzHost::output(out.outputHash, port, value); };
+
+        out.status = vm.run(budget);
+        out.trap = out.status == RunStatus::Trapped ? vm.trap : Trap::None;
+        out.regs = vm.cpu.r;
+        out.instructions = vm.instructionsExecuted;
+        out.memoryHash = FuzzHost::hashMemory(vm.memory.raw());
+        return out;
+    }
+
+    // -------------------------------
+    // Function: runStreamed
+    // Purpose: The "streamed" engine. The image goes in through StreamLoader
+    // 1-16 bytes at a time, with slices of 1-64 instructions run in between,
+    // so the program keeps catching up with the load and stopping with
+    // WaitingForCode. Sizes come from the image's hash, so a mismatch
+    // reproduces; half the images are streamed without announcing their size.
+    std::optional<FuzzOutcome> runStreamed(const std::vector<uint8_t>& image, uint64_t budget) {
+        if (image.size() > StreamLoader::MAX_IMAGE) return std::nullopt;
+        uint64_t random = RohitUtils::hash64(image.data(), image.size()) | 1;
+        auto next = [&random](uint64_t n) {   // xorshift64
+            random ^= random << 13;
+            random ^= random >> 7;
+            random ^= random << 17;
+            return random % n;
+        };
+
+        VM vm;
+        FuzzOutcome out;
+        out.outputHash = FuzzHost::HASH_SEED;
+        vm.onInput = [](uint16_t port, uint16_t& value) { return FuzzHost::input(port, value); };
+        vm.onOutput = [&out](uint16_t port, uint16_t value) { FuzzHost::output(out.outputHash, port, value); };
+
+        StreamLoader loader(vm, next(2) ? image.size() : 0);
+        size_t at = 0;
+        for (;;) {
+            out.status = vm.run(std::min<uint64_t>(budget - vm.instructionsExecuted, 1 + next(64)));
+            if (out.status != RunStatus::WaitingForCode &&
+                (out.status != RunStatus::BudgetExhausted || vm.instructionsExecuted >= budget))
+                break;
+            if (at < image.size()) {
+                size_t n = std::min<size_t>(1 + next(16), image.size() - at);
+                loader.append(image.data() + at, n);
+                at += n;
+            } else {
+                loader.finish();
+            }
+        }
+        // The rest arrives after the program stopped (memory is compared)
+        loader.append(image.data() + at, image.size() - at);
+        loader.finish();
+
+        out.trap = out.status == RunStatus::Trapped ? vm.trap : Trap::None;
+        out.regs = vm.cpu.r;
+        out.instructions = vm.instructionsExecuted;
+        out.memoryHash = FuzzHost::hashMemory(vm.memory.raw());
+        return out;
+    }
+
+    // -------------------------------
+    // Function: runMemoized
+    // Purpose: The "memoized" engine: the job is answered from a ResultCache
+    // like the transports answer a hit (MemoizedRun::applyTo on a VM set up
+    // by JobServer::prepare), never by the run itself. The result is
+    // recorded with the fuzzer's budget or, for half the images, a larger
+    // one, so reusing a result across budgets is checked too; if the cache
+    // rightly refuses that, the job is recorded again with the real budget.
+    // (FuzzHost's IN values depend on the port only, so runs stay pure.)
+    std::optional<FuzzOutcome> runMemoized(ResultCache& results, const std::vector<uint8_t>& image,
+                                           uint64_t budget) {
+        if (image.size() >= Memory::SIZE) return std::nullopt;
+        const uint8_t* bytes = image.data();
+        const uint16_t size = static_cast<uint16_t>(image.size());
+
+        VM vm;
+        const Registers regs = vm.cpu.r;   // A fresh VM's, like the other engines
+        std::vector<std::pair<uint16_t, uint16_t>> output;
+        vm.onInput = [](uint16_t port, uint16_t& value) { return FuzzHost::input(port, value); };
+        vm.onOutput = [&output](uint16_t port, uint16_t value) { output.emplace_back(port, value); };
+        auto record = [&](uint64_t n) {
+            output.clear();
+            JobServer::prepare(vm, bytes, size, regs);
+            RunStatus status = vm.run(n);
+            results.store(bytes, size, regs, n, status, vm, output, false);
+        };
+
+        const uint64_t more = RohitUtils::hash64(bytes, size) % 2 ? budget + 1 + image.size() : budget;
+        record(more);
+        std::shared_ptr<const MemoizedRun> hit = results.lookup(bytes, size, regs, budget);
+        if (!hit && more != budget) {
+            record(budget);
+            hit = results.lookup(bytes, size, regs, budget);
+        }
+        if (!hit) return std::nullopt;   // Only if the entry was evicted straight away
+
+        VM answer;
+        JobServer::prepare(answer, bytes, size, regs);
+        hit->applyTo(answer);
+
+        FuzzOutcome out;
+        out.status = hit->status;
+        out.trap = out.status == RunStatus::Trapped ? answer.trap : Trap::None;
+        out.regs = answer.cpu.r;
+        out.instructions = answer.instructionsExecuted;
+        out.memoryHash = FuzzHost::hashMemory(answer.memory.raw());
+        out.outputHash = FuzzHost::HASH_SEED;
+        for (const auto& value : hit->output) FuzzHost::output(out.outputHash, value.first, value.second);
+        return out;
+    }
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Function: FuzzOutcome::operator== / toString
+bool FuzzOutcome::operator==(const FuzzOutcome& o) const {
+    return status == o.status && trap == o.trap &&
+           regs.ax == o.regs.ax && regs.bx == o.regs.bx && regs.cx == o.regs.cx && regs.dx == o.regs.dx &&
+           regs.sp == o.regs.sp && regs.ip == o.regs.ip && regs.flags == o.regs.flags &&
+           instructions == o.instructions && memoryHash == o.memoryHash && outputHash == o.outputHash;
+}
+
+std::string FuzzOutcome::toString() const {
+    char buf[256];
+    snprintf(buf, sizeof(buf),
+             "%s trap=%d AX=%04x BX=%04x CX=%04x DX=%04x SP=%04x IP=%04x FLAGS=%x n=%llu mem=%016llx out=%016llx",
+             statusName[static_cast<int>(status)], static_cast<int>(trap),
+             regs.ax, regs.bx, regs.cx, regs.dx, regs.sp, regs.ip, regs.flags,
+             static_cast<unsigned long long>(instructions),
+             static_cast<unsigned long long>(memoryHash), static_cast<unsigned long long>(outputHash));
+    return buf;
+}
+
+// ---------------------------------------------------------------------------
+// Function: FuzzHost::input / output / hashMemory
+bool FuzzHost::input(uint16_t port, uint16_t& value) {
+    if (port & 0x8000) return false;
+    value = static_cast<uint16_t>(port * 0x9E37 + 0x55);
+    return true;
+}
+
+void FuzzHost::output(uint64_t& hash, uint16_t port, uint16_t value) {
+    hash = (hash ^ ((uint64_t(port) << 16) | value)) * 0x100000001b3ull;
+}
+
+uint64_t FuzzHost::hashMemory(const uint8_t* bytes) {
+    // FNV-1a over 8-byte words: 8192 rounds for the whole 64 KiB
+    uint64_t hash = HASH_SEED;
+    for (size_t i = 0; i < Memory::SIZE; i += 8) {
+        uint64_t w;
+        memcpy(&w, bytes + i, 8);
+        hash = (hash ^ w) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+// ---------------------------------------------------------------------------
+// Function: ReferenceModel::run
+// Purpose: The ISA, one instruction at a time, with nothing cached or
+// proven. Traps leave IP past the instruction (IN without data, BRK and
+// illegal opcodes leave it on the instruction), like the documented VM.
+FuzzOutcome ReferenceModel::run(const std::vector<uint8_t>& image, uint64_t budget) {
+    std::vector<uint8_t> mem(Memory::SIZE, 0);
+    for (size_t i = 0; i < image.size() && i < mem.size(); ++i) mem[i] = image[i];
+
+    FuzzOutcome out;
+    out.outputHash = FuzzHost::HASH_SEED;
+    Registers& r = out.regs;
+    r.sp = 0xFFFF;                      // A fresh VM's stack starts at the top of memory
+
+    auto word = [&](uint16_t addr) { return static_cast<uint16_t>(mem[addr] | (mem[uint16_t(addr + 1)] << 8)); };
+    auto reg = [&](uint16_t n) -> uint16_t& {
+        return n == 0 ? r.ax : n == 1 ? r.bx : n == 2 ? r.cx : r.dx;
+    };
+    auto stop = [&](RunStatus status, Trap trap) {
+        out.status = status;
+        out.trap = trap;
+        out.memoryHash = FuzzHost::hashMemory(mem.data());
+        return out;
+    };
+    // Flags of a - b (SUB, CMP) and of a finished ADD/MUL
+    auto compareFlags = [&](uint16_t a, uint16_t b) {
+        uint16_t result = static_cast<uint16_t>(a - b);
+        r.flags = (a == b ? Registers::Equal : 0) | (a > b ? Registers::Greater : 0) |
+                  (a < b ? Registers::Lower : 0) | (result & 0x8000 ? Registers::Higher : 0);
+    };
+    auto resultFlags = [&](uint32_t wide) {
+        uint16_t result = static_cast<uint16_t>(wide);
+        r.flags = (result == 0 ? Registers::Equal : 0) | (wide > 0xFFFF ? Registers::Greater : 0) |
+                  (result & 0x8000 ? Registers::Higher : 0);
+    };
+
+    while (out.instructions < budget) {
+        uint16_t at = r.ip;
+        uint8_t op = mem[at];
+        int size = referenceSize(op);
+        if (size == 0) return stop(RunStatus::Trapped, Trap::IllegalInstruction);
+
+        uint16_t a1 = word(static_cast<uint16_t>(at + 1));
+        uint16_t a2 = word(static_cast<uint16_t>(at + 3));
+        r.ip = static_cast<uint16_t>(at + size);
+
+        switch (static_cast<Opcode>(op)) {
+            case Opcode::NOP: break;
+            case Opcode::HLT: out.instructions++; return stop(RunStatus::Halted, Trap::None);
+
+            case Opcode::MOV:    r.ax = a1; break;
+            case Opcode::MOV_BX: r.bx = a1; break;
+            case Opcode::MOV_CX: r.cx = a1; break;
+            case Opcode::MOV_DX: r.dx = a1; break;
+            case Opcode::MOV_SP: r.sp = a1; break;
+
+            case Opcode::STE: r.flags |= Registers::Equal; break;
+            case Opcode::CLE: r.flags &= ~Registers::Equal; break;
+            case Opcode::STG: r.flags |= Registers::Greater; break;
+            case Opcode::CLG: r.flags &= ~Registers::Greater; break;
+            case Opcode::STH: r.flags |= Registers::Higher; break;
+            case Opcode::CLH: r.flags &= ~Registers::Higher; break;
+            case Opcode::STL: r.flags |= Registers::Lower; break;
+            case Opcode::CLL: r.flags &= ~Registers::Lower; break;
+
+            case Opcode::ADD: resultFlags(uint32_t(r.ax) + r.bx); r.ax = static_cast<uint16_t>(r.ax + r.bx); break;
+            case Opcode::SUB: compareFlags(r.ax, r.bx); r.ax = static_cast<uint16_t>(r.ax - r.bx); break;
+            case Opcode::MUL: resultFlags(uint32_t(r.ax) * r.bx); r.ax = static_cast<uint16_t>(uint32_t(r.ax) * r.bx); break;
+            case Opcode::CMP: compareFlags(r.ax, r.bx); break;
+            case Opcode::DIV:
+                if (r.bx == 0) return stop(RunStatus::Trapped, Trap::DivideByZero);
+                r.ax = static_cast<uint16_t>(r.ax / r.bx);
+                break;
+
+            // Stack: PUSH needs SP >= 2, POP needs SP <= 0xFFFE; low byte at the lower address
+            case Opcode::PUSH:
+            case Opcode::PUSHF:
+            case Opcode::CALL: {
+                if (static_cast<Opcode>(op) == Opcode::PUSH && a1 > 3)
+                    return stop(RunStatus::Trapped, Trap::InvalidRegister);
+                if (r.sp < 2) return stop(RunStatus::Trapped, Trap::StackOverflow);
+                uint16_t value = static_cast<Opcode>(op) == Opcode::PUSH ? reg(a1)
+                               : static_cast<Opcode>(op) == Opcode::PUSHF ? r.flags : r.ip;
+                r.sp -= 2;
+                mem[r.sp] = value & 0xff;
+                mem[uint16_t(r.sp + 1)] = value >> 8;
+                if (static_cast<Opcode>(op) == Opcode::CALL) r.ip = a1;
+                break;
+            }
+            case Opcode::POP:
+            case Opcode::POPF:
+            case Opcode::RET: {
+                if (static_cast<Opcode>(op) == Opcode::POP && a1 > 3)
+                    return stop(RunStatus::Trapped, Trap::InvalidRegister);
+                if (r.sp > 0xFFFE) return stop(RunStatus::Trapped, Trap::StackUnderflow);
+                uint16_t value = word(r.sp);
+                r.sp += 2;
+                if (static_cast<Opcode>(op) == Opcode::POP) reg(a1) = value;
+                else if (static_cast<Opcode>(op) == Opcode::POPF) r.flags = value & 0x0F;
+                else r.ip = value;
+                break;
+            }
+
+            case Opcode::JMP: r.ip = a1; break;
+            case Opcode::JE:  if (r.flags & Registers::Equal) r.ip = a1; break;
+            case Opcode::JNE: if (!(r.flags & Registers::Equal)) r.ip = a1; break;
+            case Opcode::JG:  if (r.flags & Registers::Greater) r.ip = a1; break;
+            case Opcode::JL:  if (r.flags & Registers::Lower) r.ip = a1; break;
+
+            case Opcode::IN: {
+                if (a1 > 3) return stop(RunStatus::Trapped, Trap::InvalidRegister);
+                uint16_t value;
+                if (!FuzzHost::input(a2, value)) {
+                    r.ip = at;
+                    return stop(RunStatus::WaitingForInput, Trap::None);
+                }
+                reg(a1) = value;
+                break;
+            }
+            case Opcode::OUT:
+                if (a1 > 3) return stop(RunStatus::Trapped, Trap::InvalidRegister);
+                FuzzHost::output(out.outputHash, a2, reg(a1));
+                break;
+
+            // Block swap: CX elements at DX, the whole block inside memory (no wraparound)
+            case Opcode::BSWAP16:
+            case Opcode::BSWAP32:
+            case Opcode::BSWAP64: {
+                uint32_t width = op == 0x3A ? 2 : op == 0x3B ? 4 : 8;
+                if (uint32_t(r.dx) + uint32_t(r.cx) * width > mem.size())
+                    return stop(RunStatus::Trapped, Trap::MemoryFault);
+                for (uint32_t e = r.dx; e < uint32_t(r.dx) + uint32_t(r.cx) * width; e += width)
+                    for (uint32_t lo = e, hi = e + width - 1; lo < hi; ++lo, --hi) std::swap(mem[lo], mem[hi]);
+                break;
+            }
+
+            case Opcode::BRK:
+                r.ip = at;
+                return stop(RunStatus::Breakpoint, Trap::None);
+
+            default:
+                return stop(RunStatus::Trapped, Trap::IllegalInstruction); // Not reached: size was 0
+        }
+        out.instructions++;
+    }
+    return stop(RunStatus::BudgetExhausted, Trap::None);
+}
+
+// ---------------------------------------------------------------------------
+// Function: DifferentialFuzzer::DifferentialFuzzer / addEngine / engineStats
+DifferentialFuzzer::DifferentialFuzzer(uint64_t instructionBudget) : budget(instructionBudget) {
+    addEngine("checked", [](const std::vector<uint8_t>& image, uint64_t n) { return runVM(image, n, false); });
+    addEngine("verified", [](const std::vector<uint8_t>& image, uint64_t n) { return runVM(image, n, true); });
+    addEngine("streamed", runStreamed);
+    auto results = std::make_shared<ResultCache>();
+    addEngine("memoized", [results](const std::vector<uint8_t>& image, uint64_t n) {
+        return runMemoized(*results, image, n);
+    });
+}
+
+void DifferentialFuzzer::addEngine(const std::string& name, Engine engine) {
+    engines.push_back({name, std::move(engine)});
+}
+
+std::vector<DifferentialFuzzer::EngineStats> DifferentialFuzzer::engineStats() const {
+    std::vector<EngineStats> stats;
+    for (const Slot& slot : engines) stats.push_back({slot.name, slot.runs});
+    return stats;
+}
+
+// ---------------------------------------------------------------------------
+// Function: DifferentialFuzzer::generate
+// Purpose: Turns fuzz bytes into a program. Each instruction takes one
+// selector byte (0xF0 and above: the next byte is used as a raw, possibly
+// illegal opcode) and then its operands:
+//   - register operands: a byte, AX-DX unless the byte is 0xF0 or above
+//   - jump/call targets: a word; the start of instruction (word % count)
+//     unless the top bit is set, then the raw address (word & 0x7FFF)
+//   - MOV SP: a byte picking one of the interesting stack pointers, or a raw word
+//   - MOV CX / MOV DX: a byte picking a short count / an address in the
+//     program or at the end of memory (BSWAP blocks), or a raw word
+//   - everything else: raw words
+// Targets are resolved once every instruction's address is known, so small
+// changes to the input keep most of the control flow intact.
+std::vector<uint8_t> DifferentialFuzzer::generate(const uint8_t* data, size_t size) {
+    struct Pending { uint8_t op; uint16_t a1, a2; bool resolve; };
+    ByteReader in{data, size};
+    std::vector<Pending> program;
+
+    while (!in.done() && program.size() < MAX_INSTRUCTIONS) {
+        Pending p{0, 0, 0, false};
+        uint8_t selector = in.byte();
+        p.op = selector >= 0xF0 ? in.byte() : static_cast<uint8_t>(generated[selector % GENERATED_COUNT]);
+
+        switch (static_cast<Opcode>(p.op)) {
+            case Opcode::PUSH: case Opcode::POP: case Opcode::IN: case Opcode::OUT: {
+                uint8_t r = in.byte();
+                p.a1 = r >= 0xF0 ? r : (r & 3);
+                p.a2 = in.word();                         // Port (unused by PUSH/POP)
+                break;
+            }
+            case Opcode::JMP: case Opcode::CALL:
+            case Opcode::JE: case Opcode::JNE: case Opcode::JG: case Opcode::JL: {
+                uint16_t t = in.word();
+                p.resolve = !(t & 0x8000);
+                p.a1 = p.resolve ? t : (t & 0x7FFF);
+                break;
+            }
+            case Opcode::MOV_SP: {
+                uint8_t pick = in.byte();
+                p.a1 = pick < 0xF0 ? interestingSp[pick % 8] : in.word();
+                break;
+            }
+            case Opcode::MOV_CX: {
+                uint8_t pick = in.byte();
+                p.a1 = pick < 0xC0 ? (pick & 0x3F) : in.word();   // Mostly short BSWAP blocks
+                break;
+            }
+            case Opcode::MOV_DX: {
+                uint8_t pick = in.byte();
+                if (pick < 0x40) p.a1 = pick * 8;                          // In (or near) the program
+                else if (pick >= 0xF0) p.a1 = static_cast<uint16_t>(0x10000 - (pick - 0xEF) * 8); // End of memory
+                else p.a1 = in.word();
+                break;
+            }
+            default:
+                p.a1 = in.word();
+                p.a2 = in.word();
+                break;
+        }
+        program.push_back(p);
+    }
+
+    // Lay out the bytes, then point resolved targets at instruction starts
+    std::vector<uint16_t> addr;
+    std::vector<uint8_t> image;
+    for (const Pending& p : program) {
+        addr.push_back(static_cast<uint16_t>(image.size()));
+        int len = referenceSize(p.op);
+        image.push_back(p.op);
+        if (len >= 3) { image.push_back(p.a1 & 0xff); image.push_back(p.a1 >> 8); }
+        if (len == 5) { image.push_back(p.a2 & 0xff); image.push_back(p.a2 >> 8); }
+    }
+    for (size_t i = 0; i < program.size(); ++i) {
+        if (!program[i].resolve) continue;
+        uint16_t target = addr[program[i].a1 % addr.size()];
+        image[addr[i] + 1] = target & 0xff;
+        image[addr[i] + 2] = target >> 8;
+    }
+    return image;
+}
+
+// ---------------------------------------------------------------------------
+// Function: DifferentialFuzzer::check / checkImage
+// Purpose: Runs the reference and every engine; reports the first disagreement
+bool DifferentialFuzzer::check(const uint8_t* data, size_t size, std::string* report) {
+    return checkImage(generate(data, size), report);
+}
+
+bool DifferentialFuzzer::checkImage(const std::vector<uint8_t>& image, std::string* report) {
+    executions++;
+    FuzzOutcome expected = ReferenceModel::run(image, budget);
+    byStatus[static_cast<int>(expected.status)]++;
+
+    std::vector<std::pair<std::string, FuzzOutcome>> results;
+    bool same = true;
+    for (Slot& slot : engines) {
+        std::optional<FuzzOutcome> got = slot.engine(image, budget);
+        if (!got) continue;
+        slot.runs++;
+        if (*got != expected) same = false;
+        results.emplace_back(slot.name, *got);
+    }
+    if (same) return true;
+
+    mismatches++;
+    if (report) {
+        std::string text = "Engines disagree on a " + std::to_string(image.size()) + "-byte program:\n ";
+        char hex[4];
+        for (uint8_t byte : image) {
+            snprintf(hex, sizeof(hex), " %02x", byte);
+            text += hex;
+        }
+        text += "\n  reference: " + expected.toString() + "\n";
+        for (const auto& [name, outcome] : results)
+            text += "  " + name + (outcome == expected ? " (same)" : " (DIFFERENT)") + ": " + outcome.toString() + "\n";
+        *report = text;
+    }
+    return false;
+}
@@ -0,0 +1,143 @@
+// RohitFuzz.hpp
+#pragma once  // Ensures this header is only included once during compilation
+
+#include <cstdint>      // For fixed-width integer types like uint16_t
+#include <functional>   // Engines are plain callables
+#include <optional>     // An engine may decline an image
+#include <string>       // Engine names and mismatch reports
+#include <vector>       // Program images and the engine list
+
+#include "RohitVM.hpp"  // Registers, Trap, RunStatus (what gets compared)
+
+// ===========================================================================
+// Author: Rohit Yadav
+// Description: Differential fuzzing for RohitVM.
+//              Every fuzz input is turned into a 16-bit program image
+//              (mostly well-formed instructions, plus invalid opcodes,
+//              register operands and jump targets the input asks for). The
+//              image then runs with the same instruction budget on:
+//                - ReferenceModel: a deliberately simple interpreter of the
+//                  ISA written straight from the opcode table. It shares no
+//                  code with the VM: its own decoder, eager flags, one byte
+//                  of memory at a time, no verifier and no decoded stream.
+//                - the production VM on the checked interpreter
+//                - the production VM on the verified handlers (when the
+//                  verifier accepts the program)
+//                - the production VM loading the image through
+//                  StreamLoader in small chunks while it runs
+//                - the job answered from a ResultCache (MemoizedRun::applyTo)
+//                - any engine added with addEngine()
+//              The final registers (FLAGS included), a hash of the 64 KiB of
+//              memory, a hash of everything written with OUT, the run status,
+//              the trap kind and the instruction count all have to match the
+//              reference.
+//
+//              IN reads a value derived from the port; ports with the top bit
+//              set have no data, so the WaitingForInput path is covered too.
+//
+//              Works as a libFuzzer target (fuzz_main.cpp built with
+//              -fsanitize=fuzzer -DROHIT_LIBFUZZER) and as an AFL target or a
+//              stand-alone random fuzzer that reports execs/sec (fuzz_main.cpp
+//              built normally).
+
+// ===========================================================================
+// STRUCT: FuzzOutcome
+// Everything an engine reports about one run. Two engines agree when all
+// the fields are equal.
+// ===========================================================================
+
+struct FuzzOutcome {
+    RunStatus status = RunStatus::BudgetExhausted;
+    Trap trap = Trap::None;        // Only meaningful when status == Trapped
+    Registers regs;                // Registers when the run stopped (FLAGS materialized)
+    uint64_t instructions = 0;     // Instructions counted as executed
+    uint64_t memoryHash = 0;       // Hash of all 64 KiB of memory
+    uint64_t outputHash = 0;       // Hash of every (port, value) written by OUT, in order
+
+    bool operator==(const FuzzOutcome& other) const;
+    bool operator!=(const FuzzOutcome& other) const { return !(*this == other); }
+    std::string toString() const;  // One line, for mismatch reports
+};
+
+// ===========================================================================
+// CLASS: FuzzHost
+// The host side every engine has to provide in the same way: the IN values,
+// the OUT hash and the memory hash.
+// ===========================================================================
+
+class FuzzHost {
+public:
+    static constexpr uint64_t HASH_SEED = 0xcbf29ce484222325ull;
+
+    // Value IN reads from 'port'; false if the port has no data (top bit set)
+    static bool input(uint16_t port, uint16_t& value);
+
+    // Folds one OUT into the running hash
+    static void output(uint64_t& hash, uint16_t port, uint16_t value);
+
+    // Hash of a 64 KiB memory image
+    static uint64_t hashMemory(const uint8_t* bytes);
+};
+
+// ===========================================================================
+// CLASS: ReferenceModel
+// The reference interpreter. Loads the image at address 0, starts with the
+// registers a fresh VM has and runs at most 'budget' instructions.
+// ===========================================================================
+
+class ReferenceModel {
+public:
+    static FuzzOutcome run(const std::vector<uint8_t>& image, uint64_t budget);
+};
+
+// ===========================================================================
+// CLASS: DifferentialFuzzer
+// Runs the reference and every engine on one input and compares them.
+//
+//     DifferentialFuzzer fuzzer;
+//     fuzzer.addEngine("jit", [](const std::vector<uint8_t>& image, uint64_t budget)
+//                                  -> std::optional<FuzzOutcome> {
+//         ...run it, or return std::nullopt if the engine can't take it...
+//     });
+//     std::string report;
+//     if (!fuzzer.check(data, size, &report)) { std::cerr << report; abort(); }
+// ===========================================================================
+
+class DifferentialFuzzer {
+public:
+    // An engine runs an image (loaded at address 0, fresh registers) for
+    // at most 'budget' instructions and reports what happened, or returns
+    // std::nullopt for images it doesn't handle (nothing is compared then)
+    using Engine = std::function<std::optional<FuzzOutcome>(const std::vector<uint8_t>& image, uint64_t budget)>;
+
+    static constexpr uint64_t DEFAULT_BUDGET = 10000;
+    static constexpr size_t MAX_INSTRUCTIONS = 256;   // Per generated program
+
+    // Registers the production VM engines: "checked", "verified" for the
+    // images the verifier accepts, "streamed" and "memoized"
+    explicit DifferentialFuzzer(uint64_t budget = DEFAULT_BUDGET);
+
+    void addEngine(const std::string& name, Engine engine);
+
+    // Builds the program for a fuzz input (any bytes are fine)
+    static std::vector<uint8_t> generate(const uint8_t* data, size_t size);
+
+    // Generates, runs and compares. Returns false on a mismatch and, if
+    // 'report' is given, describes the program and every engine's outcome.
+    bool check(const uint8_t* data, size_t size, std::string* report = nullptr);
+    bool checkImage(const std::vector<uint8_t>& image, std::string* report = nullptr);
+
+    // ----------- Statistics -----------
+    struct EngineStats { std::string name; uint64_t runs = 0; };
+
+    uint64_t executions = 0;       // Images checked
+    uint64_t mismatches = 0;
+    uint64_t byStatus[RUN_STATUS_COUNT] = {};   // Reference outcomes, indexed by RunStatus
+    std::vector<EngineStats> engineStats() const;  // Images each engine took
+
+private:
+    struct Slot { std::string name; Engine engine; uint64_t runs = 0; };
+
+    uint64_t budget;
+    std::vector<Slot> engines;
+};
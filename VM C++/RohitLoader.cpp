@@ -0,0 +1,120 @@
+// RohitLoader.cpp
+// This file implements the streaming program loader: taking the image in
+// chunk by chunk, moving the VM's pending range along, and the run loop
+// that reads while the program executes.
+
+#include "RohitLoader.hpp"
+#include "RohitUtils.hpp"    // copy
+#include "RohitVerifier.hpp" // Verifier (same fast path as loadProgram)
+#include <algorithm>         // For std::min
+#include <cerrno>            // EINTR
+#include <cstring>           // For strerror
+#include <poll.h>            // poll (is more of the image there yet?)
+#include <unistd.h>          // read
+
+// ---------------------------------------------------------------------------
+// Function: StreamLoader::StreamLoader
+// Purpose: Nothing is loaded yet, so the whole image is pending
+StreamLoader::StreamLoader(VM& v, size_t imageSize)
+    : vm(v), limit(imageSize ? std::min(imageSize, MAX_IMAGE) : MAX_IMAGE),
+      entryIp(v.cpu.r.ip), entrySp(v.cpu.r.sp) {
+    vm.verified.reset();   // Whatever was proven was for other bytes
+    vm.breakLine = 0;
+    vm.pendingBegin = 0;
+    vm.pendingEnd = imageSize ? limit : Memory::SIZE;
+}
+
+// ---------------------------------------------------------------------------
+// Function: StreamLoader::overflow
+bool StreamLoader::overflow() {
+    errorMessage = limit == MAX_IMAGE ? "Image larger than memory" : "Image larger than announced";
+    return false;
+}
+
+// ---------------------------------------------------------------------------
+// Function: StreamLoader::append
+bool StreamLoader::append(const uint8_t* data, size_t size) {
+    if (done || size > limit - loadedBytes) return overflow();
+    RohitUtils::copy(vm.memory.raw() + loadedBytes, data, size);
+    loadedBytes += size;
+    vm.pendingBegin = loadedBytes;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Function: StreamLoader::finish
+void StreamLoader::finish() {
+    if (done) return;
+    done = true;
+    vm.pendingBegin = vm.pendingEnd = 0;
+    vm.breakLine = static_cast<uint16_t>(loadedBytes);
+    vm.verified = Verifier::verify(vm.memory.raw(), static_cast<uint16_t>(loadedBytes), entryIp, entrySp);
+}
+
+// ---------------------------------------------------------------------------
+// Function: StreamLoader::pull
+// Purpose: Reads go straight into memory. Once 'limit' bytes are in, one
+// more byte is read into a scratch byte to tell the end of the stream
+// from an image that is too large.
+ssize_t StreamLoader::pull(int fd, bool wait) {
+    if (done) return 0;
+    if (!wait) {
+        pollfd p = {fd, POLLIN, 0};
+        if (poll(&p, 1, 0) <= 0) return 0;   // Nothing there yet (hangups count as ready)
+    }
+
+    uint8_t extra;
+    const size_t room = std::min(limit - loadedBytes, CHUNK);
+    uint8_t* into = room ? vm.memory.raw() + loadedBytes : &extra;
+    ssize_t n;
+    do {
+        n = read(fd, into, room ? room : 1);
+    } while (n < 0 && errno == EINTR);
+
+    if (n < 0) {
+        errorMessage = std::string("Cannot read the program: ") + strerror(errno);
+        return -1;
+    }
+    if (n == 0) {
+        finish();
+        return 0;
+    }
+    if (!room) {
+        overflow();
+        return -1;
+    }
+    loadedBytes += static_cast<size_t>(n);
+    vm.pendingBegin = loadedBytes;
+    return n;
+}
+
+// ---------------------------------------------------------------------------
+// Function: StreamLoader::run
+// Purpose: Sliced while loading, so the image keeps coming in even if the
+// program never waits for it; one plain vm.run() once it's complete
+RunStatus StreamLoader::run(int fd, uint64_t budget) {
+    // Instruction count at which this call ends (saturating, as in VM::run)
+    const uint64_t stopAt = budget > VM::UNLIMITED - vm.instructionsExecuted
+                                ? VM::UNLIMITED : vm.instructionsExecuted + budget;
+
+    for (;;) {
+        const uint64_t left = stopAt - vm.instructionsExecuted;
+        RunStatus status = vm.run(done ? left : std::min(left, SLICE));
+
+        ssize_t n = 0;
+        if (status == RunStatus::WaitingForCode) {
+            stalls++;
+            n = pull(fd, true);
+        } else if (status == RunStatus::BudgetExhausted && vm.instructionsExecuted < stopAt) {
+            while ((n = pull(fd, false)) > 0) {}
+        } else {
+            return status;
+        }
+
+        if (n < 0) {
+            vm.trap = Trap::MemoryFault;
+            vm.trapMessage = errorMessage;
+            return RunStatus::Trapped;
+        }
+    }
+}
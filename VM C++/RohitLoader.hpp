@@ -0,0 +1,95 @@
+// RohitLoader.hpp
+#pragma once  // Ensures this header is only included once during compilation
+
+#include <cstddef>      // For size_t
+#include <cstdint>      // For fixed-width integer types like uint16_t
+#include <string>       // Error messages
+#include <sys/types.h>  // ssize_t
+
+#include "RohitVM.hpp"  // VM, RunStatus
+
+// ===========================================================================
+// Author: Rohit Yadav
+// Description: Streaming program loader.
+//              loadProgram wants the whole program up front, so a large
+//              generated image arriving over a pipe could only start once
+//              the last byte was read. StreamLoader copies the image into
+//              the VM's memory (at address 0, the bytes VM::encode makes)
+//              chunk by chunk instead, and the VM starts at its entry IP as
+//              soon as the first chunk is in.
+//
+//              The bytes arrive in order, so what is loaded is [0, loaded())
+//              and the rest of the image is the VM's pending range
+//              (vm.pendingBegin / pendingEnd). The checked interpreter
+//              won't fetch from it, or let the stack or a BSWAP read or
+//              write it: run() stops with RunStatus::WaitingForCode on that
+//              instruction, and runs it once the bytes are there. A program
+//              that never gets ahead of the loader never waits, and the time
+//              to its first instruction is the time to read one chunk,
+//              whatever the size of the image.
+//
+//              Once the stream ends the range is lifted, breakLine is set
+//              like loadProgram does, and the image is verified for the IP
+//              and SP the VM had when loading started. (The verified
+//              handlers only take over at that entry, so a program already
+//              running carries on in the checked interpreter.)
+//
+//              If the image size is known (a length prefix, a file) pass
+//              it in: with an unknown size everything above the loaded bytes
+//              is pending until the end of the stream, the stack at the top
+//              of memory included. Memory above the image is left as it is.
+//
+//     vm.cpu.r.ip = entry;
+//     StreamLoader loader(vm);
+//     RunStatus status = loader.run(fd);   // Reads fd as needed; Halted, Trapped, ...
+// ===========================================================================
+
+class StreamLoader {
+public:
+    static constexpr size_t CHUNK = 4096;       // Most bytes one pull() reads
+    static constexpr uint64_t SLICE = 65536;    // Instructions run() lets pass between reads while loading
+    static constexpr size_t MAX_IMAGE = Memory::SIZE - 1;   // Same limit as loadProgram (breakLine is 16-bit)
+
+    // Starts loading into 'vm' (its IP and SP are the entry). 'imageSize'
+    // is 0 when unknown.
+    explicit StreamLoader(VM& vm, size_t imageSize = 0);
+
+    // Push side: copies the next 'size' bytes of the image. false if they
+    // don't fit (past the image size given, or past MAX_IMAGE).
+    bool append(const uint8_t* data, size_t size);
+
+    // The image is complete: lifts the pending range and verifies it.
+    // The loader is done with the VM afterwards.
+    void finish();
+
+    // Pull side: reads at most CHUNK bytes of the image from 'fd' straight
+    // into memory, calling finish() at the end of the stream. With 'wait'
+    // false it only reads what is there already. Returns the bytes read
+    // (0 at the end, or if nothing was ready), or -1 on a read error or an
+    // image that doesn't fit (see error()).
+    ssize_t pull(int fd, bool wait);
+
+    // Runs the program like vm.run(budget) while reading the rest of it
+    // from 'fd': a WaitingForCode stop waits for the next chunk, and every
+    // SLICE instructions whatever arrived meanwhile is taken in. Returns
+    // the same statuses as VM::run apart from WaitingForCode; a failed
+    // read stops it with RunStatus::Trapped (Trap::MemoryFault, the
+    // message in vm.trapMessage).
+    RunStatus run(int fd, uint64_t budget = VM::UNLIMITED);
+
+    size_t loaded() const { return loadedBytes; }
+    bool complete() const { return done; }
+    const std::string& error() const { return errorMessage; }
+
+    uint64_t stalls = 0;   // Times run() had to wait for code to arrive
+
+private:
+    VM& vm;
+    size_t limit;                // Image size given, or MAX_IMAGE
+    size_t loadedBytes = 0;
+    uint16_t entryIp, entrySp;   // What the image is verified for
+    bool done = false;
+    std::string errorMessage;
+
+    bool overflow();             // Sets the error for bytes past 'limit'; false
+};
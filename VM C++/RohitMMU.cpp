@@ -0,0 +1,280 @@
+// RohitMMU.cpp
+// This file implements the paged memory backend.
+// Only the TLB-miss paths live here: page table walks, page allocation,
+// permission checks and TLB refills. Also builds shared code segments.
+
+#include "RohitMMU.hpp"
+#include "RohitVerifier.hpp" // Verifier (CodeSegment::create)
+#include <algorithm>     // For std::min
+#include <new>           // For std::bad_alloc
+#include <stdexcept>     // For std::length_error / std::invalid_argument
+
+namespace {
+    // Shared by every untouched page of every PagedMemory: reads only
+    alignas(64) const uint8_t zeroPage[PagedMemory::PAGE_SIZE] = {};
+}
+
+// ---------------------------------------------------------------------------
+// Function: CodeSegment::create
+// Purpose: Encodes (and for 16-bit programs verifies) a program once
+template <typename Word>
+std::shared_ptr<const CodeSegment> CodeSegment::create(const std::vector<BasicInstruction<Word>>& program,
+                                                       uint16_t entrySp) {
+    auto seg = std::make_shared<CodeSegment>();
+    seg->image = BasicVM<Word>::encode(program);
+    seg->codeSize = seg->image.size();
+    seg->word = sizeof(Word);
+    if (seg->codeSize > size_t(static_cast<Word>(~Word(0))))
+        throw std::length_error("Program does not fit in the address space");
+
+    seg->image.resize((seg->codeSize + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1), 0);
+
+    if constexpr (std::is_same_v<Word, uint16_t>)
+        seg->proof = Verifier::verify(seg->image.data(), static_cast<uint16_t>(seg->codeSize), 0, entrySp);
+    else
+        (void)entrySp;
+    return seg;
+}
+
+template std::shared_ptr<const CodeSegment> CodeSegment::create(const std::vector<BasicInstruction<uint16_t>>&, uint16_t);
+template std::shared_ptr<const CodeSegment> CodeSegment::create(const std::vector<BasicInstruction<uint32_t>>&, uint16_t);
+
+// ---------------------------------------------------------------------------
+// Function: PagedMemory::PagedMemory
+PagedMemory::PagedMemory(size_t requested) {
+    if (requested == 0 || requested > MAX_SIZE) throw std::bad_alloc();
+    bytes = (requested + PAGE_SIZE - 1) & ~size_t(PAGE_SIZE - 1);
+
+    // Small memories get one small table instead of a full 1024-entry one
+    size_t pages = bytes >> PAGE_BITS;
+    tableSize = std::min<size_t>(pages, 1u << L2_BITS);
+    directory.resize((pages + (1u << L2_BITS) - 1) >> L2_BITS);
+}
+
+// ---------------------------------------------------------------------------
+// Function: PagedMemory::~PagedMemory
+PagedMemory::~PagedMemory() {
+    for (auto& table : directory) {
+        if (!table) continue;
+        for (size_t i = 0; i < tableSize; ++i)
+            if (!table[i].shared) delete[] table[i].data;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Function: find / entry
+// Purpose: Page table walk (directory -> second-level table -> page)
+const PagedMemory::PageEntry* PagedMemory::find(uint32_t page) const {
+    const auto& table = directory[page >> L2_BITS];
+    return table ? &table[page & ((1u << L2_BITS) - 1)] : nullptr;
+}
+
+PagedMemory::PageEntry& PagedMemory::entry(uint32_t page) {
+    auto& table = directory[page >> L2_BITS];
+    if (!table) table.reset(new PageEntry[tableSize]());
+    return table[page & ((1u << L2_BITS) - 1)];
+}
+
+// ---------------------------------------------------------------------------
+// Function: commit
+// Purpose: Gives a page its own storage the first time it's written:
+// zeroed for an untouched page, a copy for a shared one
+uint8_t* PagedMemory::commit(uint32_t page, PageEntry& e) {
+    if (e.data && !e.shared) return e.data;
+
+    uint8_t* data = new uint8_t[PAGE_SIZE];
+    if (e.data) {
+        RohitUtils::copy(data, e.data, PAGE_SIZE);
+        shared--;
+    } else {
+        RohitUtils::zero(data, PAGE_SIZE);
+    }
+    e.data = data;
+    e.shared = false;
+    committed++;
+    flush(page);   // Read/fetch TLBs may still point at the zero page or the shared copy
+    return data;
+}
+
+// ---------------------------------------------------------------------------
+// Function: flush
+// Purpose: Forgets any cached translation of 'page'
+void PagedMemory::flush(uint32_t page) {
+    size_t slot = page & (TLB_ENTRIES - 1);
+    if (readTlb[slot].page == page) readTlb[slot] = ReadEntry();
+    if (fetchTlb[slot].page == page) fetchTlb[slot] = ReadEntry();
+    if (writeTlb[slot].page == page) writeTlb[slot] = WriteEntry();
+}
+
+// ---------------------------------------------------------------------------
+// Function: fault
+// Purpose: Stops the guest instruction (caught by VM::run)
+void PagedMemory::fault(const char* msg) {
+    throw TrapError(Trap::MemoryFault, msg);
+}
+
+// ---------------------------------------------------------------------------
+// Function: loadSlow / fetchSlow / storeSlow
+// Purpose: TLB miss: check bounds and permissions, then refill the TLB.
+// Untouched pages are mapped to the zero page for reads and fetches; the
+// write TLB only ever holds pages with their own storage.
+uint8_t PagedMemory::loadSlow(uint32_t addr) {
+    if (addr >= bytes) fault("Memory access out of range");
+    uint32_t page = addr >> PAGE_BITS;
+    const PageEntry* e = find(page);
+    if (e && !(e->permissions & Read)) fault("Read protection fault");
+
+    ReadEntry& slot = readTlb[page & (TLB_ENTRIES - 1)];
+    slot.page = page;
+    slot.data = (e && e->data) ? e->data : zeroPage;
+    return slot.data[addr & (PAGE_SIZE - 1)];
+}
+
+uint8_t PagedMemory::fetchSlow(uint32_t addr) {
+    if (addr >= bytes) fault("Memory access out of range");
+    uint32_t page = addr >> PAGE_BITS;
+    const PageEntry* e = find(page);
+    if (e && !(e->permissions & Exec)) fault("Execute protection fault");
+
+    ReadEntry& slot = fetchTlb[page & (TLB_ENTRIES - 1)];
+    slot.page = page;
+    slot.data = (e && e->data) ? e->data : zeroPage;
+    return slot.data[addr & (PAGE_SIZE - 1)];
+}
+
+void PagedMemory::storeSlow(uint32_t addr, uint8_t val) {
+    if (addr >= bytes) fault("Memory access out of range");
+    uint32_t page = addr >> PAGE_BITS;
+    PageEntry& e = entry(page);
+    if (!(e.permissions & Write)) fault("Write protection fault");
+
+    uint8_t* data = commit(page, e);
+
+    // Watched pages stay out of the write TLB so every store comes back here
+    if (e.watched) {
+        uint8_t& byte = data[addr & (PAGE_SIZE - 1)];
+        uint8_t old = byte;
+        byte = val;
+        for (const Watch& w : watches) {
+            if (addr - w.addr < w.len) {
+                if (onWatch) onWatch(addr, old, val);
+                break;
+            }
+        }
+        return;
+    }
+
+    WriteEntry& slot = writeTlb[page & (TLB_ENTRIES - 1)];
+    slot.page = page;
+    slot.data = data;
+    data[addr & (PAGE_SIZE - 1)] = val;
+}
+
+// ---------------------------------------------------------------------------
+// Function: peek / poke
+// Purpose: Host-side access for loaders, debuggers and profilers
+uint8_t PagedMemory::peek(uint32_t addr) const {
+    if (addr >= bytes) return 0;
+    const PageEntry* e = find(addr >> PAGE_BITS);
+    return (e && e->data) ? e->data[addr & (PAGE_SIZE - 1)] : 0;
+}
+
+void PagedMemory::poke(uint32_t addr, uint8_t val) {
+    if (addr >= bytes) fault("Memory access out of range");
+    uint32_t page = addr >> PAGE_BITS;
+    commit(page, entry(page))[addr & (PAGE_SIZE - 1)] = val;
+}
+
+// ---------------------------------------------------------------------------
+// Function: mapShared
+// Purpose: Points pages at a code segment instead of private storage
+void PagedMemory::mapShared(uint32_t addr, std::shared_ptr<const CodeSegment> code) {
+    if (addr & (PAGE_SIZE - 1)) throw std::invalid_argument("Shared mappings must be page aligned");
+    if (size_t(addr) + code->pages() * PAGE_SIZE > bytes) fault("Memory access out of range");
+
+    for (size_t i = 0; i < code->pages(); ++i) {
+        uint32_t page = (addr >> PAGE_BITS) + static_cast<uint32_t>(i);
+        PageEntry& e = entry(page);
+        if (e.shared) {
+            shared--;
+        } else if (e.data) {
+            delete[] e.data;
+            committed--;
+        }
+        e.data = const_cast<uint8_t*>(code->data() + i * PAGE_SIZE); // Never written: see commit()
+        e.shared = true;
+        e.permissions = Read | Exec;
+        shared++;
+        flush(page);
+    }
+    segments.push_back(std::move(code));
+}
+
+// ---------------------------------------------------------------------------
+// Function: watch / unwatch / clearWatches / markWatched
+// Purpose: Write watchpoints. Only the page flags and the write TLB are
+// touched here; the range checks happen in storeSlow.
+void PagedMemory::watch(uint32_t addr, size_t len) {
+    if (len == 0) return;
+    watches.push_back({addr, len});
+    markWatched(addr, len);
+}
+
+void PagedMemory::unwatch(uint32_t addr, size_t len) {
+    size_t before = watches.size();
+    for (size_t i = watches.size(); i-- > 0;) {
+        if (watches[i].addr == addr && watches[i].len == len) watches.erase(watches.begin() + i);
+    }
+    if (watches.size() != before) markWatched(addr, len);
+}
+
+void PagedMemory::clearWatches() {
+    std::vector<Watch> old;
+    old.swap(watches);
+    for (const Watch& w : old) markWatched(w.addr, w.len);
+}
+
+void PagedMemory::markWatched(uint32_t addr, size_t len) {
+    size_t end = size_t(addr) + len;
+    if (end > bytes) end = bytes;
+    for (size_t a = addr & ~size_t(PAGE_SIZE - 1); a < end; a += PAGE_SIZE) {
+        uint32_t page = static_cast<uint32_t>(a >> PAGE_BITS);
+        bool watched = false;
+        for (const Watch& w : watches) {
+            if (w.addr < a + PAGE_SIZE && a < size_t(w.addr) + w.len) { watched = true; break; }
+        }
+        entry(page).watched = watched;
+        flush(page);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Function: protect
+// Purpose: Changes page permissions and drops the affected translations
+void PagedMemory::protect(uint32_t addr, size_t len, uint8_t permissions) {
+    if (len == 0) return;
+    size_t end = size_t(addr) + len;
+    if (end > bytes) end = bytes;
+    for (size_t a = addr & ~size_t(PAGE_SIZE - 1); a < end; a += PAGE_SIZE) {
+        uint32_t page = static_cast<uint32_t>(a >> PAGE_BITS);
+        entry(page).permissions = permissions & All;
+        flush(page);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Function: permissions / allows
+uint8_t PagedMemory::permissions(uint32_t addr) const {
+    if (addr >= bytes) return None;
+    const PageEntry* e = find(addr >> PAGE_BITS);
+    return e ? e->permissions : static_cast<uint8_t>(All);
+}
+
+bool PagedMemory::allows(uint32_t addr, size_t len, uint8_t perms) const {
+    size_t end = size_t(addr) + len;
+    if (end > bytes) return false;
+    for (size_t a = addr & ~size_t(PAGE_SIZE - 1); a < end; a += PAGE_SIZE) {
+        if ((permissions(static_cast<uint32_t>(a)) & perms) != perms) return false;
+    }
+    return true;
+}
@@ -0,0 +1,202 @@
+// RohitMMU.hpp
+#pragma once  // Ensures this header is only included once during compilation
+
+#include <cstdint>      // For fixed-width integer types like uint32_t
+#include <functional>   // For the watchpoint hook
+#include <memory>       // For std::unique_ptr / std::shared_ptr
+#include <vector>       // For the page directory
+
+#include "RohitVM.hpp"  // BasicVM, Memory, Trap
+
+// ===========================================================================
+// Author: Rohit Yadav
+// Description: Paged memory backend (software MMU) for RohitVM.
+//              The address space is split into 4 KiB pages that are only
+//              allocated the first time something writes to them. Until
+//              then every read of a page returns bytes from one shared,
+//              read-only zero page, so a VM with a 4 GiB address space pays
+//              only for the pages it actually touches.
+//
+//              Every page also has read/write/execute permissions (all
+//              allowed by default). A load, store or instruction fetch that
+//              breaks them, or that goes past the end of the address space,
+//              stops the program with Trap::MemoryFault.
+//
+//              Translations are cached in three small direct-mapped software
+//              TLBs (read, write, fetch). A TLB hit is one compare and one
+//              indexed access; the page table walk, allocation and
+//              permission checks only happen on a miss.
+//
+//              Pages can also be mapped from a CodeSegment: one immutable,
+//              reference-counted program image (plus its verified, decoded
+//              form) shared by any number of VMs. Only data and stack pages
+//              are private, so 10,000 VMs running the same program keep one
+//              copy of its code and decoded instructions between them.
+//
+//              Write watchpoints use the same machinery: a page holding a
+//              watched range is never put in the write TLB, so every store
+//              to it takes the slow path, which checks the exact ranges and
+//              calls onWatch. Stores to other pages don't change at all,
+//              and with no watchpoints set nothing is checked anywhere.
+
+// ===========================================================================
+// CLASS: CodeSegment
+// A program encoded once, padded to whole pages and never modified again.
+// Share it with std::shared_ptr and map it with VM::loadProgram(segment).
+// ===========================================================================
+
+class CodeSegment {
+public:
+    // Encodes 'program' for address 0. 16-bit programs are also verified for
+    // a VM that starts with IP 0 and SP = entrySp; every VM loading the
+    // segment then shares the result. Throws std::length_error if the
+    // program doesn't fit the word's address space.
+    template <typename Word>
+    static std::shared_ptr<const CodeSegment> create(const std::vector<BasicInstruction<Word>>& program,
+                                                     uint16_t entrySp = Registers().sp);
+
+    const uint8_t* data() const { return image.data(); }   // Padded with zeros to whole pages
+    size_t size() const { return codeSize; }                 // Program bytes (without padding)
+    size_t pages() const { return image.size() / PAGE_SIZE; }
+    size_t wordSize() const { return word; }                 // sizeof(Word) it was encoded for
+    const std::shared_ptr<const VerifiedProgram>& verified() const { return proof; } // nullptr if not verified
+
+private:
+    static constexpr size_t PAGE_SIZE = 4096;                 // Same as PagedMemory::PAGE_SIZE
+
+    std::vector<uint8_t> image;   // Padded to whole pages
+    size_t codeSize = 0;
+    size_t word = 0;
+    std::shared_ptr<const VerifiedProgram> proof;
+};
+
+// ===========================================================================
+// CLASS: PagedMemory
+// Plugs into BasicVM as its memory type (see PagedVM / PagedVM32 below).
+// ===========================================================================
+
+class PagedMemory {
+public:
+    static constexpr uint32_t PAGE_BITS = 12;
+    static constexpr uint32_t PAGE_SIZE = 1u << PAGE_BITS;  // 4 KiB
+    static constexpr size_t MAX_SIZE = size_t(1) << 32;     // Whole 32-bit address space
+    static constexpr size_t TLB_ENTRIES = 64;               // Per TLB (power of two)
+
+    // Page permission bits (combine with |)
+    enum Permission : uint8_t {
+        None = 0,
+        Read = 1,
+        Write = 2,
+        Exec = 4,
+        All = Read | Write | Exec
+    };
+
+    // 'bytes' is rounded up to whole pages. Nothing is allocated up front
+    // except the page directory (one pointer per 4 MiB of address space).
+    explicit PagedMemory(size_t bytes = Memory::SIZE);
+    ~PagedMemory();
+    PagedMemory(const PagedMemory&) = delete;
+    PagedMemory& operator=(const PagedMemory&) = delete;
+
+    // ----------- Guest accesses (permission checked, TLB cached) -----------
+    uint8_t load(uint32_t addr) {
+        const ReadEntry& e = readTlb[(addr >> PAGE_BITS) & (TLB_ENTRIES - 1)];
+        if (e.page == (addr >> PAGE_BITS)) return e.data[addr & (PAGE_SIZE - 1)];
+        return loadSlow(addr);
+    }
+
+    uint8_t fetch(uint32_t addr) {
+        const ReadEntry& e = fetchTlb[(addr >> PAGE_BITS) & (TLB_ENTRIES - 1)];
+        if (e.page == (addr >> PAGE_BITS)) return e.data[addr & (PAGE_SIZE - 1)];
+        return fetchSlow(addr);
+    }
+
+    void store(uint32_t addr, uint8_t val) {
+        const WriteEntry& e = writeTlb[(addr >> PAGE_BITS) & (TLB_ENTRIES - 1)];
+        if (e.page == (addr >> PAGE_BITS)) { e.data[addr & (PAGE_SIZE - 1)] = val; return; }
+        storeSlow(addr, val);
+    }
+
+    // ----------- Host accesses (no permission checks, no TLB) -----------
+    uint8_t peek(uint32_t addr) const;        // 0 for untouched pages and addresses past the end
+    void poke(uint32_t addr, uint8_t val);    // Allocates (or un-shares) the page; traps past the end
+
+    // ----------- Shared pages -----------
+    // Maps 'code' read/execute-only at 'addr' (page aligned), replacing
+    // whatever was there. The pages stay shared until something writes to
+    // them: poke() and guest stores (if protect() grants Write) give this
+    // memory a private copy of the page first, so the segment itself never
+    // changes. Keeps the segment alive as long as this memory exists.
+    void mapShared(uint32_t addr, std::shared_ptr<const CodeSegment> code);
+
+    // ----------- Write watchpoints -----------
+    // Calls onWatch after every guest store into [addr, addr + len). Host
+    // pokes don't trigger it. On the checked interpreter the VM's IP is
+    // already past the storing instruction when the hook runs (like a
+    // hardware watchpoint); the verified handlers keep IP and the other
+    // registers in locals, so reset vm.verified first if the hook needs them.
+    void watch(uint32_t addr, size_t len);
+    void unwatch(uint32_t addr, size_t len); // Removes watchpoints set with exactly this range
+    void clearWatches();
+    std::function<void(uint32_t addr, uint8_t oldValue, uint8_t newValue)> onWatch;
+
+    // ----------- Permissions -----------
+    // Sets the permissions of every page overlapping [addr, addr + len)
+    void protect(uint32_t addr, size_t len, uint8_t permissions);
+    uint8_t permissions(uint32_t addr) const;
+    bool allows(uint32_t addr, size_t len, uint8_t permissions) const; // True if every page has them
+
+    size_t size() const { return bytes; }
+    size_t committedPages() const { return committed; } // Private pages (written, or copied from a shared page)
+    size_t sharedPages() const { return shared; }       // Pages currently mapped from a CodeSegment
+
+private:
+    static constexpr uint32_t L2_BITS = 10;                 // 1024 pages (4 MiB) per table
+    static constexpr uint32_t NO_PAGE = UINT32_MAX;         // Empty TLB slot
+
+    struct PageEntry {
+        uint8_t* data = nullptr;   // nullptr = untouched (reads see the zero page)
+        uint8_t permissions = All;
+        bool shared = false;       // 'data' belongs to a CodeSegment: never written or freed here
+        bool watched = false;      // Overlaps a watchpoint: stores always take the slow path
+    };
+
+    struct Watch { uint32_t addr; size_t len; };
+
+    struct ReadEntry { uint32_t page = NO_PAGE; const uint8_t* data = nullptr; };
+    struct WriteEntry { uint32_t page = NO_PAGE; uint8_t* data = nullptr; };
+
+    size_t bytes = 0;
+    size_t committed = 0;
+    size_t shared = 0;
+    size_t tableSize = 0;  // Entries per second-level table (fewer than 1024 for small memories)
+    std::vector<std::unique_ptr<PageEntry[]>> directory;  // Second-level tables, created on demand
+    std::vector<std::shared_ptr<const CodeSegment>> segments; // Keeps mapped segments alive
+    std::vector<Watch> watches;
+
+    ReadEntry readTlb[TLB_ENTRIES];
+    ReadEntry fetchTlb[TLB_ENTRIES];
+    WriteEntry writeTlb[TLB_ENTRIES];
+
+    uint8_t loadSlow(uint32_t addr);
+    uint8_t fetchSlow(uint32_t addr);
+    void storeSlow(uint32_t addr, uint8_t val);
+
+    const PageEntry* find(uint32_t page) const; // nullptr if the page's table doesn't exist yet
+    PageEntry& entry(uint32_t page);            // Creates the table if needed
+    uint8_t* commit(uint32_t page, PageEntry& e); // Private storage for a page (zeroed, or a copy of the shared one)
+    void flush(uint32_t page);                  // Drops the page from all three TLBs
+    void markWatched(uint32_t addr, size_t len); // Recomputes 'watched' for the pages of a range
+    [[noreturn]] static void fault(const char* msg);
+};
+
+// ===========================================================================
+// The paged machines: same as VM / VM32, but on PagedMemory. The default
+// address space is the whole range the word can address (64 KiB / 4 GiB).
+// ===========================================================================
+
+using PagedVM = BasicVM<uint16_t, PagedMemory>;
+using PagedVM32 = BasicVM<uint32_t, PagedMemory>;
+
+extern template class BasicVM<uint16_t, PagedMemory>;
+extern template class BasicVM<uint32_t, PagedMemory>;
@@ -0,0 +1,428 @@
+// RohitOptimizer.cpp
+// This file implements the peephole / constant-folding optimizer.
+// The optimizer repeats two passes until nothing changes:
+//   1. A forward pass that tracks known register constants and the exact SP,
+//      folds arithmetic on constants into a single MOV, drops MOVs that
+//      don't change anything and collapses PUSH/POP pairs.
+//   2. A backward liveness pass that removes register and flag writes that
+//      are overwritten before anything reads them.
+
+#include "RohitOptimizer.hpp"
+#include <unordered_map>  // Instruction address -> index
+
+namespace {
+
+    // -------------------------------
+    // Liveness bits: one per register/flag whose final value we must keep
+    enum : uint16_t {
+        L_AX = 0x001, L_BX = 0x002, L_CX = 0x004, L_DX = 0x008, L_SP = 0x010,
+        L_E  = 0x020, L_G  = 0x040, L_H  = 0x080, L_L  = 0x100,
+        L_FLAGS = 0x1E0, L_ALL = 0x1FF
+    };
+
+    const uint16_t regBit[4] = {L_AX, L_BX, L_CX, L_DX};
+
+    // -------------------------------
+    // Function: movTarget
+    // Purpose: Returns the register index (0-3 = AX-DX, 4 = SP) written by a MOV opcode, or -1
+    int movTarget(Opcode op) {
+        switch (op) {
+            case Opcode::MOV:    return 0;
+            case Opcode::MOV_BX: return 1;
+            case Opcode::MOV_CX: return 2;
+            case Opcode::MOV_DX: return 3;
+            case Opcode::MOV_SP: return 4;
+            default:             return -1;
+        }
+    }
+
+    // -------------------------------
+    // Function: movOpcode
+    // Purpose: The MOV opcode that loads an immediate into register index r (0-3)
+    Opcode movOpcode(int r) {
+        static const Opcode ops[4] = {Opcode::MOV, Opcode::MOV_BX, Opcode::MOV_CX, Opcode::MOV_DX};
+        return ops[r];
+    }
+
+    // -------------------------------
+    // Function: flagBit
+    // Purpose: The liveness bit written by a flag set/clear opcode, or 0
+    uint16_t flagBit(Opcode op) {
+        switch (op) {
+            case Opcode::STE: case Opcode::CLE: return L_E;
+            case Opcode::STG: case Opcode::CLG: return L_G;
+            case Opcode::STH: case Opcode::CLH: return L_H;
+            case Opcode::STL: case Opcode::CLL: return L_L;
+            default:                            return 0;
+        }
+    }
+
+    // -------------------------------
+    // Function: hasTarget
+    // Purpose: True for the instructions whose operand is a code address
+    bool hasTarget(Opcode op) {
+        return op == Opcode::JMP || op == Opcode::CALL || op == Opcode::JE ||
+               op == Opcode::JNE || op == Opcode::JG || op == Opcode::JL;
+    }
+
+    // -------------------------------
+    // Function: setsFlags
+    // Purpose: True for the instructions that define all four flags
+    bool setsFlags(Opcode op) {
+        return op == Opcode::ADD || op == Opcode::SUB || op == Opcode::MUL ||
+               op == Opcode::CMP || op == Opcode::POPF;
+    }
+
+    // -------------------------------
+    // Struct: ConstState
+    // Known constants before an instruction runs.
+    struct ConstState {
+        uint8_t known = 0;     // Bit i set => reg[i] (AX-DX) is known
+        uint16_t reg[4] = {};
+        bool spKnown = false;
+        uint16_t sp = 0;
+
+        bool isKnown(int r) const { return known & (1 << r); }
+        void set(int r, uint16_t v) { known |= (1 << r); reg[r] = v; }
+        void forget(int r) { known &= ~(1 << r); }
+    };
+
+    // -------------------------------
+    // Function: mayFail
+    // Purpose: True if the instruction could stop the VM with an error given
+    // what we know before it. Such instructions act as barriers: everything
+    // is considered live there, because the state at the error must not change.
+    bool mayFail(const Instruction& in, const ConstState& s) {
+        switch (in.op) {
+            case Opcode::PUSH: return in.a1 > 3 || !s.spKnown || s.sp < 2;
+            case Opcode::POP:  return in.a1 > 3 || !s.spKnown || s.sp > 0xFFFE;
+            case Opcode::PUSHF: return !s.spKnown || s.sp < 2;
+            case Opcode::POPF:  return !s.spKnown || s.sp > 0xFFFE;
+            case Opcode::DIV:  return !s.isKnown(1) || s.reg[1] == 0;
+            case Opcode::CALL: return !s.spKnown || s.sp < 2;
+            case Opcode::RET:  return !s.spKnown || s.sp > 0xFFFE;
+            case Opcode::IN:   return true;  // The host sees the state and IN may suspend
+            case Opcode::OUT:  return true;
+            case Opcode::BSWAP16: case Opcode::BSWAP32: case Opcode::BSWAP64:
+                return true;                 // Bounds depend on CX/DX (and it reads them)
+            case Opcode::BRK:  return true;  // A debugger looks at the state there
+            default:           return VM::getInstructionSize(in.op) == 0;
+        }
+    }
+
+    // -------------------------------
+    // Function: step
+    // Purpose: Applies one instruction to the known-constant state
+    void step(const Instruction& in, ConstState& s) {
+        int r = movTarget(in.op);
+        if (r >= 0 && r < 4) { s.set(r, in.a1); return; }
+        if (r == 4) { s.spKnown = true; s.sp = in.a1; return; }
+
+        bool both = s.isKnown(0) && s.isKnown(1);
+        uint16_t a = s.reg[0], b = s.reg[1];
+        switch (in.op) {
+            case Opcode::ADD: if (both) s.set(0, a + b); else s.forget(0); break;
+            case Opcode::SUB: if (both) s.set(0, a - b); else s.forget(0); break;
+            case Opcode::MUL: if (both) s.set(0, a * b); else s.forget(0); break;
+            case Opcode::DIV: if (both && b != 0) s.set(0, a / b); else s.forget(0); break;
+            case Opcode::PUSH:
+            case Opcode::PUSHF:
+                if (s.spKnown && s.sp >= 2) s.sp -= 2; else s.spKnown = false;
+                break;
+            case Opcode::POP:
+                if (in.a1 <= 3) s.forget(in.a1);
+                [[fallthrough]];
+            case Opcode::POPF:
+                if (s.spKnown && s.sp <= 0xFFFE) s.sp += 2; else s.spKnown = false;
+                break;
+            case Opcode::IN:
+                if (in.a1 <= 3) s.forget(in.a1);
+                break;
+            default: break;
+        }
+    }
+
+    // -------------------------------
+    // Function: barriers
+    // Purpose: Which instructions of a block might fail (they must see the exact state)
+    std::vector<bool> barriers(const std::vector<Instruction>& prog, const ConstState& entry) {
+        std::vector<bool> barrier(prog.size());
+        ConstState s = entry;
+        for (size_t i = 0; i < prog.size(); ++i) {
+            barrier[i] = mayFail(prog[i], s);
+            step(prog[i], s);
+        }
+        return barrier;
+    }
+
+    // -------------------------------
+    // Function: flagsLiveAfter
+    // Purpose: For each instruction, whether anything may still read the
+    // flags it leaves behind: a conditional jump, PUSHF, a flag set/clear
+    // (it keeps the other three bits), a barrier or the end of the block.
+    std::vector<bool> flagsLiveAfter(const std::vector<Instruction>& prog, const ConstState& entry) {
+        std::vector<bool> barrier = barriers(prog, entry);
+        std::vector<bool> after(prog.size());
+        bool live = true;
+        for (size_t i = prog.size(); i-- > 0;) {
+            after[i] = live;
+            Opcode op = prog[i].op;
+            if (barrier[i] || hasTarget(op) || op == Opcode::RET || op == Opcode::HLT ||
+                op == Opcode::PUSHF || flagBit(op))
+                live = true;
+            else if (setsFlags(op))
+                live = false;
+        }
+        return after;
+    }
+
+    // -------------------------------
+    // Function: forwardPass
+    // Purpose: Constant folding, redundant MOV removal and PUSH/POP pair removal.
+    // Returns true if the program changed.
+    bool forwardPass(std::vector<Instruction>& prog, const ConstState& entry,
+                     uint32_t codeBytes, bool allowPairs, OptimizerStats& st) {
+        const size_t end = prog.size();
+        std::vector<Instruction> out;
+        out.reserve(prog.size());
+        ConstState s = entry;
+        bool changed = false;
+
+        // A PUSH/POP pair leaves its value just below SP. Only a later MOV SP
+        // can expose those bytes again (pushes overwrite them first), so pairs
+        // are only removed after the last MOV SP of the block.
+        size_t lastMovSp = 0;
+        for (size_t i = 0; i < end; ++i)
+            if (prog[i].op == Opcode::MOV_SP) lastMovSp = i + 1;
+
+        // Folding ADD/SUB/MUL into a MOV loses the flags they set
+        std::vector<bool> flagsLive = flagsLiveAfter(prog, entry);
+
+        for (size_t i = 0; i < end; ++i) {
+            Instruction in = prog[i];
+            int r = movTarget(in.op);
+
+            if (in.op == Opcode::NOP) { st.nopsRemoved++; changed = true; continue; }
+
+            // MOV of the value the register already holds
+            if ((r >= 0 && r < 4 && s.isKnown(r) && s.reg[r] == in.a1) ||
+                (r == 4 && s.spKnown && s.sp == in.a1)) {
+                st.deadStores++;
+                changed = true;
+                continue;
+            }
+
+            // Arithmetic on two known constants becomes MOV AX, result
+            // (unless something reads the flags it sets)
+            bool arith = in.op == Opcode::DIV ||
+                         ((in.op == Opcode::ADD || in.op == Opcode::SUB || in.op == Opcode::MUL) && !flagsLive[i]);
+            if (arith && s.isKnown(0) && s.isKnown(1) && !mayFail(in, s)) {
+                step(in, s);
+                out.push_back({Opcode::MOV, s.reg[0]});
+                st.folded++;
+                changed = true;
+                continue;
+            }
+
+            // PUSH r1; POP r2 where the push can't fail or touch the program
+            if (allowPairs && in.op == Opcode::PUSH && i + 1 < end && prog[i + 1].op == Opcode::POP &&
+                i >= lastMovSp && !mayFail(in, s) && prog[i + 1].a1 <= 3 &&
+                static_cast<uint32_t>(s.sp - 2) >= codeBytes) {
+                int from = in.a1, to = prog[i + 1].a1;
+                if (from == to) {
+                    st.pairsRemoved++;
+                    changed = true;
+                    ++i;
+                    continue;
+                }
+                if (s.isKnown(from)) {
+                    Instruction mov{movOpcode(to), s.reg[from]};
+                    step(mov, s);
+                    out.push_back(mov);
+                    st.pairsRemoved++;
+                    changed = true;
+                    ++i;
+                    continue;
+                }
+            }
+
+            step(in, s);
+            out.push_back(in);
+        }
+
+        prog.swap(out);
+        return changed;
+    }
+
+    // -------------------------------
+    // Function: deadStorePass
+    // Purpose: Backward liveness; removes writes nobody reads before they're overwritten.
+    // Returns true if the program changed.
+    bool deadStorePass(std::vector<Instruction>& prog, const ConstState& entry,
+                       OptimizerStats& st) {
+        const size_t end = prog.size();
+
+        // Forward: which instructions might fail (they must see the exact state)
+        std::vector<bool> barrier = barriers(prog, entry);
+
+        // Backward: everything is live at the end of the block (final state or
+        // unknown successor), at HLT and at control transfers
+        std::vector<bool> keep(end, true);
+        uint16_t live = L_ALL;
+        bool changed = false;
+        for (size_t i = end; i-- > 0;) {
+            const Instruction& in = prog[i];
+            int r = movTarget(in.op);
+            uint16_t fb = flagBit(in.op);
+
+            if (in.op == Opcode::HLT || hasTarget(in.op) || in.op == Opcode::RET || barrier[i]) {
+                live = L_ALL;
+            } else if (r >= 0) {
+                uint16_t bit = (r == 4) ? static_cast<uint16_t>(L_SP) : regBit[r];
+                if (!(live & bit)) { keep[i] = false; continue; }
+                live &= ~bit;
+            } else if (fb) {
+                if (!(live & fb)) { keep[i] = false; continue; }
+                live &= ~fb;
+            } else if (in.op == Opcode::ADD || in.op == Opcode::SUB || in.op == Opcode::MUL) {
+                if (!(live & (L_AX | L_FLAGS))) { keep[i] = false; continue; }
+                live = (live & ~L_FLAGS) | L_AX | L_BX;
+            } else if (in.op == Opcode::DIV) {
+                if (!(live & L_AX)) { keep[i] = false; continue; }
+                live |= L_AX | L_BX;
+            } else if (in.op == Opcode::CMP) {
+                if (!(live & L_FLAGS)) { keep[i] = false; continue; }
+                live = (live & ~L_FLAGS) | L_AX | L_BX;
+            } else if (in.op == Opcode::PUSH) {
+                live |= regBit[in.a1] | L_SP;
+            } else if (in.op == Opcode::POP) {
+                live = (live & ~regBit[in.a1]) | L_SP;
+            } else if (in.op == Opcode::PUSHF) {
+                live |= L_FLAGS | L_SP;
+            } else if (in.op == Opcode::POPF) {
+                live = (live & ~L_FLAGS) | L_SP;
+            }
+        }
+
+        std::vector<Instruction> out;
+        out.reserve(prog.size());
+        for (size_t i = 0; i < end; ++i) {
+            if (!keep[i]) { st.deadStores++; changed = true; continue; }
+            out.push_back(prog[i]);
+        }
+        prog.swap(out);
+        return changed;
+    }
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Function: Optimizer::optimize
+// Purpose: Splits the program into basic blocks, runs the passes on each
+// block until it stops shrinking, then re-targets jump/call operands to the
+// new instruction addresses. Code up to the last CALL's return point keeps
+// its addresses, so return addresses on the stack don't change.
+std::vector<Instruction> Optimizer::optimize(const std::vector<Instruction>& program,
+                                             uint16_t entrySp, OptimizerStats* stats) {
+    OptimizerStats st;
+    st.before = program.size();
+    const size_t n = program.size();
+
+    // Byte address of every instruction (addr[n] = size of the encoded program)
+    std::vector<uint32_t> addr(n + 1, 0);
+    for (size_t i = 0; i < n; ++i) addr[i + 1] = addr[i] + VM::getInstructionSize(program[i].op);
+    const uint32_t codeBytes = addr[n]; // Pushes below this address would overwrite code
+
+    std::unordered_map<uint32_t, size_t> indexAt;
+    for (size_t i = 0; i < n; ++i) indexAt[addr[i]] = i;
+
+    // ----------- Basic blocks -----------
+    // A block starts at the entry, at every jump/call target and after every
+    // instruction that doesn't simply fall through.
+    std::vector<bool> leader(n + 1, false);
+    leader[0] = true;
+    bool controlFlow = false, hasMovSp = false, entryIsTarget = false;
+    for (size_t i = 0; i < n; ++i) {
+        Opcode op = program[i].op;
+        if (op == Opcode::MOV_SP) hasMovSp = true;
+        if (hasTarget(op)) {
+            auto it = indexAt.find(program[i].a1);
+            if (it == indexAt.end()) {
+                // Jumps into the middle of an instruction: leave the program alone
+                st.after = n;
+                if (stats) *stats = st;
+                return program;
+            }
+            leader[it->second] = true;
+            if (it->second == 0) entryIsTarget = true;
+        }
+        if (hasTarget(op) || op == Opcode::RET) controlFlow = true;
+        if (hasTarget(op) || op == Opcode::RET || op == Opcode::HLT)
+            leader[i + 1] = true;
+    }
+
+    // With loops a MOV SP anywhere may run after a PUSH/POP pair, so pairs are
+    // only collapsed if that can't happen.
+    const bool allowPairs = !(controlFlow && hasMovSp);
+
+    // CALL pushes its return address, which stays on the live stack if the
+    // program halts inside the call. Every instruction up to the last return
+    // point therefore keeps its address: those blocks are padded back to
+    // their old size with NOPs (or kept as they were if they grew).
+    uint32_t fixedUpTo = 0;
+    for (size_t i = 0; i < n; ++i)
+        if (program[i].op == Opcode::CALL) fixedUpTo = addr[i + 1];
+
+    // ----------- Optimize each block on its own -----------
+    std::vector<Instruction> out;
+    std::vector<size_t> newIndex(n + 1, 0); // Old leader index -> index in 'out'
+    for (size_t b = 0; b < n;) {
+        size_t e = b + 1;
+        while (e < n && !leader[e]) ++e;
+
+        // Only the entry block (if nothing jumps to it) starts with a known SP
+        ConstState entry;
+        if (b == 0 && !entryIsTarget) {
+            entry.spKnown = true;
+            entry.sp = entrySp;
+        }
+
+        std::vector<Instruction> block(program.begin() + b, program.begin() + e);
+        bool changed = true;
+        while (changed) {
+            changed = forwardPass(block, entry, codeBytes, allowPairs, st);
+            changed |= deadStorePass(block, entry, st);
+        }
+
+        if (addr[e] <= fixedUpTo) {
+            uint32_t bytes = 0;
+            for (const auto& in : block) bytes += VM::getInstructionSize(in.op);
+            if (bytes > addr[e] - addr[b]) {
+                block.assign(program.begin() + b, program.begin() + e);
+            } else if (bytes < addr[e] - addr[b]) {
+                // Before the jump/call/RET/HLT ending the block, so it stays at the end
+                Opcode last = block.empty() ? Opcode::NOP : block.back().op;
+                bool ends = hasTarget(last) || last == Opcode::RET || last == Opcode::HLT;
+                block.insert(ends ? block.end() - 1 : block.end(), addr[e] - addr[b] - bytes, Instruction{Opcode::NOP});
+            }
+        }
+
+        newIndex[b] = out.size();
+        for (const auto& in : block) out.push_back(in);
+        b = e;
+    }
+    newIndex[n] = out.size();
+
+    // ----------- Re-target jumps and calls -----------
+    std::vector<uint32_t> newAddr(out.size() + 1, 0);
+    for (size_t i = 0; i < out.size(); ++i) newAddr[i + 1] = newAddr[i] + VM::getInstructionSize(out[i].op);
+    for (auto& in : out) {
+        if (!hasTarget(in.op)) continue;
+        // Control flow instructions are never rewritten, so a1 is still the old address
+        in.a1 = static_cast<uint16_t>(newAddr[newIndex[indexAt[in.a1]]]);
+    }
+
+    st.after = out.size();
+    if (stats) *stats = st;
+    return out;
+}
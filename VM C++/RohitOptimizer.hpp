@@ -0,0 +1,60 @@
+// RohitOptimizer.hpp
+#pragma once  // Ensures this header is only included once during compilation
+
+#include <cstdint>      // For fixed-width integer types like uint16_t
+#include <vector>       // Programs are std::vector<Instruction>
+
+#include "RohitVM.hpp"  // Opcode, Instruction, Registers
+
+// ===========================================================================
+// Author: Rohit Yadav
+// Description: Peephole / constant-folding optimizer for RohitVM programs.
+//              It runs on the std::vector<Instruction> before VM::loadProgram
+//              and removes work that can't change the result:
+//                - constant propagation and folding through ADD/SUB/MUL/DIV
+//                  (ADD/SUB/MUL only where nothing reads the flags they set)
+//                - dead-store elimination for registers (MOV overwritten before use)
+//                - redundant flag set/clear pairs (STE ... CLE with no reader)
+//                - PUSH r; POP r pairs and NOPs
+//              Final registers, flags, SP and the live stack (everything at or
+//              above SP) are preserved, and so is every runtime error: an
+//              instruction that might fail is never removed or moved across.
+//              Bytes left below SP by a removed PUSH/POP pair are not part of
+//              that guarantee.
+//              Each basic block is optimized on its own and jump/call operands
+//              are re-targeted afterwards. Return addresses are data on the
+//              stack, so code up to the last CALL's return point keeps its
+//              addresses: blocks there are padded back to their old size
+//              with NOPs (a block that would grow is left as it was); only
+//              code after it is compacted. Programs that push code addresses
+//              of their own (for RET) or that overwrite their own code must
+//              not be optimized: only JMP/CALL and conditional jump operands
+//              are relocated.
+
+// ===========================================================================
+// STRUCT: OptimizerStats
+// What the optimizer did (useful for reports and for tuning code generators).
+// ===========================================================================
+
+struct OptimizerStats {
+    size_t before = 0;        // Instructions in the input program
+    size_t after = 0;         // Instructions in the optimized program
+    size_t folded = 0;        // Arithmetic replaced by a MOV of the constant result
+    size_t deadStores = 0;    // Register/flag writes removed because nothing read them
+    size_t pairsRemoved = 0;  // PUSH/POP pairs removed or turned into a MOV
+    size_t nopsRemoved = 0;   // NOPs dropped
+};
+
+// ===========================================================================
+// CLASS: Optimizer
+// ===========================================================================
+
+class Optimizer {
+public:
+    // Optimizes a program loaded at address 0. entrySp is the SP the program
+    // will start with (the VM default unless the host changes it); general
+    // purpose registers are assumed unknown at entry.
+    static std::vector<Instruction> optimize(const std::vector<Instruction>& program,
+                                             uint16_t entrySp = Registers().sp,
+                                             OptimizerStats* stats = nullptr);
+};
@@ -0,0 +1,146 @@
+// RohitPerf.cpp
+// This file implements the perf_event_open based counter layer.
+// Each counter is opened on its own (not as a group) so that a host which
+// doesn't expose, say, L1d events still reports cycles and branch misses.
+
+#include "RohitPerf.hpp"
+#include <cstdio>        // For snprintf
+
+#ifdef __linux__
+#include <linux/perf_event.h> // perf_event_attr and PERF_* constants
+#include <sys/ioctl.h>        // ioctl (enable/disable/reset)
+#include <sys/syscall.h>      // SYS_perf_event_open (no glibc wrapper exists)
+#include <unistd.h>           // read, close, syscall
+#endif
+
+namespace {
+
+#ifdef __linux__
+    // -------------------------------
+    // Function: openCounter
+    // Purpose: Opens one disabled, user-space-only counter for the calling thread
+    int openCounter(uint32_t type, uint64_t config) {
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1; // Only the interpreter, and allowed at paranoid level 2
+        attr.exclude_hv = 1;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0 /* this thread */,
+                                        -1 /* any CPU */, -1 /* no group */, 0));
+    }
+#endif
+
+    const char* counterName[PerfReport::Count] = {
+        "cycles", "instructions", "branch-misses", "L1d-misses"
+    };
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Function: PerfReport::perGuestInstruction
+double PerfReport::perGuestInstruction(Counter c) const {
+    if (!valid[c] || guestInstructions == 0) return 0.0;
+    return static_cast<double>(value[c]) / static_cast<double>(guestInstructions);
+}
+
+// ---------------------------------------------------------------------------
+// Function: PerfReport::toString
+std::string PerfReport::toString() const {
+    std::string s;
+    char line[128];
+    snprintf(line, sizeof(line), "guest instructions: %llu\n",
+             static_cast<unsigned long long>(guestInstructions));
+    s += line;
+    for (int c = 0; c < Count; ++c) {
+        if (valid[c])
+            snprintf(line, sizeof(line), "%-14s %14llu  (%.3f per guest instruction)\n", counterName[c],
+                     static_cast<unsigned long long>(value[c]), perGuestInstruction(static_cast<Counter>(c)));
+        else
+            snprintf(line, sizeof(line), "%-14s %14s\n", counterName[c], "unavailable");
+        s += line;
+    }
+    return s;
+}
+
+// ---------------------------------------------------------------------------
+// Function: PerfCounters::PerfCounters
+PerfCounters::PerfCounters() {
+    for (int& f : fd) f = -1;
+#ifdef __linux__
+    fd[PerfReport::Cycles] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    fd[PerfReport::Instructions] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    fd[PerfReport::BranchMisses] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+    fd[PerfReport::L1dMisses] = openCounter(PERF_TYPE_HW_CACHE,
+                                            PERF_COUNT_HW_CACHE_L1D |
+                                            (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                            (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// Function: PerfCounters::~PerfCounters
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+    for (int f : fd)
+        if (f >= 0) close(f);
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// Function: PerfCounters::available
+bool PerfCounters::available() const {
+    for (int f : fd)
+        if (f >= 0) return true;
+    return false;
+}
+
+// ---------------------------------------------------------------------------
+// Function: PerfCounters::start
+void PerfCounters::start() {
+#ifdef __linux__
+    for (int f : fd) {
+        if (f < 0) continue;
+        ioctl(f, PERF_EVENT_IOC_RESET, 0);
+        ioctl(f, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// Function: PerfCounters::stop
+void PerfCounters::stop() {
+#ifdef __linux__
+    for (int f : fd)
+        if (f >= 0) ioctl(f, PERF_EVENT_IOC_DISABLE, 0);
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// Function: PerfCounters::read
+PerfReport PerfCounters::read(uint64_t guestInstructions) const {
+    PerfReport report;
+    report.guestInstructions = guestInstructions;
+#ifdef __linux__
+    for (int c = 0; c < PerfReport::Count; ++c) {
+        uint64_t v = 0;
+        if (fd[c] >= 0 && ::read(fd[c], &v, sizeof(v)) == sizeof(v)) {
+            report.value[c] = v;
+            report.valid[c] = true;
+        }
+    }
+#endif
+    return report;
+}
+
+// ---------------------------------------------------------------------------
+// Function: PerfCounters::measure
+// Purpose: The instrumentation layer around VM::run
+PerfReport PerfCounters::measure(VM& vm, RunStatus& status, uint64_t budget) {
+    uint64_t before = vm.instructionsExecuted;
+    start();
+    status = vm.run(budget);
+    stop();
+    return read(vm.instructionsExecuted - before);
+}
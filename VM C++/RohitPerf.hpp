@@ -0,0 +1,68 @@
+// RohitPerf.hpp
+#pragma once  // Ensures this header is only included once during compilation
+
+#include <cstdint>      // For fixed-width integer types like uint64_t
+#include <string>       // For the report text
+
+#include "RohitVM.hpp"  // VM (the thing being measured)
+
+// ===========================================================================
+// Author: Rohit Yadav
+// Description: Optional hardware performance counter instrumentation.
+//              Uses Linux perf_event_open to count what the *host* CPU does
+//              while the interpreter runs (cycles, instructions, branch
+//              misses, L1d read misses) and divides by the number of guest
+//              instructions executed. That's how dispatch changes are
+//              compared and branch-misprediction regressions are spotted.
+//              On other systems (or when the kernel refuses the counters)
+//              everything still works, the counters just report unavailable.
+
+// ===========================================================================
+// STRUCT: PerfReport
+// Raw counts for one measured run, plus the guest instruction count.
+// ===========================================================================
+
+struct PerfReport {
+    enum Counter { Cycles, Instructions, BranchMisses, L1dMisses, Count };
+
+    uint64_t value[Count] = {};    // Host counts
+    bool valid[Count] = {};        // false if that counter couldn't be opened
+    uint64_t guestInstructions = 0;
+
+    // Host events per guest instruction (0 if invalid or nothing ran)
+    double perGuestInstruction(Counter c) const;
+
+    // Human readable summary, one line per counter
+    std::string toString() const;
+};
+
+// ===========================================================================
+// CLASS: PerfCounters
+// Counters for the calling thread. Create once, then start()/stop() around
+// the code to measure (or use measure() around VM::run).
+// ===========================================================================
+
+class PerfCounters {
+public:
+    PerfCounters();   // Opens the counters (disabled) for the calling thread
+    ~PerfCounters();  // Closes them
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available() const;  // true if at least one counter could be opened
+
+    void start();            // Reset and enable all counters
+    void stop();             // Disable all counters
+
+    // Reads the counters (after stop()) and normalizes by guestInstructions
+    PerfReport read(uint64_t guestInstructions) const;
+
+    // Runs vm.run(budget) with the counters enabled and returns the report;
+    // 'status' is what run() returned. Only the guest run is counted (no
+    // printing), and a trap ends the run instead of the process.
+    PerfReport measure(VM& vm, RunStatus& status, uint64_t budget = VM::UNLIMITED);
+
+private:
+    int fd[PerfReport::Count]; // perf_event file descriptors (-1 = unavailable)
+};
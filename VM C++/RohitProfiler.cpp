@@ -0,0 +1,154 @@
+// RohitProfiler.cpp
+// This file implements the sampling profiler.
+// The only work done between samples is the VM's "due?" comparison; the
+// stack walk and string building happen once per sample.
+
+#include "RohitProfiler.hpp"
+#include "RohitVM.hpp"   // BasicVM, Opcode::CALL
+#include "RohitMMU.hpp"  // PagedMemory
+#include <cstdio>        // For snprintf
+#include <vector>        // For collecting frames
+#include <csignal>       // For sigaction / SIGPROF
+#include <sys/time.h>    // For setitimer / ITIMER_PROF
+
+std::atomic<SamplingProfiler*> SamplingProfiler::timerTarget{nullptr};
+
+namespace {
+    const uint64_t NEVER = UINT64_MAX;   // nextSample value when no sample is pending
+    const size_t MAX_STACK_WORDS = 4096; // Upper bound on words scanned per stack walk
+}
+
+// ---------------------------------------------------------------------------
+// Function: SamplingProfiler::SamplingProfiler
+SamplingProfiler::SamplingProfiler(Mode mode, uint64_t period)
+    : mode(mode), period(period ? period : 1), nextSample(NEVER) {}
+
+// ---------------------------------------------------------------------------
+// Function: SamplingProfiler::~SamplingProfiler
+SamplingProfiler::~SamplingProfiler() {
+    stop();
+}
+
+// ---------------------------------------------------------------------------
+// Function: SamplingProfiler::start
+// Purpose: Arms the trigger. In timer mode this installs the SIGPROF handler
+// and starts a CPU-time interval timer (one per process).
+void SamplingProfiler::start() {
+    if (running) return;
+    running = true;
+
+    if (mode == Mode::InstructionInterval) {
+        nextSample.store(0, std::memory_order_relaxed); // First sample right away
+        return;
+    }
+
+    timerTarget.store(this);
+
+    struct sigaction sa{};
+    sa.sa_handler = &SamplingProfiler::onTimer;
+    sa.sa_flags = SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGPROF, &sa, nullptr);
+
+    uint64_t usec = 1000000 / period;
+    if (usec == 0) usec = 1;
+    itimerval timer{};
+    timer.it_interval.tv_sec = static_cast<time_t>(usec / 1000000);
+    timer.it_interval.tv_usec = static_cast<suseconds_t>(usec % 1000000);
+    timer.it_value = timer.it_interval;
+    setitimer(ITIMER_PROF, &timer, nullptr);
+}
+
+// ---------------------------------------------------------------------------
+// Function: SamplingProfiler::stop
+void SamplingProfiler::stop() {
+    if (!running) return;
+    running = false;
+    nextSample.store(NEVER, std::memory_order_relaxed);
+
+    if (mode == Mode::Timer) {
+        itimerval off{};
+        setitimer(ITIMER_PROF, &off, nullptr);
+        SamplingProfiler* self = this;
+        timerTarget.compare_exchange_strong(self, nullptr);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Function: SamplingProfiler::onTimer
+// Purpose: SIGPROF handler. Only makes the next "due?" check succeed; the
+// sample itself is taken by the VM at an instruction boundary.
+void SamplingProfiler::onTimer(int) {
+    SamplingProfiler* p = timerTarget.load(std::memory_order_relaxed);
+    if (p) p->nextSample.store(0, std::memory_order_relaxed);
+}
+
+// ---------------------------------------------------------------------------
+// Function: SamplingProfiler::sample
+// Purpose: Walks the guest stack and records one sample.
+// There are no frame pointers, so every stack word is checked: it is taken as
+// a return address if the bytes before it encode a CALL. The CALL's operand
+// then names the function that was entered.
+template <typename Word, typename Mem>
+void SamplingProfiler::sample(const BasicVM<Word, Mem>& vm) {
+    if (mode == Mode::InstructionInterval)
+        nextSample.store(vm.instructionsExecuted + period, std::memory_order_relaxed);
+    else
+        nextSample.store(NEVER, std::memory_order_relaxed);
+
+    const size_t W = sizeof(Word);
+    const size_t callSize = 1 + W;          // CALL opcode + target word
+    const size_t codeEnd = vm.breakLine;
+    const size_t memEnd = vm.memory.size();
+
+    // Little-endian word at 'addr' (caller keeps addr + W <= memEnd)
+    auto wordAt = [&](size_t addr) {
+        uint64_t v = 0;
+        for (size_t i = 0; i < W; ++i) v |= uint64_t(vm.memory.peek(static_cast<Word>(addr + i))) << (8 * i);
+        return v;
+    };
+
+    std::vector<uint64_t> callees; // Innermost first
+    size_t addr = vm.cpu.r.sp;
+    for (size_t words = 0; addr + W <= memEnd && words < MAX_STACK_WORDS &&
+                           callees.size() < maxDepth; addr += W, ++words) {
+        uint64_t ret = wordAt(addr);
+        if (ret < callSize || ret > codeEnd) continue;
+        if (vm.memory.peek(static_cast<Word>(ret - callSize)) != static_cast<uint8_t>(Opcode::CALL)) continue;
+        callees.push_back(wordAt(ret - W));
+    }
+
+    std::string key = "main";
+    char frame[24];
+    for (size_t i = callees.size(); i-- > 0;) {
+        snprintf(frame, sizeof(frame), ";fn_%04llx", static_cast<unsigned long long>(callees[i]));
+        key += frame;
+    }
+    if (includeIp) {
+        snprintf(frame, sizeof(frame), ";@0x%04llx", static_cast<unsigned long long>(vm.cpu.r.ip));
+        key += frame;
+    }
+
+    stacks[key]++;
+    total++;
+}
+
+template void SamplingProfiler::sample(const BasicVM<uint16_t>&);
+template void SamplingProfiler::sample(const BasicVM<uint32_t>&);
+template void SamplingProfiler::sample(const BasicVM<uint16_t, PagedMemory>&);
+template void SamplingProfiler::sample(const BasicVM<uint32_t, PagedMemory>&);
+
+// ---------------------------------------------------------------------------
+// Function: SamplingProfiler::writeCollapsed
+// Purpose: One "stack count" line per distinct stack (flamegraph input)
+void SamplingProfiler::writeCollapsed(std::ostream& out) const {
+    for (const auto& [stack, count] : stacks)
+        out << stack << ' ' << count << '\n';
+}
+
+// ---------------------------------------------------------------------------
+// Function: SamplingProfiler::clear
+void SamplingProfiler::clear() {
+    stacks.clear();
+    total = 0;
+}
@@ -0,0 +1,71 @@
+// RohitProfiler.hpp
+#pragma once  // Ensures this header is only included once during compilation
+
+#include <atomic>        // For the sample trigger shared with the signal handler
+#include <cstdint>       // For fixed-width integer types like uint64_t
+#include <ostream>       // For writing collapsed stacks
+#include <string>        // Stack keys
+#include <unordered_map> // Stack -> sample count
+
+template <typename Word, typename Mem> class BasicVM;  // Defined in RohitVM.hpp
+
+// ===========================================================================
+// Author: Rohit Yadav
+// Description: Low-overhead sampling profiler for guest code.
+//              Instead of counting every instruction, the VM only checks
+//              "is a sample due?" once per instruction (once per basic block
+//              on the verified handlers). A sample is triggered
+//              either every N guest instructions or by a SIGPROF timer, and
+//              records the guest IP plus the CALL stack found by walking the
+//              saved return addresses upwards from SP. Results are written in
+//              the collapsed-stack format used by flamegraph.pl / inferno:
+//
+//                  main;fn_0010;fn_0024 42
+//
+//              Frames are named after the CALL target (function entry address).
+
+class SamplingProfiler {
+public:
+    enum class Mode {
+        InstructionInterval, // Sample every 'period' guest instructions (deterministic)
+        Timer                // Sample 'period' times per second of CPU time (SIGPROF)
+    };
+
+    // period: instructions between samples, or samples per second for Mode::Timer
+    explicit SamplingProfiler(Mode mode = Mode::Timer, uint64_t period = 1000);
+    ~SamplingProfiler(); // Stops the timer if still running
+
+    SamplingProfiler(const SamplingProfiler&) = delete;
+    SamplingProfiler& operator=(const SamplingProfiler&) = delete;
+
+    void start(); // Arm the trigger (attach to a VM with vm.profiler = this)
+    void stop();  // Disarm it; collected samples are kept
+
+    // Called by the VM's execution loop; kept inline so the check stays cheap
+    bool due(uint64_t executed) const {
+        return executed >= nextSample.load(std::memory_order_relaxed);
+    }
+
+    // Records one sample of the VM's current IP and call stack
+    // (instantiated for the 16-bit VM and RohitVM-32)
+    template <typename Word, typename Mem>
+    void sample(const BasicVM<Word, Mem>& vm);
+
+    bool includeIp = false;   // Append the IP (e.g. "@0x0012") as the leaf frame
+    size_t maxDepth = 64;     // Frames recorded per sample
+
+    uint64_t samples() const { return total; }
+    void writeCollapsed(std::ostream& out) const; // "frame;frame;frame count" lines
+    void clear();
+
+private:
+    Mode mode;
+    uint64_t period;
+    std::atomic<uint64_t> nextSample; // Instruction count at which the next sample is due
+    uint64_t total = 0;
+    std::unordered_map<std::string, uint64_t> stacks;
+    bool running = false;
+
+    static void onTimer(int);                           // SIGPROF handler
+    static std::atomic<SamplingProfiler*> timerTarget;  // Profiler the timer triggers
+};
@@ -0,0 +1,522 @@
+// RohitRing.cpp
+// This file implements the shared-memory job ring: the layout of the shared
+// object, the lock-free slot queues, futex sleeping, and the ring workers.
+
+#include "RohitRing.hpp"
+#include "RohitServer.hpp"   // JobServer::prepare (same job setup as the socket server)
+#include "RohitCache.hpp"    // ResultCache
+#include <algorithm>         // For std::min / std::max
+#include <cerrno>            // errno
+#include <climits>           // INT_MAX (wake everyone)
+#include <csignal>           // kill(pid, 0): is a queue's owner still alive?
+#include <fcntl.h>           // O_* flags for shm_open
+#include <new>               // Placement new into the mapping
+#include <linux/futex.h>     // FUTEX_WAIT / FUTEX_WAKE
+#include <sys/mman.h>        // shm_open, mmap
+#include <sys/stat.h>        // fstat
+#include <sys/syscall.h>     // SYS_futex
+#include <unistd.h>          // ftruncate, close, syscall
+
+namespace {
+    constexpr uint64_t MAGIC = 0x474e495248544f52ull;   // "ROHTRING"
+    constexpr uint32_t VERSION = 2;
+    constexpr int SPINS = 4000;     // Polls before a consumer goes to sleep (a few microseconds)
+
+    // On a single CPU the thread we'd be spinning for can't run until we
+    // give up the CPU, so go straight to the futex there
+    int spinLimit() {
+        static const int limit = std::thread::hardware_concurrency() > 1 ? SPINS : 0;
+        return limit;
+    }
+
+    // Queue positions, sequence numbers and futex words are shared between
+    // processes: they must not need a lock
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "64-bit atomics must be lock-free");
+    static_assert(std::atomic<uint32_t>::is_always_lock_free, "32-bit atomics must be lock-free");
+
+    // -------------------------------
+    // Function: futexWait / futexWake
+    // Purpose: Sleep while *word == expected / wake sleepers on word. Not
+    // FUTEX_PRIVATE: the word is in memory shared with other processes.
+    void futexWait(std::atomic<uint32_t>& word, uint32_t expected) {
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, nullptr, nullptr, 0);
+    }
+
+    void futexWake(std::atomic<uint32_t>& word, int count) {
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, count, nullptr, nullptr, 0);
+    }
+
+    inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+    }
+
+    size_t roundUp(size_t n, size_t to) { return (n + to - 1) / to * to; }
+}
+
+// ---------------------------------------------------------------------------
+// Shared memory layout: Header, then the cells of the free, submit and
+// MAX_PRODUCERS completion queues, then the slots
+//
+// The queues are bounded MPMC queues (Vyukov): every cell has a sequence
+// number that says whether it is ready to be written (== position) or read
+// (== position + 1) for the lap the position is on, so a push or pop is one
+// CAS on the tail / head plus one release store. Each queue has room for
+// every slot, so a push never finds it full.
+
+struct Cell {
+    std::atomic<uint64_t> sequence;
+    uint32_t value;                     // Slot number
+};
+
+struct JobRing::Queue {
+    alignas(64) std::atomic<uint64_t> head;       // Next position to pop
+    alignas(64) std::atomic<uint64_t> tail;       // Next position to push
+    alignas(64) std::atomic<uint32_t> signal;     // Futex word, bumped when a sleeper must wake
+    std::atomic<uint32_t> sleepers;               // Consumers in (or about to enter) futexWait
+    uint64_t cellsOffset;                         // From the start of the mapping
+};
+
+// A completion queue and who owns it. Its cells are only initialized by
+// the first claim, so unused queues never touch their pages.
+struct JobRing::Producer {
+    Queue completed;
+    std::atomic<int32_t> owner;         // pid of the claiming process (0 = free)
+    std::atomic<uint32_t> generation;   // Bumped by every claim
+    std::atomic<uint32_t> ready;        // Cells initialized
+};
+
+struct JobRing::Header {
+    std::atomic<uint64_t> magic;    // Written last by create(): open() checks it
+    uint32_t version;
+    uint32_t slotCount;             // Power of two
+    uint32_t capacity;              // Image bytes per slot
+    uint32_t slotBytes;             // RingSlot + image, rounded to a cache line
+    uint64_t slotsOffset;
+    uint64_t totalBytes;
+    std::atomic<uint32_t> stopping;
+    Queue free, submitted;
+    Producer producers[JobRing::MAX_PRODUCERS];
+};
+
+namespace {
+    Cell* cellsOf(void* base, uint64_t offset) {
+        return reinterpret_cast<Cell*>(static_cast<uint8_t*>(base) + offset);
+    }
+
+    // -------------------------------
+    // Function: push / pop
+    // Purpose: The lock-free queue operations (false = full / empty)
+    template <typename Q>
+    bool push(void* base, Q& q, uint32_t mask, uint32_t value) {
+        Cell* cells = cellsOf(base, q.cellsOffset);
+        uint64_t pos = q.tail.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells[pos & mask];
+            int64_t diff = int64_t(cell->sequence.load(std::memory_order_acquire)) - int64_t(pos);
+            if (diff == 0) {
+                if (q.tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = q.tail.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = value;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    template <typename Q>
+    bool pop(void* base, Q& q, uint32_t mask, uint32_t& value) {
+        Cell* cells = cellsOf(base, q.cellsOffset);
+        uint64_t pos = q.head.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells[pos & mask];
+            int64_t diff = int64_t(cell->sequence.load(std::memory_order_acquire)) - int64_t(pos + 1);
+            if (diff == 0) {
+                if (q.head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = q.head.load(std::memory_order_relaxed);
+            }
+        }
+        value = cell->value;
+        cell->sequence.store(pos + mask + 1, std::memory_order_release);  // Free for the next lap
+        return true;
+    }
+
+    // -------------------------------
+    // Function: pushWake
+    // Purpose: Push, then wake a sleeping consumer if there is one. The
+    // fence pairs with the one in popWait: either we see its 'sleepers'
+    // increment, or it sees our item before it sleeps.
+    template <typename Q>
+    void pushWake(void* base, Q& q, uint32_t mask, uint32_t value) {
+        push(base, q, mask, value);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (q.sleepers.load(std::memory_order_relaxed) > 0) {
+            q.signal.fetch_add(1, std::memory_order_relaxed);
+            futexWake(q.signal, 1);
+        }
+    }
+
+    // -------------------------------
+    // Function: popWait
+    // Purpose: Pop, spinning a little and then sleeping on the queue's
+    // futex. False once 'stopping' is set.
+    template <typename Q>
+    bool popWait(void* base, Q& q, uint32_t mask, const std::atomic<uint32_t>& stopping, uint32_t& value) {
+        for (int i = 0, spins = spinLimit(); i < spins; ++i) {
+            if (pop(base, q, mask, value)) return true;
+            if (stopping.load(std::memory_order_relaxed)) return false;
+            cpuRelax();
+        }
+        while (true) {
+            q.sleepers.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            uint32_t seen = q.signal.load(std::memory_order_relaxed);
+            bool got = pop(base, q, mask, value);
+            if (!got && !stopping.load(std::memory_order_relaxed)) futexWait(q.signal, seen);
+            q.sleepers.fetch_sub(1, std::memory_order_relaxed);
+            if (got) return true;
+            if (stopping.load(std::memory_order_relaxed)) return false;
+            if (pop(base, q, mask, value)) return true;
+        }
+    }
+}
+
+// ===========================================================================
+// JobRing
+// ===========================================================================
+
+// ---------------------------------------------------------------------------
+// Function: JobRing::create
+// Purpose: Makes a new shared memory object, lays out the ring in it and
+// puts every slot in the free queue
+std::unique_ptr<JobRing> JobRing::create(const std::string& name, uint32_t slotCount, uint32_t capacity) {
+    if (capacity == 0 || capacity >= Memory::SIZE || slotCount == 0 || slotCount > (1u << 20)) {
+        errno = EINVAL;
+        return nullptr;
+    }
+    uint32_t count = 2;
+    while (count < slotCount) count <<= 1;
+
+    const size_t cellBytes = roundUp(sizeof(Cell) * count, 64);
+    const size_t slotBytes = roundUp(sizeof(RingSlot) + capacity, 64);
+    const size_t cellsOffset = roundUp(sizeof(Header), 64);
+    const size_t slotsOffset = cellsOffset + (2 + MAX_PRODUCERS) * cellBytes;
+    const size_t total = slotsOffset + slotBytes * count;
+
+    shm_unlink(name.c_str());   // Left over from an earlier run
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) return nullptr;
+    if (ftruncate(fd, static_cast<off_t>(total)) != 0) {
+        int error = errno;
+        close(fd);
+        shm_unlink(name.c_str());
+        errno = error;
+        return nullptr;
+    }
+    std::unique_ptr<JobRing> ring = map(fd, total);
+    if (!ring) {
+        shm_unlink(name.c_str());
+        return nullptr;
+    }
+    ring->unlinkName = name;
+
+    // The object starts zeroed: construct the header and cells in place
+    Header* h = new (ring->header) Header();
+    h->version = VERSION;
+    h->slotCount = count;
+    h->capacity = capacity;
+    h->slotBytes = static_cast<uint32_t>(slotBytes);
+    h->slotsOffset = slotsOffset;
+    h->totalBytes = total;
+    Queue* queues[] = {&h->free, &h->submitted};
+    for (int q = 0; q < 2; ++q) {
+        queues[q]->cellsOffset = cellsOffset + q * cellBytes;
+        Cell* cells = cellsOf(h, queues[q]->cellsOffset);
+        for (uint32_t i = 0; i < count; ++i) {
+            new (&cells[i]) Cell();
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+    for (uint32_t p = 0; p < MAX_PRODUCERS; ++p)
+        h->producers[p].completed.cellsOffset = cellsOffset + (2 + p) * cellBytes;
+    for (uint32_t i = 0; i < count; ++i) {
+        new (ring->slot(i)) RingSlot();
+        push(h, h->free, count - 1, i);
+    }
+
+    h->magic.store(MAGIC, std::memory_order_release);
+    return ring;
+}
+
+// ---------------------------------------------------------------------------
+// Function: JobRing::open
+std::unique_ptr<JobRing> JobRing::open(const std::string& name) {
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd < 0) return nullptr;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+        close(fd);
+        errno = EINVAL;
+        return nullptr;
+    }
+    std::unique_ptr<JobRing> ring = map(fd, static_cast<size_t>(st.st_size));
+    if (!ring) return nullptr;
+
+    const Header* h = ring->header;
+    if (h->magic.load(std::memory_order_acquire) != MAGIC || h->version != VERSION || h->totalBytes != ring->bytes) {
+        errno = EINVAL;
+        return nullptr;
+    }
+    return ring;
+}
+
+// ---------------------------------------------------------------------------
+// Function: JobRing::map
+// Purpose: Maps the whole object (closes 'fd' either way)
+std::unique_ptr<JobRing> JobRing::map(int fd, size_t size) {
+    void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    int error = errno;
+    close(fd);
+    if (p == MAP_FAILED) {
+        errno = error;
+        return nullptr;
+    }
+    std::unique_ptr<JobRing> ring(new JobRing());
+    ring->header = static_cast<Header*>(p);
+    ring->bytes = size;
+    return ring;
+}
+
+// ---------------------------------------------------------------------------
+// Function: JobRing::~JobRing
+JobRing::~JobRing() {
+    int p = producer.load();
+    if (header && p >= 0) header->producers[p].owner.store(0);   // Stale completions are dropped by the next owner
+    if (header) munmap(header, bytes);
+    if (!unlinkName.empty()) shm_unlink(unlinkName.c_str());
+}
+
+// ---------------------------------------------------------------------------
+// Function: slot / indexOf
+RingSlot* JobRing::slot(uint32_t index) const {
+    return reinterpret_cast<RingSlot*>(reinterpret_cast<uint8_t*>(header) + header->slotsOffset +
+                                       size_t(index) * header->slotBytes);
+}
+
+uint32_t JobRing::indexOf(const RingSlot* s) const {
+    size_t offset = reinterpret_cast<const uint8_t*>(s) - reinterpret_cast<const uint8_t*>(header) - header->slotsOffset;
+    return static_cast<uint32_t>(offset / header->slotBytes);
+}
+
+// ---------------------------------------------------------------------------
+// Function: JobRing::claim
+// Purpose: Takes a completion queue that is free, or whose owner process
+// has died. Every claim gets a new generation: slots an earlier owner
+// acquired carry an older one, and poll()/wait() hand those back to the
+// free pool instead of returning them.
+bool JobRing::claim() {
+    std::lock_guard<std::mutex> guard(claimLock);
+    if (producer.load() >= 0) return true;
+    const int32_t me = static_cast<int32_t>(getpid());
+    for (uint32_t p = 0; p < MAX_PRODUCERS; ++p) {
+        Producer& q = header->producers[p];
+        int32_t owner = q.owner.load();
+        if (owner != 0 && !(kill(owner, 0) != 0 && errno == ESRCH)) continue;
+        if (!q.owner.compare_exchange_strong(owner, me)) continue;
+
+        if (!q.ready.load(std::memory_order_acquire)) {
+            // First use: nothing can be in it yet (no slot was ever stamped with it)
+            Cell* cells = cellsOf(header, q.completed.cellsOffset);
+            for (uint32_t i = 0; i < header->slotCount; ++i) {
+                new (&cells[i]) Cell();
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+            q.ready.store(1, std::memory_order_release);
+        }
+        generation = q.generation.fetch_add(1) + 1;
+        producer.store(static_cast<int>(p));
+        return true;
+    }
+    errno = EBUSY;
+    return false;
+}
+
+// ---------------------------------------------------------------------------
+// Function: acquire / submit / poll / wait / release (producer side)
+RingSlot* JobRing::acquire() {
+    if (producer.load(std::memory_order_relaxed) < 0 && !claim()) return nullptr;
+    uint32_t index;
+    if (!pop(header, header->free, header->slotCount - 1, index)) return nullptr;
+    RingSlot* s = slot(index);
+    s->producer = static_cast<uint32_t>(producer.load(std::memory_order_relaxed));
+    s->generation = generation;
+    return s;
+}
+
+void JobRing::submit(RingSlot* s) {
+    pushWake(header, header->submitted, header->slotCount - 1, indexOf(s));
+}
+
+RingSlot* JobRing::poll() {
+    int p = producer.load();
+    if (p < 0) return nullptr;
+    uint32_t index;
+    while (pop(header, header->producers[p].completed, header->slotCount - 1, index)) {
+        RingSlot* s = slot(index);
+        if (s->generation == generation) return s;
+        release(s);   // Acquired by an earlier owner of the queue
+    }
+    return nullptr;
+}
+
+RingSlot* JobRing::wait() {
+    int p = producer.load();
+    if (p < 0) return nullptr;   // Nothing was ever submitted through this handle
+    uint32_t index;
+    while (popWait(header, header->producers[p].completed, header->slotCount - 1, header->stopping, index)) {
+        RingSlot* s = slot(index);
+        if (s->generation == generation) return s;
+        release(s);
+    }
+    return nullptr;
+}
+
+void JobRing::release(RingSlot* s) {
+    push(header, header->free, header->slotCount - 1, indexOf(s));
+}
+
+// ---------------------------------------------------------------------------
+// Function: take / complete (worker side)
+RingSlot* JobRing::take() {
+    uint32_t index;
+    return popWait(header, header->submitted, header->slotCount - 1, header->stopping, index) ? slot(index) : nullptr;
+}
+
+void JobRing::complete(RingSlot* s) {
+    uint32_t p = s->producer;   // Read once: the producer shouldn't, but might, change it
+    if (p >= MAX_PRODUCERS) {
+        release(s);             // Nobody to answer
+        return;
+    }
+    pushWake(header, header->producers[p].completed, header->slotCount - 1, indexOf(s));
+}
+
+// ---------------------------------------------------------------------------
+// Function: shutdown
+void JobRing::shutdown() {
+    header->stopping.store(1);
+    auto wakeAll = [](Queue& q) {
+        q.signal.fetch_add(1);
+        futexWake(q.signal, INT_MAX);
+    };
+    wakeAll(header->submitted);
+    for (Producer& p : header->producers) wakeAll(p.completed);
+}
+
+bool JobRing::isShutdown() const { return header->stopping.load() != 0; }
+uint32_t JobRing::slots() const { return header->slotCount; }
+uint32_t JobRing::imageCapacity() const { return header->capacity; }
+
+// ===========================================================================
+// RingWorkers
+// ===========================================================================
+
+RingWorkers::RingWorkers(JobRing& jobRing, size_t count, ResultCache* memo) : ring(jobRing), results(memo) {
+    if (count == 0) count = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t i = 0; i < count; ++i) threads.emplace_back([this] { work(); });
+}
+
+RingWorkers::~RingWorkers() {
+    ring.shutdown();
+    for (std::thread& t : threads) t.join();
+}
+
+// ---------------------------------------------------------------------------
+// Function: RingWorkers::work
+// Purpose: One worker: a VM reused for every job it takes. The result is
+// written straight into the job's slot.
+void RingWorkers::work() {
+    VM vm;
+    vm.memory.clear();          // Commit the pages now rather than on the first job
+
+    // OUT values are collected here and copied into the slot at the end.
+    // With memoization everything that goes into the cache must come from
+    // the worker's own copies (image, registers, output): a producer
+    // rewriting its slot mid-job must not be able to file one program's
+    // result under another program's image.
+    std::vector<std::pair<uint16_t, uint16_t>> output;
+    bool truncated = false;
+    output.reserve(RingSlot::MAX_OUTPUTS);
+    vm.onOutput = [&](uint16_t port, uint16_t value) {
+        if (output.size() < RingSlot::MAX_OUTPUTS) output.emplace_back(port, value);
+        else truncated = true;
+    };
+    std::vector<uint8_t> image;
+    if (results) image.reserve(ring.imageCapacity());
+
+    RingSlot* current;
+    while ((current = ring.take()) != nullptr) {
+        RingSlot& s = *current;
+        s.ioPort = 0;
+        s.outputs = 0;
+        s.truncated = false;
+        uint32_t size = s.imageSize;    // Read once: the producer shouldn't, but might, change it
+        if (size > ring.imageCapacity()) {
+            s.status = RunStatus::Trapped;
+            s.trap = Trap::MemoryFault;
+            s.result = s.regs;
+            s.instructions = 0;
+            ring.complete(current);
+            jobs++;
+            continue;
+        }
+
+        const uint8_t* bytes = s.image();
+        const Registers regs = s.regs;
+        const uint64_t budget = std::min<uint64_t>(s.budget, MAX_BUDGET);
+        std::shared_ptr<const MemoizedRun> hit;
+        if (results) {
+            image.assign(bytes, bytes + size);
+            bytes = image.data();
+            hit = results->lookup(bytes, static_cast<uint16_t>(size), regs, budget);
+        }
+
+        const std::vector<std::pair<uint16_t, uint16_t>>* out = &output;
+        if (hit) {
+            s.status = hit->status;
+            s.trap = hit->trap;
+            s.result = hit->regs;
+            s.instructions = hit->instructions;
+            if (hit->status == RunStatus::WaitingForInput) s.ioPort = hit->ioPort;
+            s.truncated = hit->truncated || hit->output.size() > RingSlot::MAX_OUTPUTS;
+            out = &hit->output;
+        } else {
+            output.clear();
+            truncated = false;
+            JobServer::prepare(vm, bytes, static_cast<uint16_t>(size), regs);
+            s.status = vm.run(budget);
+            s.trap = vm.trap;
+            s.result = vm.cpu.r;
+            s.instructions = vm.instructionsExecuted;
+            if (s.status == RunStatus::WaitingForInput) s.ioPort = vm.ioPort;
+            s.truncated = truncated;
+            if (results) results->store(bytes, static_cast<uint16_t>(size), regs, budget, s.status, vm, output, truncated);
+        }
+        s.outputs = static_cast<uint16_t>(std::min(out->size(), RingSlot::MAX_OUTPUTS));
+        for (size_t i = 0; i < s.outputs; ++i) {
+            s.output[i][0] = (*out)[i].first;
+            s.output[i][1] = (*out)[i].second;
+        }
+        ring.complete(current);
+        jobs++;
+    }
+}
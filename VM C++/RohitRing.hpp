@@ -0,0 +1,192 @@
+// RohitRing.hpp
+#pragma once  // Ensures this header is only included once during compilation
+
+#include <atomic>       // Queue positions and sequence numbers live in shared memory
+#include <cstdint>      // For fixed-width integer types like uint16_t
+#include <memory>       // JobRing::create / open return std::unique_ptr
+#include <mutex>        // A handle claims its completion queue once
+#include <string>       // Shared memory object names
+#include <thread>       // RingWorkers
+#include <vector>       // Worker threads
+
+#include "RohitVM.hpp"  // Registers, RunStatus, Trap
+
+class ResultCache;      // Defined in RohitCache.hpp (optional memoization of whole jobs)
+
+// ===========================================================================
+// Author: Rohit Yadav
+// Description: Shared-memory job transport for co-located producers.
+//              The socket server (RohitServer.hpp) copies every image
+//              through the kernel twice. A JobRing is one shared memory
+//              object (shm_open) holding a pool of job slots and bounded
+//              MPMC queues of slot numbers: one free queue, one submit
+//              queue and a completion queue per producer:
+//
+//                free  --acquire()-->  producer writes the image, registers
+//                                      and budget straight into the slot
+//                      --submit()--->  submit queue
+//                      --take()----->  worker runs it, writes the result
+//                                      into the same slot
+//                      --complete()->  that producer's completion queue
+//                      --poll()----->  producer reads the result
+//                      --release()-->  free again
+//
+//              Only 4-byte slot numbers move through the queues, nothing is
+//              copied on the way in or out, and in the common case no system
+//              call is made: the queues are lock-free (one CAS per push or
+//              pop) and a consumer only sleeps on a futex after spinning for
+//              a while, so producers only wake it with a syscall when it has
+//              actually gone to sleep. Any number of processes and threads
+//              can produce and consume at the same time.
+//
+//              A completed job goes back to the JobRing handle that acquired
+//              its slot, never to another producer: each handle claims one
+//              of MAX_PRODUCERS completion queues on its first acquire()
+//              and gives it back when destroyed (or when its process dies).
+//              Threads sharing a handle share its completions.
+//
+//              Workers copy the image from the slot into their VM's memory
+//              (one RohitUtils::copy of the image bytes, no page mapping
+//              games: remapping a slot into a VM per job would cost a page
+//              fault and a TLB shootdown, far more than copying a small
+//              program). Linux only (shm_open, futex).
+
+// ===========================================================================
+// STRUCT: RingSlot
+// One job in shared memory: the request the producer writes, then the
+// result the worker writes. The image follows the struct in the slot.
+// ===========================================================================
+
+struct alignas(64) RingSlot {
+    static constexpr size_t MAX_OUTPUTS = 64;   // OUT values kept per job
+
+    // ----------- Request (written by the producer before submit) -----------
+    uint64_t tag = 0;              // Anything the producer wants back (e.g. a request id)
+    uint64_t budget = 0;           // Instruction budget
+    Registers regs;                // Registers the program starts with
+    uint32_t imageSize = 0;        // Bytes of image() used (at most the ring's imageCapacity)
+    uint32_t producer = 0;         // Set by acquire(): whose completion queue it goes back to
+    uint32_t generation = 0;       // Set by acquire(): which claim of that queue
+
+    // ----------- Result (written by the worker before complete) -----------
+    // An imageSize over the capacity is answered with Trapped / MemoryFault
+    // without running anything.
+    RunStatus status = RunStatus::BudgetExhausted;
+    Trap trap = Trap::None;        // Only meaningful when status == Trapped
+    bool truncated = false;        // More OUT values than MAX_OUTPUTS
+    uint16_t ioPort = 0;           // Port of the IN it waits on (WaitingForInput)
+    uint16_t outputs = 0;          // Entries used in output
+    Registers result;              // Registers when the run stopped
+    uint64_t instructions = 0;     // Instructions executed
+    uint16_t output[MAX_OUTPUTS][2] = {};   // (port, value) per OUT, in order
+
+    uint8_t* image() { return reinterpret_cast<uint8_t*>(this + 1); }
+    const uint8_t* image() const { return reinterpret_cast<const uint8_t*>(this + 1); }
+};
+
+// ===========================================================================
+// CLASS: JobRing
+//
+//     // Process A (owns the object, runs the VMs)
+//     auto ring = JobRing::create("/rohit-jobs");
+//     RingWorkers workers(*ring, 4);
+//
+//     // Process B (any number of them, each with its own completions)
+//     auto ring = JobRing::open("/rohit-jobs");
+//     RingSlot* slot = ring->acquire();            // nullptr: every slot is busy
+//     memcpy(slot->image(), bytes, n); slot->imageSize = n;
+//     slot->budget = 100000; slot->tag = 7;
+//     ring->submit(slot);
+//     ...
+//     RingSlot* done = ring->wait();               // Or poll() without blocking
+//     use(done->status, done->result);
+//     ring->release(done);
+// ===========================================================================
+
+class JobRing {
+public:
+    static constexpr uint32_t DEFAULT_SLOTS = 1024;
+    static constexpr uint32_t DEFAULT_IMAGE_CAPACITY = 4096;
+    static constexpr uint32_t MAX_PRODUCERS = 32;   // Handles producing at the same time
+
+    // Creates (replacing any old one) and maps the shared memory object.
+    // 'slots' is rounded up to a power of two; 'imageCapacity' must be
+    // below 64 KiB. Returns nullptr on error (see errno).
+    static std::unique_ptr<JobRing> create(const std::string& name, uint32_t slots = DEFAULT_SLOTS,
+                                           uint32_t imageCapacity = DEFAULT_IMAGE_CAPACITY);
+
+    // Maps an existing ring. nullptr on error (errno) or if it isn't a JobRing.
+    static std::unique_ptr<JobRing> open(const std::string& name);
+
+    ~JobRing();   // Unmaps it; the creator also removes the name
+    JobRing(const JobRing&) = delete;
+    JobRing& operator=(const JobRing&) = delete;
+
+    // ----------- Producer side -----------
+    // acquire() returns nullptr if every slot is in use, or (errno EBUSY)
+    // if MAX_PRODUCERS other handles hold every completion queue
+    RingSlot* acquire();              // A free slot
+    void submit(RingSlot* slot);      // Hands the filled-in slot to the workers
+    RingSlot* poll();                 // One of this handle's completed slots, or nullptr
+    RingSlot* wait();                 // Blocks for one (nullptr after shutdown, or before any acquire)
+    void release(RingSlot* slot);     // Back to the free pool
+
+    // ----------- Worker side -----------
+    RingSlot* take();                 // Blocks for a submitted slot (nullptr after shutdown)
+    void complete(RingSlot* slot);    // Publishes the result
+
+    // Wakes every waiter; take() and wait() return nullptr from now on
+    void shutdown();
+    bool isShutdown() const;
+
+    uint32_t slots() const;
+    uint32_t imageCapacity() const;
+
+private:
+    struct Header;                    // Layout of the shared memory (see RohitRing.cpp)
+    struct Queue;
+    struct Producer;
+
+    Header* header = nullptr;
+    size_t bytes = 0;                 // Size of the mapping
+    std::string unlinkName;           // Set for the creator
+    std::atomic<int> producer{-1};    // Completion queue this handle claimed (-1: none yet)
+    uint32_t generation = 0;          // Claim number stamped into our slots
+    std::mutex claimLock;
+
+    bool claim();                     // Claims a free (or orphaned) completion queue
+
+    JobRing() = default;
+    static std::unique_ptr<JobRing> map(int fd, size_t bytes);
+    RingSlot* slot(uint32_t index) const;
+    uint32_t indexOf(const RingSlot* slot) const;
+};
+
+// ===========================================================================
+// CLASS: RingWorkers
+// Threads that take jobs from a ring and run them, each on its own reused
+// VM (the same preparation as JobServer), or answer them from a
+// ResultCache. Stopped and joined by the destructor, or by the ring's
+// shutdown().
+// ===========================================================================
+
+class RingWorkers {
+public:
+    static constexpr uint64_t MAX_BUDGET = uint64_t(1) << 32;  // Per job, whatever the slot says
+
+    // count: 0 = one per hardware thread. results: memoize jobs in it
+    // (nullptr = run every job); must outlive the workers.
+    RingWorkers(JobRing& ring, size_t count = 0, ResultCache* results = nullptr);
+    ~RingWorkers();                                 // ring.shutdown(), then joins
+    RingWorkers(const RingWorkers&) = delete;
+    RingWorkers& operator=(const RingWorkers&) = delete;
+
+    std::atomic<uint64_t> jobs{0};                  // Jobs run
+
+private:
+    JobRing& ring;
+    ResultCache* results;
+    std::vector<std::thread> threads;
+
+    void work();
+};
@@ -0,0 +1,381 @@
+// RohitServer.cpp
+// This file implements the job server: the wire format, the connection
+// threads that read requests, and the worker threads that run them.
+
+#include "RohitServer.hpp"
+#include "RohitCache.hpp"    // ProgramCache (each job's image)
+#include <algorithm>         // For std::min / std::max / std::remove_if
+#include <cerrno>            // EINTR
+#include <cstring>           // For memmove / strncpy
+#include <sys/socket.h>      // socket, bind, listen, accept, send, recv, shutdown
+#include <sys/un.h>          // sockaddr_un
+#include <unistd.h>          // close, unlink
+
+namespace {
+
+    // -------------------------------
+    // Little-endian field writers / readers for the wire format
+    void put8(std::vector<uint8_t>& out, uint8_t v) { out.push_back(v); }
+    void put16(std::vector<uint8_t>& out, uint16_t v) { out.push_back(v & 0xff); out.push_back(v >> 8); }
+    void put32(std::vector<uint8_t>& out, uint32_t v) { put16(out, v & 0xffff); put16(out, v >> 16); }
+    void put64(std::vector<uint8_t>& out, uint64_t v) { put32(out, v & 0xffffffffu); put32(out, v >> 32); }
+
+    uint16_t get16(const uint8_t* p) { return static_cast<uint16_t>(p[0] | (p[1] << 8)); }
+    uint32_t get32(const uint8_t* p) { return get16(p) | (uint32_t(get16(p + 2)) << 16); }
+    uint64_t get64(const uint8_t* p) { return get32(p) | (uint64_t(get32(p + 4)) << 32); }
+
+    void putRegisters(std::vector<uint8_t>& out, const Registers& r) {
+        for (uint16_t v : {r.ax, r.bx, r.cx, r.dx, r.sp, r.ip, r.flags}) put16(out, v);
+    }
+
+    void getRegisters(const uint8_t* p, Registers& r) {
+        r.ax = get16(p);      r.bx = get16(p + 2);  r.cx = get16(p + 4);  r.dx = get16(p + 6);
+        r.sp = get16(p + 8);  r.ip = get16(p + 10); r.flags = get16(p + 12);
+    }
+
+    // Reserves the length prefix of a frame; finishFrame fills it in
+    size_t startFrame(std::vector<uint8_t>& out) {
+        size_t at = out.size();
+        put32(out, 0);
+        return at;
+    }
+
+    void finishFrame(std::vector<uint8_t>& out, size_t at) {
+        uint32_t length = static_cast<uint32_t>(out.size() - at - 4);
+        for (int i = 0; i < 4; ++i) out[at + i] = (length >> (8 * i)) & 0xff;
+    }
+
+} // namespace
+
+// ===========================================================================
+// JobWire
+// ===========================================================================
+
+// ---------------------------------------------------------------------------
+// Function: JobWire::encode
+// Purpose: Appends one whole frame (length prefix included)
+void JobWire::encode(const JobRequest& request, std::vector<uint8_t>& out) {
+    size_t at = startFrame(out);
+    put32(out, request.id);
+    put64(out, request.budget);
+    putRegisters(out, request.regs);
+    out.insert(out.end(), request.image.begin(), request.image.end());
+    finishFrame(out, at);
+}
+
+void JobWire::encode(const JobResponse& response, std::vector<uint8_t>& out) {
+    size_t at = startFrame(out);
+    put32(out, response.id);
+    put8(out, static_cast<uint8_t>(response.status));
+    put8(out, static_cast<uint8_t>(response.trap));
+    putRegisters(out, response.regs);
+    put64(out, response.instructions);
+    put16(out, response.ioPort);
+    put16(out, static_cast<uint16_t>(response.output.size()));
+    put8(out, response.truncated);
+    for (const auto& o : response.output) {
+        put16(out, o.first);
+        put16(out, o.second);
+    }
+    finishFrame(out, at);
+}
+
+// ---------------------------------------------------------------------------
+// Function: JobWire::decode
+// Purpose: Parses a frame body; false if it's too short, too long or has
+// values out of range
+bool JobWire::decode(const uint8_t* body, size_t size, JobRequest& request) {
+    if (size < REQUEST_HEADER || size > MAX_REQUEST) return false;
+    request.id = get32(body);
+    request.budget = get64(body + 4);
+    getRegisters(body + 12, request.regs);
+    request.image.assign(body + REQUEST_HEADER, body + size);
+    return true;
+}
+
+bool JobWire::decode(const uint8_t* body, size_t size, JobResponse& response) {
+    if (size < RESPONSE_HEADER) return false;
+    response.id = get32(body);
+    if (body[4] >= RUN_STATUS_COUNT || body[5] > static_cast<uint8_t>(Trap::Breakpoint))
+        return false;
+    response.status = static_cast<RunStatus>(body[4]);
+    response.trap = static_cast<Trap>(body[5]);
+    getRegisters(body + 6, response.regs);
+    response.instructions = get64(body + 20);
+    response.ioPort = get16(body + 28);
+    size_t count = get16(body + 30);
+    response.truncated = body[32] != 0;
+    if (size != RESPONSE_HEADER + 4 * count) return false;
+
+    response.output.resize(count);
+    for (size_t i = 0; i < count; ++i)
+        response.output[i] = {get16(body + RESPONSE_HEADER + 4 * i), get16(body + RESPONSE_HEADER + 4 * i + 2)};
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Function: JobWire::Reader::next
+// Purpose: Returns the next frame body. Reads as much as the socket has
+// (up to the buffer size) per recv, so small pipelined frames cost one
+// system call for many requests.
+bool JobWire::Reader::next(const uint8_t*& body, size_t& size, size_t maxSize) {
+    auto fill = [&](size_t need) {
+        // Make room: move what's left to the front, grow for a big frame
+        if (buffer.size() - begin < need) {
+            memmove(buffer.data(), buffer.data() + begin, end - begin);
+            end -= begin;
+            begin = 0;
+            if (buffer.size() < need) buffer.resize(need);
+        }
+        while (end - begin < need) {
+            ssize_t got = recv(fd, buffer.data() + end, buffer.size() - end, 0);
+            if (got < 0 && errno == EINTR) continue;
+            if (got <= 0) return false;
+            end += static_cast<size_t>(got);
+        }
+        return true;
+    };
+
+    if (!fill(4)) return false;
+    size_t length = get32(buffer.data() + begin);
+    if (length > maxSize) return false;
+    if (!fill(4 + length)) return false;
+
+    body = buffer.data() + begin + 4;
+    size = length;
+    begin += 4 + length;
+    return true;
+}
+
+bool JobWire::Reader::hasFrame() const {
+    return end - begin >= 4 && end - begin >= 4 + size_t(get32(buffer.data() + begin));
+}
+
+// ---------------------------------------------------------------------------
+// Function: JobWire::sendAll
+bool JobWire::sendAll(int fd, const uint8_t* data, size_t size) {
+    while (size > 0) {
+        ssize_t sent = send(fd, data, size, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return false;
+        data += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+// ===========================================================================
+// JobServer
+// ===========================================================================
+
+// One client. Workers answer on it from several threads, so writes are
+// serialized; the socket closes when the reader and every queued job are done.
+struct JobServer::Connection {
+    int fd;
+    std::mutex writeLock;
+
+    explicit Connection(int fd) : fd(fd) {}
+    ~Connection() { close(fd); }
+
+    bool send(const std::vector<uint8_t>& frame) {
+        std::lock_guard<std::mutex> guard(writeLock);
+        return JobWire::sendAll(fd, frame.data(), frame.size());
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Function: JobServer::JobServer
+// Purpose: Starts the workers. Each builds its VM and touches its memory
+// once up front, so the first jobs don't pay for the allocation.
+JobServer::JobServer(size_t count, ResultCache* memo) : results(memo) {
+    if (count == 0) count = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t i = 0; i < count; ++i) workers.emplace_back([this] { work(); });
+}
+
+// ---------------------------------------------------------------------------
+// Function: JobServer::~JobServer
+JobServer::~JobServer() {
+    stop();
+    for (std::thread& t : workers) t.join();
+
+    std::unique_lock<std::mutex> guard(lock);
+    readersDone.wait(guard, [this] { return liveReaders == 0; });
+    guard.unlock();
+
+    if (listenFd >= 0) close(listenFd);
+    if (!unixPath.empty()) unlink(unixPath.c_str());
+}
+
+// ---------------------------------------------------------------------------
+// Function: JobServer::listenUnix
+bool JobServer::listenUnix(const std::string& path) {
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) return false;
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0) return false;
+
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    unlink(path.c_str());   // Left over from an earlier run
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) return false;
+    unixPath = path;
+    return listen(listenFd, SOMAXCONN) == 0;
+}
+
+// ---------------------------------------------------------------------------
+// Function: JobServer::serve
+// Purpose: The accept loop. Every connection gets its own (detached)
+// reader thread; stop() wakes accept by shutting the socket down.
+bool JobServer::serve() {
+    if (listenFd < 0) return false;
+    while (!stopping) {
+        int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            return stopping.load();     // Shut down by stop(), or a real error
+        }
+        connections++;
+
+        auto connection = std::make_shared<Connection>(fd);
+        std::lock_guard<std::mutex> guard(lock);
+        if (stopping) break;            // 'connection' closes the socket
+        clients.erase(std::remove_if(clients.begin(), clients.end(),
+                                     [](const auto& c) { return c.expired(); }), clients.end());
+        clients.push_back(connection);
+        liveReaders++;
+        std::thread([this, connection] { read(connection); }).detach();
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Function: JobServer::stop
+// Purpose: Wakes everything that may be waiting: accept, the readers' recv
+// and the condition variables. Jobs already queued are dropped.
+void JobServer::stop() {
+    std::lock_guard<std::mutex> guard(lock);
+    if (stopping.exchange(true)) return;
+    if (listenFd >= 0) shutdown(listenFd, SHUT_RDWR);
+    for (const auto& client : clients)
+        if (auto c = client.lock()) shutdown(c->fd, SHUT_RDWR);
+    queue.clear();
+    jobReady.notify_all();
+    queueSpace.notify_all();
+}
+
+// ---------------------------------------------------------------------------
+// Function: JobServer::read
+// Purpose: Connection thread: decodes requests and queues them until the
+// client disconnects, sends a malformed frame, or the server stops
+void JobServer::read(std::shared_ptr<Connection> connection) {
+    JobWire::Reader reader(connection->fd);
+    const uint8_t* body;
+    size_t size;
+    while (reader.next(body, size, JobWire::MAX_REQUEST)) {
+        Job job{connection, {}};
+        if (!JobWire::decode(body, size, job.request)) break;
+
+        std::unique_lock<std::mutex> guard(lock);
+        queueSpace.wait(guard, [this] { return stopping || queue.size() < MAX_QUEUED; });
+        if (stopping) break;
+        queue.push_back(std::move(job));
+        guard.unlock();
+        jobReady.notify_one();
+    }
+
+    // Stop reading; workers still answer what's queued (the socket closes
+    // when the last of those jobs lets go of the connection)
+    shutdown(connection->fd, SHUT_RD);
+    connection.reset();
+
+    std::lock_guard<std::mutex> guard(lock);
+    liveReaders--;
+    readersDone.notify_all();
+}
+
+// ---------------------------------------------------------------------------
+// Function: JobServer::work
+// Purpose: Worker thread. Owns one VM for its whole life and reuses it.
+void JobServer::work() {
+    VM vm;
+    vm.memory.clear();          // Commit the pages now rather than on the first job
+    JobResponse response;
+    std::vector<uint8_t> frame;
+
+    vm.onOutput = [&](uint16_t port, uint16_t value) {
+        if (response.output.size() < MAX_OUTPUTS) response.output.emplace_back(port, value);
+        else response.truncated = true;
+    };
+
+    while (true) {
+        std::unique_lock<std::mutex> guard(lock);
+        jobReady.wait(guard, [this] { return stopping || !queue.empty(); });
+        if (stopping) return;
+        Job job = std::move(queue.front());
+        queue.pop_front();
+        guard.unlock();
+        queueSpace.notify_one();
+
+        run(vm, job.request, response);
+        frame.clear();
+        JobWire::encode(response, frame);
+        job.connection->send(frame);   // A client that went away just misses its answer
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Function: JobServer::prepare
+// Purpose: Wipes a reused VM and loads one job's image and registers
+void JobServer::prepare(VM& vm, const uint8_t* image, uint16_t size, const Registers& regs) {
+    vm.reset();
+    vm.memory.clear();          // Nothing of the previous job may show through
+    RohitUtils::copy(vm.memory.raw(), image, size);
+    vm.breakLine = size;
+    vm.cpu.r = regs;
+    vm.cpu.r.flags &= Registers::AllFlags;
+    // Verify the VM's copy, not 'image': a ring producer could still be
+    // writing to its slot, and the proof must match what actually runs
+    vm.verified = ProgramCache::global().verify(vm.memory.raw(), size, vm.cpu.r.ip, vm.cpu.r.sp);
+}
+
+// ---------------------------------------------------------------------------
+// Function: JobServer::run
+// Purpose: One job on a reused VM (or from the result cache)
+void JobServer::run(VM& vm, const JobRequest& request, JobResponse& response) {
+    const uint8_t* image = request.image.data();
+    const uint16_t size = static_cast<uint16_t>(request.image.size());   // < 64 KiB (decode checked)
+    const uint64_t budget = std::min(request.budget, MAX_BUDGET);
+
+    response.id = request.id;
+    response.output.clear();
+    response.truncated = false;
+
+    if (results) {
+        if (std::shared_ptr<const MemoizedRun> hit = results->lookup(image, size, request.regs, budget)) {
+            response.status = hit->status;
+            response.trap = hit->trap;
+            response.regs = hit->regs;
+            response.instructions = hit->instructions;
+            response.ioPort = hit->status == RunStatus::WaitingForInput ? hit->ioPort : 0;
+            response.output = hit->output;
+            response.truncated = hit->truncated;
+            jobs++;
+            byStatus[static_cast<int>(response.status)]++;
+            return;
+        }
+    }
+
+    prepare(vm, image, size, request.regs);
+    response.status = vm.run(budget);
+    response.trap = vm.trap;
+    response.regs = vm.cpu.r;
+    response.instructions = vm.instructionsExecuted;
+    response.ioPort = response.status == RunStatus::WaitingForInput ? vm.ioPort : 0;
+    if (results) results->store(image, size, request.regs, budget, response.status, vm, response.output,
+                                response.truncated);
+
+    jobs++;
+    instructions += vm.instructionsExecuted;
+    byStatus[static_cast<int>(response.status)]++;
+}
@@ -0,0 +1,182 @@
+// RohitServer.hpp
+#pragma once  // Ensures this header is only included once during compilation
+
+#include <atomic>             // Statistics and the stop flag
+#include <condition_variable> // Workers sleep until a job arrives
+#include <cstdint>            // For fixed-width integer types like uint16_t
+#include <deque>              // The job queue
+#include <memory>             // Connections are shared by their pending jobs
+#include <mutex>              // Guards the job queue
+#include <string>             // Socket path
+#include <thread>             // Worker, connection and accept threads
+#include <vector>             // Program images, output, the worker pool
+
+#include "RohitVM.hpp"  // VM, Registers, RunStatus, Trap
+
+class ResultCache;      // Defined in RohitCache.hpp (optional memoization of whole jobs)
+
+// ===========================================================================
+// Author: Rohit Yadav
+// Description: RohitVM as a local service.
+//              JobServer listens on a Unix domain socket for framed job
+//              requests (a program image, the initial registers and an
+//              instruction budget), runs them on a pool of pre-warmed 16-bit
+//              VMs, one per worker thread, and answers each one with a
+//              compact binary response (final registers, run status, trap,
+//              instruction count and what the program wrote with OUT).
+//
+//              Wire format, every integer little-endian like the VM itself.
+//              Each message is a 4-byte length followed by that many bytes:
+//
+//                request:  id u32 | budget u64 | ax bx cx dx sp ip flags u16
+//                          | image bytes (the rest of the frame, < 64 KiB)
+//                response: id u32 | status u8 | trap u8 | ax bx cx dx sp ip
+//                          flags u16 | instructions u64 | ioPort u16
+//                          | outputs u16 | truncated u8 | outputs x (port u16, value u16)
+//
+//              A connection may send any number of requests without waiting
+//              for the answers (pipelining); responses come back as jobs
+//              finish, not necessarily in order, so clients match them by id.
+//              A malformed frame closes the connection. IN never has data
+//              (status WaitingForInput, ioPort says which port).
+//
+//              rohit-server (server_main.cpp) runs the daemon and
+//              rohit-loadgen (loadgen_main.cpp) measures it.
+
+// ===========================================================================
+// STRUCT: JobRequest / JobResponse
+// One job and its result, decoded.
+// ===========================================================================
+
+struct JobRequest {
+    uint32_t id = 0;               // Echoed in the response
+    uint64_t budget = 0;           // Instruction budget (capped by the server)
+    Registers regs;                // Registers the program starts with
+    std::vector<uint8_t> image;    // Loaded at address 0
+};
+
+struct JobResponse {
+    uint32_t id = 0;
+    RunStatus status = RunStatus::BudgetExhausted;
+    Trap trap = Trap::None;        // Only meaningful when status == Trapped
+    Registers regs;                // Registers when the run stopped
+    uint64_t instructions = 0;     // Instructions executed
+    uint16_t ioPort = 0;           // Port of the IN it waits on (WaitingForInput)
+    bool truncated = false;        // More OUT values than the server keeps
+    std::vector<std::pair<uint16_t, uint16_t>> output;  // (port, value) per OUT, in order
+};
+
+// ===========================================================================
+// NAMESPACE: JobWire
+// Encoding, decoding and framed socket I/O shared by the server and clients.
+// ===========================================================================
+
+namespace JobWire {
+    constexpr size_t REQUEST_HEADER = 4 + 8 + 7 * 2;               // Bytes before the image
+    constexpr size_t RESPONSE_HEADER = 4 + 1 + 1 + 7 * 2 + 8 + 2 + 2 + 1;
+    constexpr size_t MAX_REQUEST = REQUEST_HEADER + Memory::SIZE - 1;
+
+    // Whole frames (length prefix included), appended to 'out'
+    void encode(const JobRequest& request, std::vector<uint8_t>& out);
+    void encode(const JobResponse& response, std::vector<uint8_t>& out);
+
+    // Frame bodies (without the length prefix). False if malformed.
+    bool decode(const uint8_t* body, size_t size, JobRequest& request);
+    bool decode(const uint8_t* body, size_t size, JobResponse& response);
+
+    // ----------- Buffered framed reads from a socket -----------
+    class Reader {
+    public:
+        explicit Reader(int fd) : fd(fd), buffer(1 << 16) {}
+
+        // Next frame body (valid until the next call), or false on EOF, a
+        // socket error or a frame longer than 'maxSize'
+        bool next(const uint8_t*& body, size_t& size, size_t maxSize);
+
+        // A whole frame is already buffered: next() won't touch the socket
+        // (for callers that poll() the socket and must drain the buffer first)
+        bool hasFrame() const;
+
+    private:
+        int fd;
+        std::vector<uint8_t> buffer;
+        size_t begin = 0, end = 0;   // Unconsumed bytes: buffer[begin, end)
+    };
+
+    // Sends all of 'data' (false on error)
+    bool sendAll(int fd, const uint8_t* data, size_t size);
+}
+
+// ===========================================================================
+// CLASS: JobServer
+//
+//     JobServer server;                   // One worker (and VM) per core
+//     server.listenUnix("/tmp/rohit.sock");
+//     server.serve();                     // Until stop() is called
+//
+// Each connection gets a thread that reads its requests and queues them;
+// the workers take jobs from the queue, so one busy client can use every
+// VM. A worker resets its VM between jobs (registers, memory, verified
+// program) instead of building a new one, and verifies each image so
+// proven programs run on the check-free handlers. Given a ResultCache, a
+// job that was already run is answered from it without running anything.
+// ===========================================================================
+
+class JobServer {
+public:
+    static constexpr uint64_t MAX_BUDGET = uint64_t(1) << 32;  // Per job, whatever the request says
+    static constexpr size_t MAX_OUTPUTS = 256;                 // OUT values kept per job
+    static constexpr size_t MAX_QUEUED = 4096;                 // Readers wait when this many jobs are queued
+
+    // workers: 0 = one per hardware thread. results: memoize jobs in it
+    // (nullptr = run every job); must outlive the server.
+    explicit JobServer(size_t workers = 0, ResultCache* results = nullptr);
+    ~JobServer();                             // stop(), then joins every thread
+    JobServer(const JobServer&) = delete;
+    JobServer& operator=(const JobServer&) = delete;
+
+    // Opens the listening socket (false on error, see errno)
+    bool listenUnix(const std::string& path);
+
+    // Accepts connections until stop(). Returns false on a socket error.
+    bool serve();
+
+    // Ends serve() and every connection (any thread; not from a signal handler)
+    void stop();
+
+    // Gets a reused VM ready for one job: reset() and clear() it, copy the
+    // image to address 0, set the registers and verify the image for that
+    // entry state (through ProgramCache::global(), so a program seen before
+    // isn't verified again). Shared with the other transports (RohitRing.hpp).
+    static void prepare(VM& vm, const uint8_t* image, uint16_t size, const Registers& regs);
+
+    // ----------- Statistics -----------
+    std::atomic<uint64_t> jobs{0};                // Jobs run
+    std::atomic<uint64_t> instructions{0};        // Guest instructions run over all jobs (not memoized ones)
+    std::atomic<uint64_t> byStatus[RUN_STATUS_COUNT] = {};   // Jobs per RunStatus
+    std::atomic<uint64_t> connections{0};         // Connections accepted
+    size_t workerCount() const { return workers.size(); }
+
+private:
+    struct Connection;                            // One client (see RohitServer.cpp)
+    struct Job { std::shared_ptr<Connection> connection; JobRequest request; };
+
+    ResultCache* results;                         // nullptr = no memoization
+    int listenFd = -1;
+    std::string unixPath;                         // Removed again in the destructor
+    std::atomic<bool> stopping{false};
+
+    std::mutex lock;                              // Guards everything below
+    std::condition_variable jobReady;             // Workers wait for a job
+    std::condition_variable queueSpace;           // Readers wait for room in the queue
+    std::condition_variable readersDone;          // The destructor waits for the readers
+    std::deque<Job> queue;
+    std::vector<std::weak_ptr<Connection>> clients; // To shut them down in stop()
+    size_t liveReaders = 0;                       // Connection threads (detached) still running
+
+    std::vector<std::thread> workers;
+
+    void work();                                  // Worker thread: owns one VM
+    void read(std::shared_ptr<Connection> connection); // Connection thread
+    void run(VM& vm, const JobRequest& request, JobResponse& response);
+};
@@ -0,0 +1,306 @@
+// RohitSupervisor.cpp
+// This file implements the multi-process batch executor: forking and
+// reaping workers, sharding a batch across them, and the worker loop.
+
+#include "RohitSupervisor.hpp"
+#include <algorithm>         // For std::min / std::max
+#include <cerrno>            // EINTR
+#include <chrono>            // Batch wall time, job timeouts
+#include <csignal>           // kill, SIGKILL
+#include <deque>             // Jobs waiting for a worker
+#include <poll.h>            // poll
+#include <sys/prctl.h>       // PR_SET_PDEATHSIG
+#include <sys/socket.h>      // socketpair
+#include <sys/wait.h>        // waitpid
+#include <thread>            // hardware_concurrency
+#include <unistd.h>          // fork, close, _exit
+
+namespace {
+
+    uint64_t nowMs() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // The job index goes in as the request id: patch the id field of a
+    // frame JobWire::encode just appended (after the 4-byte length)
+    void patchId(std::vector<uint8_t>& frame, size_t start, uint32_t id) {
+        for (int i = 0; i < 4; ++i) frame[start + 4 + i] = static_cast<uint8_t>(id >> (8 * i));
+    }
+
+}
+
+// ---------------------------------------------------------------------------
+// Function: BatchSupervisor::BatchSupervisor
+// Purpose: Forks the worker processes
+BatchSupervisor::BatchSupervisor(const Options& opts) : options(opts) {
+    size_t count = options.workers ? options.workers : std::max(1u, std::thread::hardware_concurrency());
+    options.depth = std::min(std::max<size_t>(options.depth, 1), MAX_DEPTH);
+    options.maxAttempts = std::max(options.maxAttempts, 1u);
+    workers.resize(count);
+    for (Worker& worker : workers) spawn(worker);
+}
+
+// ---------------------------------------------------------------------------
+// Function: BatchSupervisor::~BatchSupervisor
+// Purpose: Closing the sockets makes every worker exit on its own
+BatchSupervisor::~BatchSupervisor() {
+    for (Worker& worker : workers) {
+        if (worker.fd >= 0) close(worker.fd);
+        worker.fd = -1;
+    }
+    for (Worker& worker : workers) {
+        if (worker.pid > 0) waitpid(worker.pid, nullptr, 0);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Function: BatchSupervisor::spawn
+bool BatchSupervisor::spawn(Worker& worker) {
+    int pair[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, pair) != 0) return false;
+    const pid_t parent = getpid();
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(pair[0]);
+        close(pair[1]);
+        return false;
+    }
+    if (pid == 0) {
+        // Die with the supervisor, even if it is killed before it can reap us
+        prctl(PR_SET_PDEATHSIG, SIGKILL);
+        if (getppid() != parent) _exit(1);
+        close(pair[0]);
+        for (Worker& other : workers) {
+            if (other.fd >= 0) close(other.fd);   // Other workers' sockets stay theirs alone
+        }
+        serveChild(pair[1]);
+    }
+    close(pair[1]);
+    worker.pid = pid;
+    worker.fd = pair[0];
+    worker.reader.reset(new JobWire::Reader(pair[0]));
+    worker.inFlight.clear();
+    worker.output.clear();
+    worker.outputSent = 0;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Function: BatchSupervisor::reap
+// Purpose: Gets rid of a worker that died or misbehaved
+void BatchSupervisor::reap(Worker& worker) {
+    if (worker.fd >= 0) close(worker.fd);
+    worker.fd = -1;
+    worker.reader.reset();
+    if (worker.pid > 0) {
+        kill(worker.pid, SIGKILL);    // Usually dead already
+        while (waitpid(worker.pid, nullptr, 0) < 0 && errno == EINTR) {}
+    }
+    worker.pid = -1;
+}
+
+// ---------------------------------------------------------------------------
+// Function: BatchSupervisor::flush
+// Purpose: Requests go out with MSG_DONTWAIT: a worker stuck on a job stops
+// reading, and a blocking send to it would stall the whole batch (and the
+// timeout that is meant to kill it). Reads stay blocking; they only happen
+// once poll() says a response is there.
+bool BatchSupervisor::flush(Worker& worker) {
+    while (worker.outputSent < worker.output.size()) {
+        ssize_t sent = send(worker.fd, worker.output.data() + worker.outputSent,
+                            worker.output.size() - worker.outputSent, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;   // POLLOUT tells us when
+        if (sent <= 0) return false;
+        worker.outputSent += static_cast<size_t>(sent);
+    }
+    worker.output.clear();
+    worker.outputSent = 0;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Function: BatchSupervisor::serveChild
+// Purpose: A worker process: runs the jobs that arrive on 'fd' one after
+// the other on one reused VM and answers each in order. Each response is
+// sent before the next job starts: one held back would make the
+// supervisor blame the wrong job if that next job crashed us.
+void BatchSupervisor::serveChild(int fd) {
+    VM vm;
+    vm.memory.clear();
+    JobRequest request;
+    JobResponse response;
+    std::vector<uint8_t> frame;
+    vm.onOutput = [&](uint16_t port, uint16_t value) {
+        if (response.output.size() < JobServer::MAX_OUTPUTS) response.output.emplace_back(port, value);
+        else response.truncated = true;
+    };
+
+    JobWire::Reader reader(fd);
+    const uint8_t* body;
+    size_t size;
+    while (reader.next(body, size, JobWire::MAX_REQUEST) && JobWire::decode(body, size, request)) {
+        if (options.beforeJob) options.beforeJob(request);
+
+        response.id = request.id;
+        response.output.clear();
+        response.truncated = false;
+        JobServer::prepare(vm, request.image.data(), static_cast<uint16_t>(request.image.size()), request.regs);
+        response.status = vm.run(std::min(request.budget, JobServer::MAX_BUDGET));
+        response.trap = vm.trap;
+        response.regs = vm.cpu.r;
+        response.instructions = vm.instructionsExecuted;
+        response.ioPort = response.status == RunStatus::WaitingForInput ? vm.ioPort : 0;
+
+        frame.clear();
+        JobWire::encode(response, frame);
+        if (!JobWire::sendAll(fd, frame.data(), frame.size())) break;
+    }
+    _exit(0);
+}
+
+// ---------------------------------------------------------------------------
+// Function: BatchSupervisor::run
+// Purpose: Keeps every live worker 'depth' jobs deep until the batch is
+// done, replacing workers that die along the way
+BatchResult BatchSupervisor::run(const std::vector<JobRequest>& batch) {
+    BatchResult result;
+    const size_t n = batch.size();
+    result.responses.resize(n);
+    result.failed.assign(n, 0);
+    result.workers.resize(workers.size());
+
+    std::vector<unsigned> attempts(n, 0);   // Workers each job has killed
+    std::deque<uint32_t> pending;
+    size_t remaining = n;
+    for (size_t i = 0; i < n; ++i) {
+        if (batch[i].image.size() < Memory::SIZE) {
+            pending.push_back(static_cast<uint32_t>(i));
+        } else {
+            result.failed[i] = 1;   // A worker would only drop the connection over it
+            remaining--;
+        }
+    }
+    const auto start = std::chrono::steady_clock::now();
+
+    // A worker died (or has to go): the job it was running is charged an
+    // attempt and retried last; the ones queued behind it go back first
+    auto lose = [&](size_t w) {
+        Worker& worker = workers[w];
+        reap(worker);
+        result.crashes++;
+        result.workers[w].crashes++;
+        for (size_t i = worker.inFlight.size(); i-- > 1;) {
+            pending.push_front(worker.inFlight[i]);
+            result.requeued++;
+        }
+        if (!worker.inFlight.empty()) {
+            uint32_t culprit = worker.inFlight.front();
+            if (++attempts[culprit] >= options.maxAttempts) {
+                result.failed[culprit] = 1;
+                remaining--;
+            } else {
+                pending.push_back(culprit);
+                result.requeued++;
+            }
+        }
+        worker.inFlight.clear();
+        if (restartCount < options.maxRestarts) {
+            restartCount++;
+            spawn(worker);
+        }
+    };
+
+    std::vector<pollfd> polls;
+    std::vector<size_t> polled;   // Worker index of each entry in 'polls'
+    JobResponse response;
+    while (remaining > 0) {
+        // ----------- Top every live worker up to 'depth' jobs -----------
+        bool anyLive = false;
+        for (size_t w = 0; w < workers.size(); ++w) {
+            Worker& worker = workers[w];
+            if (worker.pid < 0) continue;
+            anyLive = true;
+            if (worker.inFlight.empty()) worker.lastProgress = nowMs();
+            std::vector<uint8_t>& out = worker.output;
+            if (worker.outputSent) {
+                out.erase(out.begin(), out.begin() + static_cast<ptrdiff_t>(worker.outputSent));
+                worker.outputSent = 0;
+            }
+            while (worker.inFlight.size() < options.depth && !pending.empty()) {
+                uint32_t index = pending.front();
+                pending.pop_front();
+                size_t at = out.size();
+                JobWire::encode(batch[index], out);
+                patchId(out, at, index);
+                worker.inFlight.push_back(index);
+            }
+            if (!flush(worker)) lose(w);
+        }
+        if (!anyLive) {
+            // Every slot is out of restarts: nothing can run what's left
+            for (uint32_t index : pending) result.failed[index] = 1;
+            remaining -= pending.size();
+            pending.clear();
+            break;
+        }
+
+        // ----------- Wait for responses (or a timeout) -----------
+        polls.clear();
+        polled.clear();
+        for (size_t w = 0; w < workers.size(); ++w) {
+            if (workers[w].pid < 0 || workers[w].inFlight.empty()) continue;
+            short events = POLLIN;
+            if (workers[w].outputSent < workers[w].output.size()) events |= POLLOUT;
+            polls.push_back({workers[w].fd, events, 0});
+            polled.push_back(w);
+        }
+        if (polls.empty()) continue;   // Replacements just spawned: feed them first
+        int timeout = options.jobTimeoutMs ? static_cast<int>(options.jobTimeoutMs) : -1;
+        int ready = poll(polls.data(), polls.size(), timeout);
+
+        for (size_t p = 0; p < polls.size() && ready > 0; ++p) {
+            if (!polls[p].revents) continue;
+            size_t w = polled[p];
+            Worker& worker = workers[w];
+            if ((polls[p].revents & POLLOUT) && !flush(worker)) {
+                lose(w);
+                continue;
+            }
+            if (!(polls[p].revents & (POLLIN | POLLHUP | POLLERR))) continue;   // Only room to send
+            const uint8_t* body;
+            size_t size;
+            do {
+                // In order: the answer must be for the oldest job sent
+                if (!worker.reader->next(body, size, size_t(1) << 20) || !JobWire::decode(body, size, response) ||
+                    worker.inFlight.empty() || response.id != worker.inFlight.front()) {
+                    lose(w);
+                    break;
+                }
+                worker.inFlight.erase(worker.inFlight.begin());
+                worker.lastProgress = nowMs();
+                result.workers[w].jobs++;
+                result.workers[w].instructions += response.instructions;
+                result.completed++;
+                remaining--;
+                std::swap(result.responses[response.id], response);
+            } while (worker.reader->hasFrame());
+        }
+
+        // ----------- Kill workers stuck on one job -----------
+        if (options.jobTimeoutMs) {
+            uint64_t now = nowMs();
+            for (size_t w = 0; w < workers.size(); ++w) {
+                Worker& worker = workers[w];
+                if (worker.pid > 0 && !worker.inFlight.empty() && now - worker.lastProgress > options.jobTimeoutMs)
+                    lose(w);
+            }
+        }
+    }
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for (BatchResult::Worker& w : result.workers)
+        w.jobsPerSecond = result.seconds > 0 ? w.jobs / result.seconds : 0;
+    return result;
+}
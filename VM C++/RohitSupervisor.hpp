@@ -0,0 +1,120 @@
+// RohitSupervisor.hpp
+#pragma once  // Ensures this header is only included once during compilation
+
+#include <cstdint>      // For fixed-width integer types like uint16_t
+#include <functional>   // The per-job hook run inside the workers
+#include <memory>       // Frame readers
+#include <sys/types.h>  // pid_t
+#include <vector>       // Jobs, results, workers
+
+#include "RohitServer.hpp"  // JobRequest / JobResponse / JobWire
+
+// ===========================================================================
+// Author: Rohit Yadav
+// Description: Multi-process batch executor.
+//              JobServer and RingWorkers run every VM in one process: a
+//              trap is contained, but a crash in the host code (a bad
+//              native extension, a stray pointer) takes every VM down with
+//              it. BatchSupervisor forks N worker processes instead and
+//              shards a batch of jobs across them over socket pairs, using
+//              the same framed wire format as the job server (JobWire).
+//
+//              Each worker keeps a few jobs in flight and runs them in the
+//              order they were sent, so when one dies the job at the front
+//              of its queue is the one that killed it. The supervisor reaps
+//              it, forks a replacement and queues the dead worker's jobs
+//              again; only the front job is charged an attempt, and a job
+//              that has killed 'maxAttempts' workers is reported as failed
+//              instead of being retried forever. A worker that sits on a job
+//              for longer than 'jobTimeoutMs' is killed and handled the same
+//              way.
+//
+//              Workers live as long as the supervisor, so their VMs stay
+//              warm across batches. They die with it too (PR_SET_PDEATHSIG).
+//              Linux only. Fork from a process without other threads (the
+//              children carry on with a copy of the parent's memory, locks
+//              included), e.g. before starting any thread pools.
+
+// ===========================================================================
+// STRUCT: BatchResult
+// What run() returns: one response per job (same order as the batch) and
+// how each worker slot did.
+// ===========================================================================
+
+struct BatchResult {
+    struct Worker {
+        uint64_t jobs = 0;            // Jobs this slot answered (any of its processes)
+        uint64_t instructions = 0;    // Guest instructions in those jobs
+        uint64_t crashes = 0;         // Processes in this slot that died or were killed
+        double jobsPerSecond = 0;     // jobs / the batch's wall time
+    };
+
+    std::vector<JobResponse> responses;   // responses[i] answers batch[i] (id = i)
+    std::vector<uint8_t> failed;          // 1: batch[i] kept killing workers, responses[i] is empty
+    std::vector<Worker> workers;
+    uint64_t completed = 0;               // Jobs with a response
+    uint64_t crashes = 0;                 // Worker processes lost over the whole batch
+    uint64_t requeued = 0;                // Jobs sent again after their worker died
+    double seconds = 0;                   // Wall time of the batch
+};
+
+// ===========================================================================
+// CLASS: BatchSupervisor
+//
+//     BatchSupervisor::Options options;
+//     options.workers = 8;
+//     BatchSupervisor supervisor(options);
+//     BatchResult result = supervisor.run(jobs);   // Blocks until every job is answered or failed
+// ===========================================================================
+
+class BatchSupervisor {
+public:
+    struct Options {
+        size_t workers = 0;            // Worker processes (0 = one per hardware thread)
+        size_t depth = 8;              // Jobs in flight per worker (at most MAX_DEPTH)
+        unsigned maxAttempts = 3;      // Worker deaths a job may cause before it fails
+        unsigned jobTimeoutMs = 0;     // Kill a worker stuck this long on one job (0 = never)
+        uint64_t maxRestarts = 1000;   // Processes forked to replace dead ones, over the supervisor's life
+
+        // Runs in the worker process before each job (testing: inject crashes)
+        std::function<void(const JobRequest&)> beforeJob;
+    };
+
+    // Bounded so responses in flight always fit in the socket buffers (a
+    // worker never blocks writing while the supervisor is busy elsewhere).
+    // Requests never block the supervisor: what a worker's socket won't
+    // take yet waits in that worker's output buffer.
+    static constexpr size_t MAX_DEPTH = 64;
+
+    explicit BatchSupervisor(const Options& options);
+    ~BatchSupervisor();   // Closes every worker's socket and reaps them
+    BatchSupervisor(const BatchSupervisor&) = delete;
+    BatchSupervisor& operator=(const BatchSupervisor&) = delete;
+
+    // Runs every job (ids are replaced by the job's index) and returns once
+    // each has a response or has failed. Images must be below 64 KiB.
+    BatchResult run(const std::vector<JobRequest>& batch);
+
+    size_t workerCount() const { return workers.size(); }
+    uint64_t restarts() const { return restartCount; }
+
+private:
+    struct Worker {
+        pid_t pid = -1;                // -1: no process (fork failed or restarts used up)
+        int fd = -1;                   // Supervisor's end of the socket pair
+        std::unique_ptr<JobWire::Reader> reader;
+        std::vector<uint32_t> inFlight;   // Job indexes, in the order they were sent
+        std::vector<uint8_t> output;   // Request frames the socket hasn't taken yet
+        size_t outputSent = 0;         // Bytes at the front of 'output' already sent
+        uint64_t lastProgress = 0;     // Milliseconds (monotonic) of the last send/response
+    };
+
+    Options options;
+    std::vector<Worker> workers;
+    uint64_t restartCount = 0;
+
+    bool spawn(Worker& worker);        // Forks a process for the slot
+    void reap(Worker& worker);         // Closes the socket, kills and waits for the process
+    bool flush(Worker& worker);        // Sends what the socket takes without blocking (false: worker gone)
+    [[noreturn]] void serveChild(int fd);   // Body of a worker process
+};
@@ -4,6 +4,404 @@
 // printing memory contents in hex format, and converting IP addresses to readable form.
 
 #include "RohitUtils.hpp"
+#include <atomic>       // The dispatch pointers (set once, from any thread)
+
+#if defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__))
+#define ROHIT_X86_SIMD 1
+#include <immintrin.h>  // SSE2 / AVX2 intrinsics
+#endif
+
+// ---------------------------------------------------------------------------
+// The copy/zero kernels. Each set handles overlap the same way: when dst is
+// below src it copies forwards, otherwise backwards, and every block is
+// loaded before it is stored, so an overlapping copy reads each byte before
+// anything overwrites it (memmove semantics).
+// ---------------------------------------------------------------------------
+namespace {
+
+    using CopyFn = void (*)(int8*, const int8*, size_t);
+    using ZeroFn = void (*)(int8*, size_t);
+
+    // -------------------------------
+    // Scalar kernels (any CPU; also the tails of the SIMD ones)
+    void copyScalar(int8* dst, const int8* src, size_t size) {
+        if (dst < src) {
+            for (size_t i = 0; i < size; ++i) dst[i] = src[i];     // Forwards
+        } else if (dst > src) {
+            for (size_t i = size; i > 0; --i) dst[i - 1] = src[i - 1]; // Backwards
+        }
+    }
+
+    void zeroScalar(int8* str, size_t size) {
+        for (size_t i = 0; i < size; ++i) str[i] = 0;
+    }
+
+#ifdef ROHIT_X86_SIMD
+    // -------------------------------
+    // The SIMD kernels store whole vectors to aligned addresses (a store
+    // that splits a cache line costs twice as much). The ragged ends are
+    // one unaligned vector each, which may overlap the aligned part. That
+    // re-reads source bytes the aligned stores may already have written,
+    // so it's only done when dst and src are at least a vector apart;
+    // closer overlapping blocks take the scalar loop.
+    // -------------------------------
+    inline size_t distance(const int8* a, const int8* b) {
+        return a < b ? size_t(b - a) : size_t(a - b);
+    }
+
+    // -------------------------------
+    // SSE2 kernels: 64 bytes (four 16-byte registers) per iteration
+    void copySSE2(int8* dst, const int8* src, size_t size) {
+        if (size < 16 || distance(dst, src) < 16) return copyScalar(dst, src, size);
+        const __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+        const __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + size - 16));
+
+        if (dst < src) {
+            size_t i = 16 - (reinterpret_cast<uintptr_t>(dst) & 15);   // First aligned store
+            for (; i + 64 <= size; i += 64) {
+                __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 16));
+                __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 32));
+                __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 48));
+                _mm_store_si128(reinterpret_cast<__m128i*>(dst + i), a);
+                _mm_store_si128(reinterpret_cast<__m128i*>(dst + i + 16), b);
+                _mm_store_si128(reinterpret_cast<__m128i*>(dst + i + 32), c);
+                _mm_store_si128(reinterpret_cast<__m128i*>(dst + i + 48), d);
+            }
+            for (; i + 16 <= size; i += 16)
+                _mm_store_si128(reinterpret_cast<__m128i*>(dst + i),
+                                _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+        } else {
+            size_t n = size - (reinterpret_cast<uintptr_t>(dst + size) & 15); // End of the last aligned store
+            for (; n >= 64; n -= 64) {
+                __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + n - 16));
+                __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + n - 32));
+                __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + n - 48));
+                __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + n - 64));
+                _mm_store_si128(reinterpret_cast<__m128i*>(dst + n - 16), a);
+                _mm_store_si128(reinterpret_cast<__m128i*>(dst + n - 32), b);
+                _mm_store_si128(reinterpret_cast<__m128i*>(dst + n - 48), c);
+                _mm_store_si128(reinterpret_cast<__m128i*>(dst + n - 64), d);
+            }
+            for (; n >= 16; n -= 16)
+                _mm_store_si128(reinterpret_cast<__m128i*>(dst + n - 16),
+                                _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + n - 16)));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), head);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + size - 16), tail);
+    }
+
+    void zeroSSE2(int8* str, size_t size) {
+        if (size < 16) return zeroScalar(str, size);
+        const __m128i z = _mm_setzero_si128();
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(str), z);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(str + size - 16), z);
+        size_t i = 16 - (reinterpret_cast<uintptr_t>(str) & 15);
+        for (; i + 64 <= size; i += 64) {
+            _mm_store_si128(reinterpret_cast<__m128i*>(str + i), z);
+            _mm_store_si128(reinterpret_cast<__m128i*>(str + i + 16), z);
+            _mm_store_si128(reinterpret_cast<__m128i*>(str + i + 32), z);
+            _mm_store_si128(reinterpret_cast<__m128i*>(str + i + 48), z);
+        }
+        for (; i + 16 <= size; i += 16) _mm_store_si128(reinterpret_cast<__m128i*>(str + i), z);
+    }
+
+    // -------------------------------
+    // AVX2 kernels: 128 bytes (four 32-byte registers) per iteration.
+    // Compiled for AVX2 whatever the build flags say; only called after
+    // the CPU check.
+    __attribute__((target("avx2")))
+    void copyAVX2(int8* dst, const int8* src, size_t size) {
+        if (size < 32 || distance(dst, src) < 32) return copySSE2(dst, src, size);
+        const __m256i head = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+        const __m256i tail = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + size - 32));
+
+        if (dst < src) {
+            size_t i = 32 - (reinterpret_cast<uintptr_t>(dst) & 31);
+            for (; i + 128 <= size; i += 128) {
+                __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+                __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 32));
+                __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 64));
+                __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 96));
+                _mm256_store_si256(reinterpret_cast<__m256i*>(dst + i), a);
+                _mm256_store_si256(reinterpret_cast<__m256i*>(dst + i + 32), b);
+                _mm256_store_si256(reinterpret_cast<__m256i*>(dst + i + 64), c);
+                _mm256_store_si256(reinterpret_cast<__m256i*>(dst + i + 96), d);
+            }
+            for (; i + 32 <= size; i += 32)
+                _mm256_store_si256(reinterpret_cast<__m256i*>(dst + i),
+                                   _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)));
+        } else {
+            size_t n = size - (reinterpret_cast<uintptr_t>(dst + size) & 31);
+            for (; n >= 128; n -= 128) {
+                __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + n - 32));
+                __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + n - 64));
+                __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + n - 96));
+                __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + n - 128));
+                _mm256_store_si256(reinterpret_cast<__m256i*>(dst + n - 32), a);
+                _mm256_store_si256(reinterpret_cast<__m256i*>(dst + n - 64), b);
+                _mm256_store_si256(reinterpret_cast<__m256i*>(dst + n - 96), c);
+                _mm256_store_si256(reinterpret_cast<__m256i*>(dst + n - 128), d);
+            }
+            for (; n >= 32; n -= 32)
+                _mm256_store_si256(reinterpret_cast<__m256i*>(dst + n - 32),
+                                   _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + n - 32)));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), head);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + size - 32), tail);
+        _mm256_zeroupper(); // Avoid the AVX-SSE transition penalty in the caller
+    }
+
+    __attribute__((target("avx2")))
+    void zeroAVX2(int8* str, size_t size) {
+        if (size < 32) return zeroSSE2(str, size);
+        const __m256i z = _mm256_setzero_si256();
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(str), z);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(str + size - 32), z);
+        size_t i = 32 - (reinterpret_cast<uintptr_t>(str) & 31);
+        for (; i + 128 <= size; i += 128) {
+            _mm256_store_si256(reinterpret_cast<__m256i*>(str + i), z);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(str + i + 32), z);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(str + i + 64), z);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(str + i + 96), z);
+        }
+        for (; i + 32 <= size; i += 32) _mm256_store_si256(reinterpret_cast<__m256i*>(str + i), z);
+        _mm256_zeroupper();
+    }
+#endif // ROHIT_X86_SIMD
+
+    // -------------------------------
+    // Hex formatting kernels (tohex without a delimiter). 'digits' holds
+    // both hex digits of every byte, high one first, so the table kernel
+    // writes one 2-byte entry per byte; 'text' is the byte in hexdump's
+    // text column.
+    // -------------------------------
+    using HexFn = void (*)(char*, const int8*, size_t);
+
+    struct HexTable {
+        char digits[256][2];
+        char text[256];
+        constexpr HexTable() : digits(), text() {
+            for (int i = 0; i < 256; ++i) {
+                digits[i][0] = "0123456789abcdef"[i >> 4];
+                digits[i][1] = "0123456789abcdef"[i & 15];
+                text[i] = i >= 0x20 && i < 0x7f ? static_cast<char>(i) : '.';
+            }
+        }
+    };
+    constexpr HexTable hexTable;
+
+    // -------------------------------
+    // Decimal text of every octet for todotted: up to three digits plus
+    // the number of them that count
+    struct DecimalOctet { char digits[3] = {}; uint8_t length = 0; };
+
+    struct DecimalTable {
+        DecimalOctet octets[256];
+        constexpr DecimalTable() : octets() {
+            for (int i = 0; i < 256; ++i) {
+                int n = 0;
+                if (i >= 100) octets[i].digits[n++] = static_cast<char>('0' + i / 100);
+                if (i >= 10) octets[i].digits[n++] = static_cast<char>('0' + i / 10 % 10);
+                octets[i].digits[n++] = static_cast<char>('0' + i % 10);
+                octets[i].length = static_cast<uint8_t>(n);
+            }
+        }
+    };
+    constexpr DecimalTable decimalTable;
+
+    void hexScalar(char* out, const int8* str, size_t size) {
+        for (size_t i = 0; i < size; ++i) memcpy(out + 2 * i, hexTable.digits[str[i]], 2);
+    }
+
+#ifdef ROHIT_X86_SIMD
+    // SSE2 has no byte shuffle, so the digits are computed: nibble + '0',
+    // plus 39 more ('a' - '0' - 10) for nibbles above 9
+    inline __m128i hexDigitsSSE2(__m128i nibbles) {
+        __m128i letters = _mm_and_si128(_mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9)), _mm_set1_epi8(39));
+        return _mm_add_epi8(_mm_add_epi8(nibbles, _mm_set1_epi8('0')), letters);
+    }
+
+    void hexSSE2(char* out, const int8* str, size_t size) {
+        const __m128i low = _mm_set1_epi8(0x0f);
+        size_t i = 0;
+        for (; i + 16 <= size; i += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i));
+            __m128i hi = hexDigitsSSE2(_mm_and_si128(_mm_srli_epi16(v, 4), low));
+            __m128i lo = hexDigitsSSE2(_mm_and_si128(v, low));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i), _mm_unpacklo_epi8(hi, lo));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i + 16), _mm_unpackhi_epi8(hi, lo));
+        }
+        hexScalar(out + 2 * i, str + i, size - i);
+    }
+
+    // AVX2: widen 16 bytes to 16-bit lanes holding (high nibble, low nibble)
+    // and look both digits up with one byte shuffle: 16 bytes -> 32 chars
+    __attribute__((target("avx2")))
+    void hexAVX2(char* out, const int8* str, size_t size) {
+        const __m256i digits = _mm256_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7',
+                                                '8', '9', 'a', 'b', 'c', 'd', 'e', 'f',
+                                                '0', '1', '2', '3', '4', '5', '6', '7',
+                                                '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+        const __m256i low = _mm256_set1_epi16(0x0f);
+        size_t i = 0;
+        for (; i + 16 <= size; i += 16) {
+            __m256i w = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i)));
+            __m256i pairs = _mm256_or_si256(_mm256_srli_epi16(w, 4), _mm256_slli_epi16(_mm256_and_si256(w, low), 8));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 2 * i), _mm256_shuffle_epi8(digits, pairs));
+        }
+        _mm256_zeroupper();
+        hexScalar(out + 2 * i, str + i, size - i);
+    }
+#endif // ROHIT_X86_SIMD
+
+    // -------------------------------
+    // Byte-swap kernels: 'count' elements of 2, 4 or 8 bytes from src to
+    // dst (the same buffer, or two that don't overlap). The scalar ones
+    // compile to one rol/bswap per element.
+    // -------------------------------
+    using SwapFn = void (*)(int8*, const int8*, size_t);
+
+    template <typename T>
+    void swapScalar(int8* dst, const int8* src, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            T v;
+            memcpy(&v, src + i * sizeof(T), sizeof(T));
+            if constexpr (sizeof(T) == 2) v = __builtin_bswap16(v);
+            if constexpr (sizeof(T) == 4) v = __builtin_bswap32(v);
+            if constexpr (sizeof(T) == 8) v = __builtin_bswap64(v);
+            memcpy(dst + i * sizeof(T), &v, sizeof(T));
+        }
+    }
+
+#ifdef ROHIT_X86_SIMD
+    // SSE2 has no byte shuffle: swap the 16-bit halves with word shuffles,
+    // then the bytes inside each half with shifts
+    template <int Width>
+    inline __m128i swapSSE2(__m128i v) {
+        if constexpr (Width == 4) {
+            v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0xB1), 0xB1);   // 1 0 3 2
+        } else if constexpr (Width == 8) {
+            v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0x1B), 0x1B);   // 3 2 1 0
+        }
+        return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+    }
+
+    template <typename T>
+    void swapSSE2Kernel(int8* dst, const int8* src, size_t count) {
+        constexpr size_t PER = 16 / sizeof(T);   // Elements per vector
+        size_t i = 0;
+        for (; i + PER <= count; i += PER) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * sizeof(T)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * sizeof(T)), swapSSE2<sizeof(T)>(v));
+        }
+        swapScalar<T>(dst + i * sizeof(T), src + i * sizeof(T), count - i);
+    }
+
+    // AVX2: one pshufb per 32 bytes, 64 bytes per iteration
+    template <typename T>
+    __attribute__((target("avx2")))
+    void swapAVX2Kernel(int8* dst, const int8* src, size_t count) {
+        const __m256i order = sizeof(T) == 2
+            ? _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+                               1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14)
+            : sizeof(T) == 4
+            ? _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                               3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12)
+            : _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+                               7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+        constexpr size_t PER = 32 / sizeof(T);
+        size_t i = 0;
+        for (; i + 2 * PER <= count; i += 2 * PER) {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * sizeof(T)));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * sizeof(T) + 32));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * sizeof(T)), _mm256_shuffle_epi8(a, order));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * sizeof(T) + 32), _mm256_shuffle_epi8(b, order));
+        }
+        for (; i + PER <= count; i += PER) {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * sizeof(T)));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * sizeof(T)), _mm256_shuffle_epi8(a, order));
+        }
+        _mm256_zeroupper();
+        swapScalar<T>(dst + i * sizeof(T), src + i * sizeof(T), count - i);
+    }
+#endif // ROHIT_X86_SIMD
+
+    // -------------------------------
+    // Dispatch. The pointers start at resolvers, so the first call (even
+    // one from another file's static initializer) picks the kernels.
+    void copyResolve(int8* dst, const int8* src, size_t size);
+    void zeroResolve(int8* str, size_t size);
+    void hexResolve(char* out, const int8* str, size_t size);
+    template <typename T> void swapResolve(int8* dst, const int8* src, size_t count);
+
+    std::atomic<CopyFn> copyImpl{copyResolve};
+    std::atomic<ZeroFn> zeroImpl{zeroResolve};
+    std::atomic<HexFn> hexImpl{hexResolve};
+    std::atomic<SwapFn> swapImpl[3] = {{swapResolve<uint16_t>}, {swapResolve<uint32_t>}, {swapResolve<uint64_t>}};
+    std::atomic<RohitUtils::Simd> level{RohitUtils::Simd::Scalar};
+
+    bool supported(RohitUtils::Simd want) {
+        switch (want) {
+            case RohitUtils::Simd::Scalar: return true;
+#ifdef ROHIT_X86_SIMD
+            case RohitUtils::Simd::SSE2:   return __builtin_cpu_supports("sse2");
+            case RohitUtils::Simd::AVX2:   return __builtin_cpu_supports("avx2");
+#endif
+            default: return false;
+        }
+    }
+
+    void select(RohitUtils::Simd want) {
+        CopyFn c = copyScalar;
+        ZeroFn z = zeroScalar;
+        HexFn h = hexScalar;
+        SwapFn sw[3] = {swapScalar<uint16_t>, swapScalar<uint32_t>, swapScalar<uint64_t>};
+#ifdef ROHIT_X86_SIMD
+        if (want == RohitUtils::Simd::AVX2) {
+            c = copyAVX2; z = zeroAVX2; h = hexAVX2;
+            sw[0] = swapAVX2Kernel<uint16_t>; sw[1] = swapAVX2Kernel<uint32_t>; sw[2] = swapAVX2Kernel<uint64_t>;
+        }
+        if (want == RohitUtils::Simd::SSE2) {
+            c = copySSE2; z = zeroSSE2; h = hexSSE2;
+            sw[0] = swapSSE2Kernel<uint16_t>; sw[1] = swapSSE2Kernel<uint32_t>; sw[2] = swapSSE2Kernel<uint64_t>;
+        }
+#endif
+        level.store(want, std::memory_order_relaxed);
+        for (int i = 0; i < 3; ++i) swapImpl[i].store(sw[i], std::memory_order_relaxed);
+        hexImpl.store(h, std::memory_order_relaxed);
+        zeroImpl.store(z, std::memory_order_relaxed);
+        copyImpl.store(c, std::memory_order_relaxed);
+    }
+
+    void selectBest() {
+        if (supported(RohitUtils::Simd::AVX2)) select(RohitUtils::Simd::AVX2);
+        else if (supported(RohitUtils::Simd::SSE2)) select(RohitUtils::Simd::SSE2);
+        else select(RohitUtils::Simd::Scalar);
+    }
+
+    void copyResolve(int8* dst, const int8* src, size_t size) {
+        selectBest();
+        copyImpl.load(std::memory_order_relaxed)(dst, src, size);
+    }
+
+    void zeroResolve(int8* str, size_t size) {
+        selectBest();
+        zeroImpl.load(std::memory_order_relaxed)(str, size);
+    }
+
+    void hexResolve(char* out, const int8* str, size_t size) {
+        selectBest();
+        hexImpl.load(std::memory_order_relaxed)(out, str, size);
+    }
+
+    template <typename T>
+    void swapResolve(int8* dst, const int8* src, size_t count) {
+        selectBest();
+        swapImpl[sizeof(T) == 2 ? 0 : sizeof(T) == 4 ? 1 : 2].load(std::memory_order_relaxed)(dst, src, count);
+    }
+
+} // namespace
 
 // All utility functions are defined inside the RohitUtils namespace
 namespace RohitUtils {
@@ -16,13 +414,12 @@ namespace RohitUtils {
     //   - src: source memory address
     //   - size: number of bytes to copy
     // Why it's here:
-    //   - Useful for copying memory (e.g., stack frames, data blocks) within the VM.
-    //   - Acts like the standard memcpy function but defined manually here for control.
+    //   - Useful for copying memory (e.g., snapshots, data blocks) within the VM.
+    //   - Acts like the standard memmove: overlapping blocks are fine.
     // Helps the code by:
-    //   - Avoiding dependency on external libraries.
-    void copy(int8* dst, const int8* src, int16 size) {
-        for (int16 i = 0; i < size; ++i)
-            dst[i] = src[i];  // Copy byte-by-byte
+    //   - Running the widest kernel the CPU has (see the dispatch above).
+    void copy(int8* dst, const int8* src, size_t size) {
+        copyImpl.load(std::memory_order_relaxed)(dst, src, size);
     }
 
     // -------------------------------
@@ -43,6 +440,30 @@ namespace RohitUtils {
         return (b << 8) | a;               // Swap and combine
     }
 
+    // -------------------------------
+    // Function: bswap16 / bswap32 / bswap64
+    // Purpose: Reverses the bytes of every element of a buffer
+    // Parameters:
+    //   - dst: where the swapped elements go (may be src itself)
+    //   - src: the elements
+    //   - count: number of elements (not bytes)
+    // Why it's here:
+    //   - Network data is big-endian; the VM and most hosts are little-endian.
+    // Helps the code by:
+    //   - Converting whole packet buffers at vector speed (one pshufb per
+    //     32 bytes with AVX2) instead of one value at a time.
+    void bswap16(int8* dst, const int8* src, size_t count) {
+        swapImpl[0].load(std::memory_order_relaxed)(dst, src, count);
+    }
+
+    void bswap32(int8* dst, const int8* src, size_t count) {
+        swapImpl[1].load(std::memory_order_relaxed)(dst, src, count);
+    }
+
+    void bswap64(int8* dst, const int8* src, size_t count) {
+        swapImpl[2].load(std::memory_order_relaxed)(dst, src, count);
+    }
+
     // -------------------------------
     // Function: zero
     // Purpose: Clears (sets to zero) a block of memory
@@ -53,9 +474,77 @@ namespace RohitUtils {
     //   - Useful to initialize memory (e.g., RAM, registers, buffers) before use.
     // Helps the code by:
     //   - Avoiding undefined behavior by making sure all values start from 0.
-    void zero(int8* str, int16 size) {
-        for (int16 i = 0; i < size; ++i)
-            str[i] = 0;
+    void zero(int8* str, size_t size) {
+        zeroImpl.load(std::memory_order_relaxed)(str, size);
+    }
+
+    // -------------------------------
+    // Function: hash64
+    // Purpose: XXH64. Stripes of 32 bytes go through four lanes, which are
+    // then merged; the tail is mixed in 8, 4 and 1 byte at a time and the
+    // result avalanched so every input bit affects every output bit.
+    uint64_t hash64(const int8* str, size_t size, uint64_t seed) {
+        constexpr uint64_t P1 = 0x9E3779B185EBCA87ull, P2 = 0xC2B2AE3D27D4EB4Full, P3 = 0x165667B19E3779F9ull,
+                           P4 = 0x85EBCA77C2B2AE63ull, P5 = 0x27D4EB2F165667C5ull;
+        auto rotl = [](uint64_t x, int r) { return (x << r) | (x >> (64 - r)); };
+        auto read64 = [](const int8* p) { uint64_t v; memcpy(&v, p, 8); return v; };   // Little-endian hosts
+        auto read32 = [](const int8* p) { uint32_t v; memcpy(&v, p, 4); return v; };
+        auto round = [&](uint64_t acc, uint64_t input) { return rotl(acc + input * P2, 31) * P1; };
+        auto merge = [&](uint64_t acc, uint64_t lane) { return (acc ^ round(0, lane)) * P1 + P4; };
+
+        const int8* p = str;
+        const int8* end = str + size;
+        uint64_t h;
+        if (size >= 32) {
+            uint64_t v1 = seed + P1 + P2, v2 = seed + P2, v3 = seed, v4 = seed - P1;
+            for (const int8* limit = end - 32; p <= limit; p += 32) {
+                v1 = round(v1, read64(p));
+                v2 = round(v2, read64(p + 8));
+                v3 = round(v3, read64(p + 16));
+                v4 = round(v4, read64(p + 24));
+            }
+            h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+            h = merge(merge(merge(merge(h, v1), v2), v3), v4);
+        } else {
+            h = seed + P5;
+        }
+        h += size;
+
+        for (; p + 8 <= end; p += 8) h = rotl(h ^ round(0, read64(p)), 27) * P1 + P4;
+        if (p + 4 <= end) {
+            h = rotl(h ^ (read32(p) * P1), 23) * P2 + P3;
+            p += 4;
+        }
+        for (; p < end; ++p) h = rotl(h ^ (*p * P5), 11) * P1;
+
+        h ^= h >> 33;
+        h *= P2;
+        h ^= h >> 29;
+        h *= P3;
+        h ^= h >> 32;
+        return h;
+    }
+
+    // -------------------------------
+    // Function: simd / useSimd / simdName
+    // Purpose: Reports or overrides the kernel set copy() and zero() use
+    Simd simd() {
+        if (copyImpl.load(std::memory_order_relaxed) == copyResolve) selectBest();
+        return level.load(std::memory_order_relaxed);
+    }
+
+    bool useSimd(Simd want) {
+        if (!supported(want)) return false;
+        select(want);
+        return true;
+    }
+
+    const char* simdName(Simd which) {
+        switch (which) {
+            case Simd::SSE2: return "sse2";
+            case Simd::AVX2: return "avx2";
+            default:         return "scalar";
+        }
     }
 
     // -------------------------------
@@ -64,40 +553,123 @@ namespace RohitUtils {
     // Parameters:
     //   - str: pointer to the memory block
     //   - size: number of bytes to print
-    //   - delim: optional character to print between hex bytes (e.g., space or dash)
+    //   - delim: optional character to print after each hex byte (e.g., space or dash)
     // Why it's here:
     //   - Helps in debugging by allowing developers to see the memory contents in readable hex.
     // Helps the code by:
     //   - Allowing the VM to show what's stored in memory in a clean and readable way.
-    void printhex(const int8* str, int16 size, int8 delim) {
-        for (int16 i = 0; i < size; ++i) {
-            printf("%.02x", str[i]);  // Print each byte in 2-digit hex format
-            if (delim)
-                printf("%c", delim);  // Add delimiter between bytes, if specified
-        }
-        printf("\n");
+    void printhex(const int8* str, size_t size, int8 delim) {
+        std::string text(hexSize(size, delim) + 1, '\n');
+        tohex(&text[0], str, size, delim);    // The last char stays '\n'
+        fwrite(text.data(), 1, text.size(), stdout);
         fflush(stdout);  // Force print output immediately (not buffered)
     }
 
+    // -------------------------------
+    // Function: tohex
+    // Purpose: Bytes to hex chars, with the SIMD kernel when there's no delimiter
+    size_t tohex(char* out, const int8* str, size_t size, int8 delim) {
+        if (!delim) {
+            hexImpl.load(std::memory_order_relaxed)(out, str, size);
+            return 2 * size;
+        }
+        for (size_t i = 0; i < size; ++i) {
+            memcpy(out + 3 * i, hexTable.digits[str[i]], 2);
+            out[3 * i + 2] = static_cast<char>(delim);
+        }
+        return 3 * size;
+    }
+
+    // -------------------------------
+    // Function: hexdump
+    // Purpose: xxd-style lines: address, eight groups of two bytes, text
+    size_t hexdump(char* out, const int8* str, size_t size, uint32_t base) {
+        constexpr size_t CHUNK = 4096;       // Bytes converted per tohex() call
+        char hex[2 * CHUNK];
+        char* p = out;
+
+        for (size_t chunk = 0; chunk < size; chunk += CHUNK) {
+            size_t chunkBytes = size - chunk < CHUNK ? size - chunk : CHUNK;
+            tohex(hex, str + chunk, chunkBytes);
+
+            for (size_t line = 0; line < chunkBytes; line += 16) {
+                size_t n = chunkBytes - line < 16 ? chunkBytes - line : 16;
+                uint32_t addr = static_cast<uint32_t>(base + chunk + line);
+
+                // Address: 8 hex digits, most significant first
+                for (int shift = 24; shift >= 0; shift -= 8, p += 2)
+                    memcpy(p, hexTable.digits[(addr >> shift) & 0xff], 2);
+                *p++ = ':';
+                *p++ = ' ';
+
+                // Hex column: always the full width, so the text column lines up
+                const char* h = hex + 2 * line;
+                if (n == 16) {
+                    for (int g = 0; g < 8; ++g, p += 5) {
+                        memcpy(p, h + 4 * g, 4);
+                        p[4] = ' ';
+                    }
+                } else {
+                    for (size_t i = 0; i < 16; ++i) {
+                        if (i < n) memcpy(p, h + 2 * i, 2);
+                        else p[0] = p[1] = ' ';
+                        p += 2;
+                        if (i & 1) *p++ = ' ';      // After each group of two bytes
+                    }
+                }
+                *p++ = ' ';
+
+                // Text column: printable ASCII as is, everything else '.'
+                for (size_t i = 0; i < n; ++i) *p++ = hexTable.text[str[chunk + line + i]];
+                *p++ = '\n';
+            }
+        }
+        return static_cast<size_t>(p - out);
+    }
+
+    // -------------------------------
+    // Function: printdump
+    // Purpose: hexdump to stdout with one write
+    void printdump(const int8* str, size_t size, uint32_t base) {
+        std::string text(dumpSize(size), '\0');
+        text.resize(hexdump(&text[0], str, size, base));
+        fwrite(text.data(), 1, text.size(), stdout);
+        fflush(stdout);
+    }
+
     // -------------------------------
     // Function: todotted
     // Purpose: Converts a 32-bit IP address (in_addr_t) to a human-readable dotted decimal format
-    //          Example: 3232235777 -> "192.168.1.1"
+    //          Example: 0x0101A8C0 -> "192.168.1.1"
     // Parameters:
+    //   - out: where the text goes (DOTTED_SIZE chars)
     //   - ip: IPv4 address as a 32-bit integer
     // Returns:
-    //   - A string representing the IP in dotted-decimal format
+    //   - The length of the text
     // Why it's here:
     //   - Some instructions or debug outputs may involve IP addresses.
     // Helps the code by:
-    //   - Turning low-level binary IP into something human-readable.
+    //   - Turning low-level binary IP into something human-readable,
+    //     without locks or a shared buffer.
+    size_t todotted(char* out, in_addr_t ip) {
+        char* p = out;
+        for (int part = 0; part < 4; ++part) {
+            const DecimalOctet& d = decimalTable.octets[(ip >> (8 * part)) & 0xff];
+            memcpy(p, d.digits, 3);   // Always 3 chars; the next part overwrites the extras
+            p += d.length;
+            *p++ = '.';
+        }
+        *--p = '\0';                  // Replace the last '.'
+        return static_cast<size_t>(p - out);
+    }
+
+    void todotted(char (*out)[DOTTED_SIZE], const in_addr_t* ips, size_t count) {
+        for (size_t i = 0; i < count; ++i) todotted(out[i], ips[i]);
+    }
+
     const char* todotted(in_addr_t ip) {
-        static char buf[16];  // Static buffer to hold the result (enough for "xxx.xxx.xxx.xxx")
-        snprintf(buf, sizeof(buf), "%d.%d.%d.%d",
-            (ip & 0x000000FF),         // Extract lowest byte (1st part of IP)
-            (ip & 0x0000FF00) >> 8,    // 2nd part
-            (ip & 0x00FF0000) >> 16,   // 3rd part
-            (ip & 0xFF000000) >> 24);  // 4th part
+        thread_local char buf[DOTTED_SIZE];  // One buffer per thread (enough for "xxx.xxx.xxx.xxx")
+        todotted(buf, ip);
         return buf;
     }
 
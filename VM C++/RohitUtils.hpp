@@ -3,6 +3,7 @@
 
 // Include standard headers for fixed-width integers and functions
 #include <cstdint>     // For fixed-width integer types like uint8_t, uint16_t
+#include <cstddef>     // For size_t
 #include <string>      // For using string types (if needed in extensions)
 #include <cstdio>      // For printf and related functions
 #include <cstring>     // For basic string/memory manipulation functions
@@ -39,14 +40,18 @@ namespace RohitUtils {
     // Function: copy
     // Description:
     //   - Copies a block of memory from source (src) to destination (dst)
-    //   - Similar to the standard `memcpy()` but manually written
+    //   - Like the standard `memmove()`: the blocks may overlap, and dst
+    //     then ends up with what src held before the call
+    //   - Uses 32-byte AVX2 or 16-byte SSE2 loads/stores when the CPU has
+    //     them (checked once, at the first call), one byte at a time otherwise
     // Parameters:
     //   - dst: pointer to the destination memory block
     //   - src: pointer to the source memory block
-    //   - size: number of bytes to copy
+    //   - size: number of bytes to copy (a whole 64 KiB Memory fits)
     // Why it's useful:
-    //   - Used in VM to copy values between memory regions (e.g., during stack operations)
-    void copy(int8* dst, const int8* src, int16 size);
+    //   - Used in VM to copy values between memory regions (snapshots,
+    //     block moves, copy-on-write pages)
+    void copy(int8* dst, const int8* src, size_t size);
 
     // -------------------------------------------------------------------
     // Function: nstoh (Network Short to Host)
@@ -62,41 +67,144 @@ namespace RohitUtils {
     //     especially if the VM is extended to interact with networks.
     int16 nstoh(int16 srcport);
 
+    // -------------------------------------------------------------------
+    // Function: bswap16 / bswap32 / bswap64
+    // Description:
+    //   - Bulk nstoh: reverses the byte order of 'count' 16/32/64-bit
+    //     elements (big-endian <-> little-endian, either direction)
+    //   - In place when dst == src; otherwise the buffers must not overlap
+    //   - No alignment needed. pshufb with AVX2, word shuffles and shifts
+    //     with SSE2, bswap per element otherwise (same choice as copy())
+    // Parameters:
+    //   - dst: pointer to where the swapped elements go
+    //   - src: pointer to the elements
+    //   - count: number of elements (bytes / 2, 4 or 8)
+    // Why it's useful:
+    //   - Converting whole network packets; also what the guest's
+    //     BSWAP16/32/64 block instructions run.
+    void bswap16(int8* dst, const int8* src, size_t count);
+    void bswap32(int8* dst, const int8* src, size_t count);
+    void bswap64(int8* dst, const int8* src, size_t count);
+
     // -------------------------------------------------------------------
     // Function: zero
     // Description:
     //   - Sets a block of memory to all zeros (0)
+    //   - Same SIMD dispatch as copy()
     // Parameters:
     //   - str: pointer to the memory block
     //   - size: number of bytes to clear
     // Why it's useful:
     //   - Used to initialize or reset parts of memory (RAM, stack, buffers)
     //   - Prevents bugs caused by uninitialized memory.
-    void zero(int8* str, int16 size);
+    void zero(int8* str, size_t size);
+
+    // -------------------------------------------------------------------
+    // Function: hash64
+    // Description:
+    //   - 64-bit hash of a block of memory (the XXH64 algorithm: same
+    //     values as the reference xxHash for the same seed)
+    //   - Four independent multiply-rotate lanes over 32-byte stripes, so it
+    //     runs at several bytes per cycle; no SIMD dispatch needed
+    // Parameters:
+    //   - str: pointer to the memory block
+    //   - size: number of bytes to hash
+    //   - seed: starts the lanes (different seeds give unrelated hashes)
+    // Why it's useful:
+    //   - Content addressing: finding a program image or a memory snapshot
+    //     seen before without comparing it against every candidate.
+    //     Not cryptographic: compare the bytes too before trusting a match.
+    uint64_t hash64(const int8* str, size_t size, uint64_t seed = 0);
+
+    // -------------------------------------------------------------------
+    // Enum: Simd
+    // Description:
+    //   - The kernel sets copy() and zero() can run on
+    // Functions:
+    //   - simd(): the set in use (the best one the CPU supports, unless
+    //     useSimd() picked another)
+    //   - useSimd(level): switches both functions to 'level'; returns false
+    //     (and changes nothing) if the CPU or the build doesn't have it
+    //   - simdName(level): "scalar", "sse2" or "avx2"
+    // Why it's useful:
+    //   - Lets benchmarks and tests run every kernel on the same machine.
+    enum class Simd { Scalar, SSE2, AVX2 };
+    Simd simd();
+    bool useSimd(Simd level);
+    const char* simdName(Simd level);
 
     // -------------------------------------------------------------------
     // Function: printhex
     // Description:
     //   - Prints a memory block as hexadecimal values
     //   - Allows you to see what's inside RAM or registers in a readable format
+    //   - Formats everything with tohex() first, then writes it with one fwrite
     // Parameters:
     //   - str: pointer to the memory block
     //   - size: number of bytes to print
-    //   - delim: optional character to separate hex values (like space, dash, etc.)
+    //   - delim: optional character to print after each hex byte (like space, dash, etc.)
     // Why it's useful:
     //   - Essential for debugging the VM or viewing the memory contents visually.
-    void printhex(const int8* str, int16 size, int8 delim = 0);
+    void printhex(const int8* str, size_t size, int8 delim = 0);
+
+    // -------------------------------------------------------------------
+    // Function: tohex
+    // Description:
+    //   - Writes 'size' bytes as lowercase hex ("0a1b...") into 'out',
+    //     followed by 'delim' after every byte if it isn't 0
+    //   - Without a delimiter, 16 bytes at a time with SSE2 / AVX2 (same
+    //     kernel choice as copy()); otherwise through a 256-entry table
+    //   - 'out' needs hexSize(size, delim) chars; nothing is NUL-terminated
+    // Returns:
+    //   - Number of chars written
+    // Why it's useful:
+    //   - Formats a whole memory image without a single stdio call.
+    size_t tohex(char* out, const int8* str, size_t size, int8 delim = 0);
+    constexpr size_t hexSize(size_t size, int8 delim = 0) { return size * (delim ? 3 : 2); }
+
+    // -------------------------------------------------------------------
+    // Function: hexdump / printdump
+    // Description:
+    //   - The xxd layout: 16 bytes per line, the address of the first one
+    //     (starting at 'base'), the bytes in groups of two, then the bytes
+    //     as text ('.' for anything unprintable):
+    //       00000000: 0805 0009 0300 2002 0000 0000 0000 0000  ...... .........
+    //     (a short last line keeps the hex column width, like xxd)
+    //   - hexdump writes into 'out' (dumpSize(size) chars, no NUL) and
+    //     returns the number of chars written; printdump formats into one
+    //     buffer and writes it to stdout with one fwrite
+    // Why it's useful:
+    //   - Full memory dumps that diff cleanly against `xxd` output.
+    size_t hexdump(char* out, const int8* str, size_t size, uint32_t base = 0);
+    void printdump(const int8* str, size_t size, uint32_t base = 0);
+    constexpr size_t DUMP_LINE = 68; // "aaaaaaaa: " + 8 x "hhhh " + " " + 16 text chars + "\n"
+    constexpr size_t dumpSize(size_t size) { return (size + 15) / 16 * DUMP_LINE; }
 
     // -------------------------------------------------------------------
     // Function: todotted
     // Description:
     //   - Converts a 32-bit IP address into human-readable dotted-decimal format (e.g., "192.168.1.1")
+    //   - The first part is the lowest byte of 'ip' (an in_addr_t in network
+    //     byte order, as sockets hand it out)
+    //   - No snprintf and no shared state: each octet comes from a
+    //     256-entry table of decimal strings, so any number of threads can
+    //     format at once
     // Parameters:
+    //   - out: caller's buffer of at least DOTTED_SIZE chars (NUL-terminated on return)
     //   - ip: 32-bit IP address (in_addr_t)
     // Returns:
-    //   - A pointer to a string that contains the converted IP
+    //   - Length of the text (7 to 15), not counting the NUL
     // Why it's useful:
-    //   - Helpful if the VM is extended to simulate networking features.
+    //   - Helpful if the VM is extended to simulate networking features
+    //     (e.g. logging the peers of network devices from worker threads).
+    constexpr size_t DOTTED_SIZE = 16;   // "255.255.255.255" + NUL
+    size_t todotted(char* out, in_addr_t ip);
+
+    // Bulk version: out[i] receives ips[i], for 'count' addresses
+    void todotted(char (*out)[DOTTED_SIZE], const in_addr_t* ips, size_t count);
+
+    // Older interface: a pointer to a per-thread buffer, overwritten by the
+    // next call on the same thread (other threads don't touch it)
     const char* todotted(in_addr_t ip);
 
 } // namespace RohitUtils
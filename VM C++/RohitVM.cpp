@@ -4,82 +4,179 @@
 // and how memory/registers/stack are handled during runtime.
 
 #include "RohitVM.hpp"   // Include the corresponding header file with class definitions
+#include "RohitVerifier.hpp" // Load-time verifier and the specialized handler set
+#include "RohitProfiler.hpp" // Optional sampling profiler hook
+#include "RohitMMU.hpp"      // Paged memory backend (instantiated below)
 #include <iostream>      // For input/output (e.g., printing to console)
 #include <map>           // Used to map Opcodes to their instruction sizes
+#include <algorithm>     // std::sort (hot blocks)
+#include <sys/mman.h>    // mmap for RohitVM-32 memory
+#include <new>           // std::bad_alloc
 
 // ---------------------------------------------------------------------------
 // Function: VM::execute
 // Purpose: This is the main function that runs the virtual machine.
-// It continuously fetches and executes instructions until it sees a HLT (halt).
-void VM::execute() {
+// It runs the program until it sees a HLT (halt) and prints the final state,
+// or reports the runtime error that stopped it.
+template <typename Word, typename Mem>
+void BasicVM<Word, Mem>::execute() {
+    std::cout << "Starting VM Execution...\n";
+
+    switch (run(UNLIMITED)) {
+        case RunStatus::Halted:
+            printState();
+            std::cout << "Program Halted.\n";
+            break;
+        case RunStatus::Trapped:
+            handleError(trapMessage);
+            break;
+        case RunStatus::WaitingForInput:
+            // Nobody will ever provide the data: execute() can't wait like run() can
+            handleError("No input available on port " + std::to_string(ioPort));
+            break;
+        case RunStatus::Breakpoint:
+            // No debugger attached to continue from it
+            handleError("Breakpoint at address " + std::to_string(cpu.r.ip));
+            break;
+        case RunStatus::WaitingForCode:
+            // Nothing is streaming the rest of the program in
+            handleError("Program not loaded at address " + std::to_string(cpu.r.ip));
+            break;
+        case RunStatus::BudgetExhausted:
+            break; // Not possible with an unlimited budget
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Function: VM::run
+// Purpose: Runs at most 'budget' instructions and returns why it stopped.
+// Errors become RunStatus::Trapped instead of ending the process, so many
+// VMs can be driven from one host thread a slice at a time.
+template <typename Word, typename Mem>
+RunStatus BasicVM<Word, Mem>::run(uint64_t budget) {
+    // Instruction count at which this slice ends (saturating)
+    const uint64_t stopAt = budget > UNLIMITED - instructionsExecuted
+                                ? UNLIMITED : instructionsExecuted + budget;
+
+    // Flags are lazy while we run; the host always finds them in cpu.r.flags
+    struct FlagSync {
+        BasicCPU<Word>& cpu;
+        ~FlagSync() { cpu.materializeFlags(); }
+    } flagSync{cpu};
+
     try {
-        std::cout << "Starting VM Execution...\n";
+        // Verified programs skip the checked fetch-decode loop, as long as we're
+        // starting from a state the proof covers. executeVerified() only
+        // returns false if a RET leaves the code the proof covers; the checked
+        // loop below then carries on from there.
+        if constexpr (IS_16BIT) {
+            size_t pc = 0;
+            bool entered = verified && verifiedEntry(pc);
+            suspendedVerified = false;
+            if (entered) {
+                RunStatus status;
+                if (executeVerified(pc, stopAt, status)) return status;
+            }
+        }
 
-        // Infinite loop to run instructions one after another
-        while (true) {
-            Instruction instr = fetchNextInstruction(); // Fetch next instruction from memory
-            executeInstruction(instr); // Decode and execute that instruction
+        while (instructionsExecuted < stopAt) {
+            Word at = cpu.r.ip;
 
-            // If the instruction is HLT (halt), stop the execution
-            if (instr.op == Opcode::HLT) {
-                std::cout << "Program Halted.\n";
-                break;
+            // Still streaming the program in (one predictable branch when not)
+            if (pendingEnd > pendingBegin && touchesPending(at)) return RunStatus::WaitingForCode;
+
+            // Take a profiler sample when one is due (one predictable branch when off)
+            if (profiler && profiler->due(instructionsExecuted)) profiler->sample(*this);
+
+            InstructionType instr = fetchNextInstruction(); // Fetch next instruction from memory
+            if (!executeInstruction(instr)) {           // Decode and execute that instruction
+                cpu.r.ip = at;                          // IN without data or BRK: stop on it
+                return instr.op == Opcode::BRK ? RunStatus::Breakpoint : RunStatus::WaitingForInput;
             }
+            instructionsExecuted++;
+
+            // If the instruction is HLT (halt), stop the execution
+            if (instr.op == Opcode::HLT) return RunStatus::Halted;
         }
-    } catch (const std::exception& ex) {
-        // Handle any runtime errors and print the error message
-        handleError(ex.what());
+        return RunStatus::BudgetExhausted;
+    } catch (const TrapError& ex) {
+        trap = ex.trap;
+        trapMessage = ex.what();
+        return RunStatus::Trapped;
     }
 }
 
 // ---------------------------------------------------------------------------
 // Function: fetchNextInstruction
 // Purpose: Reads the next instruction from memory and decodes it.
-Instruction VM::fetchNextInstruction() {
-    uint16_t ip = cpu.r.ip; // Get the current instruction pointer
+template <typename Word, typename Mem>
+BasicInstruction<Word> BasicVM<Word, Mem>::fetchNextInstruction() {
+    Word ip = cpu.r.ip; // Get the current instruction pointer
 
     // Read the opcode from memory at IP (Instruction Pointer)
-    Opcode op = static_cast<Opcode>(memory[ip]);
+    Opcode op = static_cast<Opcode>(memory.fetch(ip));
 
     // Get how many bytes this instruction occupies
     uint8_t size = getInstructionSize(op);
 
     // Create a new Instruction object and set the opcode
-    Instruction instr;
+    InstructionType instr;
     instr.op = op;
 
-    // Read the first operand if instruction size >= 2
-    if (size >= 2) {
-        instr.a1 = memory[ip + 1] | (memory[ip + 2] << 8); // Combine two bytes into a 16-bit value
+    // Read the first operand if the instruction has one (one word, little-endian)
+    if (size >= 1 + sizeof(Word)) {
+        instr.a1 = readWord(static_cast<Word>(ip + 1), true);
     }
 
-    // Read the second operand if size == 5 (not used in this current instruction set, but future-proof)
-    if (size == 5) {
-        instr.a2 = memory[ip + 3] | (memory[ip + 4] << 8);
+    // Read the second operand (IN/OUT)
+    if (size == 1 + 2 * sizeof(Word)) {
+        instr.a2 = readWord(static_cast<Word>(ip + 1 + sizeof(Word)), true);
     }
 
     cpu.r.ip += size; // Move the instruction pointer forward
     return instr;     // Return the decoded instruction
 }
 
+// ---------------------------------------------------------------------------
+// Function: readWord
+// Purpose: Combines sizeof(Word) bytes (little-endian) into one value.
+// Addresses wrap around at the word size, like IP and SP do. Operands of
+// instructions are read as fetches (execute permission), the rest as loads.
+template <typename Word, typename Mem>
+Word BasicVM<Word, Mem>::readWord(Word addr, bool fetch) {
+    Word val = 0;
+    for (size_t i = 0; i < sizeof(Word); ++i) {
+        Word a = static_cast<Word>(addr + i);
+        val |= static_cast<Word>(fetch ? memory.fetch(a) : memory.load(a)) << (8 * i);
+    }
+    return val;
+}
+
+// ---------------------------------------------------------------------------
+// Function: defaultMemory
+// Purpose: The memory a default-constructed VM gets
+template <typename Word, typename Mem>
+Mem BasicVM<Word, Mem>::defaultMemory() {
+    if constexpr (std::is_same_v<Mem, PagedMemory>)
+        return PagedMemory(size_t(1) << (8 * sizeof(Word)));  // Costs nothing until touched
+    else
+        return Mem();
+}
+
 // ---------------------------------------------------------------------------
 // Function: executeInstruction
 // Purpose: Executes a decoded instruction by modifying registers, memory, or flags
-void VM::executeInstruction(const Instruction& instr) {
+// Returns false for an IN whose port has no data yet and for BRK (nothing
+// was changed in either case).
+template <typename Word, typename Mem>
+bool BasicVM<Word, Mem>::executeInstruction(const InstructionType& instr) {
     switch (instr.op) {
         case Opcode::NOP:
             // NOP (No Operation): Do nothing
             break;
 
         case Opcode::HLT:
-            // HLT (Halt): Stop program execution and print state
-            std::cout << "System Halted\n";
-            std::cout << "AX: " << cpu.r.ax << ", BX: " << cpu.r.bx
-                      << ", CX: " << cpu.r.cx << ", DX: " << cpu.r.dx
-                      << ", SP: " << cpu.r.sp << "\n";
-
-            // Print the last 32 bytes of stack memory (top of memory)
-            RohitUtils::printhex(memory.raw() + 0xffff - 32, 32, ' ');
+            // HLT (Halt): run() stops after this instruction
             break;
 
         // ----------- MOV Instructions -----------
@@ -100,18 +197,26 @@ void VM::executeInstruction(const Instruction& instr) {
             break;
 
         // ----------- Arithmetic Instructions -----------
+        // ADD, SUB, MUL and CMP only record their operands: the flags are
+        // worked out if something reads them (see CPU)
         case Opcode::ADD:
+            cpu.recordFlags(FlagOp::Add, cpu.r.ax, cpu.r.bx);
             cpu.r.ax += cpu.r.bx;  // AX = AX + BX
             break;
         case Opcode::SUB:
+            cpu.recordFlags(FlagOp::Sub, cpu.r.ax, cpu.r.bx);
             cpu.r.ax -= cpu.r.bx;  // AX = AX - BX
             break;
         case Opcode::MUL:
+            cpu.recordFlags(FlagOp::Mul, cpu.r.ax, cpu.r.bx);
             cpu.r.ax *= cpu.r.bx;  // AX = AX * BX
             break;
         case Opcode::DIV:
-            if (cpu.r.bx == 0) handleError("Division by zero"); // Prevent division by zero
-            cpu.r.ax /= cpu.r.bx;  // AX = AX / BX
+            if (cpu.r.bx == 0) raise(Trap::DivideByZero, "Division by zero"); // Prevent division by zero
+            cpu.r.ax /= cpu.r.bx;  // AX = AX / BX (flags unchanged)
+            break;
+        case Opcode::CMP:
+            cpu.recordFlags(FlagOp::Sub, cpu.r.ax, cpu.r.bx); // Flags of AX - BX, AX unchanged
             break;
 
         // ----------- Flag Set/Clear Instructions -----------
@@ -132,7 +237,7 @@ void VM::executeInstruction(const Instruction& instr) {
                 case 0x01: push(cpu.r.bx); break;
                 case 0x02: push(cpu.r.cx); break;
                 case 0x03: push(cpu.r.dx); break;
-                default: handleError("Invalid register for PUSH"); break;
+                default: raise(Trap::InvalidRegister, "Invalid register for PUSH");
             }
             break;
 
@@ -143,90 +248,769 @@ void VM::executeInstruction(const Instruction& instr) {
                 case 0x01: cpu.r.bx = pop(); break;
                 case 0x02: cpu.r.cx = pop(); break;
                 case 0x03: cpu.r.dx = pop(); break;
-                default: handleError("Invalid register for POP"); break;
+                default: raise(Trap::InvalidRegister, "Invalid register for POP");
             }
             break;
 
+        case Opcode::PUSHF:
+            push(cpu.flags());     // Materialized value; the pending operation stays pending
+            break;
+        case Opcode::POPF:
+            cpu.r.flags = static_cast<uint16_t>(pop() & Registers::AllFlags);
+            cpu.flagOp = FlagOp::None;
+            break;
+
+        // ----------- Control Flow Instructions -----------
+        case Opcode::JMP:
+            cpu.r.ip = instr.a1;   // Continue at the target address
+            break;
+        case Opcode::CALL:
+            push(cpu.r.ip);        // IP already points past the CALL: that's the return address
+            cpu.r.ip = instr.a1;
+            break;
+        case Opcode::RET:
+            cpu.r.ip = pop();      // Return to the address saved by CALL
+            break;
+        case Opcode::JE:
+            if (cpu.isEqual()) cpu.r.ip = instr.a1;
+            break;
+        case Opcode::JNE:
+            if (!cpu.isEqual()) cpu.r.ip = instr.a1;
+            break;
+        case Opcode::JG:
+            if (cpu.isGreater()) cpu.r.ip = instr.a1;
+            break;
+        case Opcode::JL:
+            if (cpu.isLower()) cpu.r.ip = instr.a1;
+            break;
+
+        // ----------- I/O Instructions -----------
+        case Opcode::IN: {
+            // IN: Read a value from the host's port into a register
+            if (instr.a1 > 0x03) raise(Trap::InvalidRegister, "Invalid register for IN");
+            Word value;
+            if (!readInput(instr.a2, value)) return false;
+            switch (instr.a1) {
+                case 0x00: cpu.r.ax = value; break;
+                case 0x01: cpu.r.bx = value; break;
+                case 0x02: cpu.r.cx = value; break;
+                case 0x03: cpu.r.dx = value; break;
+            }
+            break;
+        }
+
+        case Opcode::OUT:
+            // OUT: Send the value of a register to the host's port
+            switch (instr.a1) {
+                case 0x00: writeOutput(instr.a2, cpu.r.ax); break;
+                case 0x01: writeOutput(instr.a2, cpu.r.bx); break;
+                case 0x02: writeOutput(instr.a2, cpu.r.cx); break;
+                case 0x03: writeOutput(instr.a2, cpu.r.dx); break;
+                default: raise(Trap::InvalidRegister, "Invalid register for OUT");
+            }
+            break;
+
+        // ----------- Block Instructions -----------
+        case Opcode::BSWAP16: swapBlock(2); break;
+        case Opcode::BSWAP32: swapBlock(4); break;
+        case Opcode::BSWAP64: swapBlock(8); break;
+
+        // ----------- Debugging -----------
+        case Opcode::BRK:
+            return false;          // run() stops on it with RunStatus::Breakpoint
+
         default:
             // If an unknown instruction is found
-            handleError("Illegal Instruction");
-            break;
+            raise(Trap::IllegalInstruction, "Illegal Instruction");
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Function: readInput / writeOutput
+// Purpose: The host side of IN and OUT (see VM::onInput / VM::onOutput)
+template <typename Word, typename Mem>
+bool BasicVM<Word, Mem>::readInput(Word port, Word& value) {
+    cpu.materializeFlags();  // The host may look at the registers
+    if (onInput && onInput(port, value)) return true;
+    ioPort = port;  // Tells the host which port the program is waiting on
+    return false;
+}
+
+template <typename Word, typename Mem>
+void BasicVM<Word, Mem>::writeOutput(Word port, Word value) {
+    cpu.materializeFlags();
+    if (onOutput) onOutput(port, value);
+}
+
+// ---------------------------------------------------------------------------
+// Function: touchesPending
+// Purpose: Whether the instruction at 'at' can't run until more of the
+// program is loaded: its own bytes (IP wraps like fetch does), the stack
+// word it pushes or pops, or the block a BSWAP rewrites overlap the pending
+// range. Anything that would trap anyway is let through to trap as usual.
+template <typename Word, typename Mem>
+bool BasicVM<Word, Mem>::touchesPending(Word at) {
+    auto overlaps = [&](uint64_t begin, uint64_t end) { return begin < pendingEnd && end > pendingBegin; };
+
+    if (overlaps(at, uint64_t(at) + 1)) return true;
+    Opcode op = static_cast<Opcode>(memory.peek(at));
+    uint8_t size = getInstructionSize(op);
+    for (uint8_t i = 1; i < size; ++i) {
+        Word addr = static_cast<Word>(at + i);
+        if (overlaps(addr, uint64_t(addr) + 1)) return true;
+    }
+
+    const uint64_t sp = cpu.r.sp;
+    switch (op) {
+        case Opcode::PUSH:
+        case Opcode::PUSHF:
+        case Opcode::CALL:
+            return sp >= sizeof(Word) && overlaps(sp - sizeof(Word), sp);
+        case Opcode::POP:
+        case Opcode::POPF:
+        case Opcode::RET:
+            return overlaps(sp, sp + sizeof(Word));
+        case Opcode::BSWAP16:
+        case Opcode::BSWAP32:
+        case Opcode::BSWAP64: {
+            const uint64_t width = op == Opcode::BSWAP16 ? 2 : op == Opcode::BSWAP32 ? 4 : 8;
+            return cpu.r.cx != 0 && overlaps(cpu.r.dx, cpu.r.dx + uint64_t(cpu.r.cx) * width);
+        }
+        default:
+            return false;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Function: swapBlock
+// Purpose: BSWAP16/32/64: reverses the byte order of CX elements of 'width'
+// bytes starting at DX (e.g. a network packet the host put there).
+// A block that runs past the end of memory traps before anything changes;
+// addresses don't wrap. The flat backends go through RohitUtils::bswapNN
+// (vectorized); paged memory swaps one element at a time through
+// load/store, so page permissions and watchpoints still apply (a fault
+// leaves the elements before it swapped).
+template <typename Word, typename Mem>
+void BasicVM<Word, Mem>::swapBlock(unsigned width) {
+    const uint64_t start = cpu.r.dx;
+    const uint64_t count = cpu.r.cx;
+    if (start + count * width > memory.size()) raise(Trap::MemoryFault, "BSWAP out of range");
+    if (count == 0) return;
+
+    // Rewriting the verified program: its decoded stream is stale now
+    if constexpr (IS_16BIT) {
+        if (verified && start < verified->imageSize) verified.reset();
+    }
+
+    if constexpr (std::is_same_v<Mem, PagedMemory>) {
+        uint8_t bytes[8];
+        for (uint64_t e = start; e < start + count * width; e += width) {
+            for (unsigned i = 0; i < width; ++i) bytes[i] = memory.load(static_cast<Word>(e + i));
+            for (unsigned i = 0; i < width; ++i) memory.store(static_cast<Word>(e + i), bytes[width - 1 - i]);
+        }
+    } else {
+        uint8_t* block = memory.raw() + start;
+        switch (width) {
+            case 2: RohitUtils::bswap16(block, block, count); break;
+            case 4: RohitUtils::bswap32(block, block, count); break;
+            default: RohitUtils::bswap64(block, block, count); break;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Function: verifiedEntry
+// Purpose: Decides whether run() may start on the verified handlers.
+// That's the case at the entry the proof was done for, and when resuming a
+// run that stopped inside the verified handlers (budget or input wait) at
+// an instruction whose proven SP still matches. The host must not change
+// registers of a suspended verified program (the proof may rely on them);
+// reset 'verified' first if it needs to.
+template <typename Word, typename Mem>
+bool BasicVM<Word, Mem>::verifiedEntry(size_t& pc) const {
+    const Word ip = cpu.r.ip;
+    if (ip >= verified->imageSize) return false;
+    int32_t index = verified->indexOf[ip];
+    if (index < 0) return false;
+
+    // The handlers never fetch from memory, so check execute permission up front
+    if constexpr (std::is_same_v<Mem, PagedMemory>) {
+        if (!memory.allows(0, verified->imageSize, PagedMemory::Exec)) return false;
+    }
+
+    bool atEntry = ip == verified->entryIp && cpu.r.sp == verified->entrySp;
+    bool resuming = suspendedVerified && verified->code[index].sp == cpu.r.sp;
+    if (!atEntry && !resuming) return false;
+
+    pc = static_cast<size_t>(index);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Function: executeVerified
+// Purpose: Runs a program that passed the load-time verifier.
+// The verifier already proved that opcodes and register operands are valid,
+// that the stack never overflows/underflows or touches the program, and
+// (where possible) that BX is non-zero at each DIV. So these handlers skip
+// all of those checks and never re-decode instructions from memory.
+// Returns true when the run is over for now ('status' says why); false if a
+// RET jumped somewhere the proof doesn't cover (registers are up to date,
+// the caller continues checked). 'pc' is an index into the decoded stream.
+template <typename Word, typename Mem>
+bool BasicVM<Word, Mem>::executeVerified(size_t pc, uint64_t stopAt, RunStatus& status) {
+    if constexpr (!IS_16BIT) {
+        (void)pc; (void)stopAt; (void)status;
+        return false;   // Verified programs are 16-bit only
+    } else {
+        const DecodedInstruction* code = verified->code.data();
+
+        // The registers live in locals while the handlers run instead of
+        // being read and written through 'this', so the compiler can keep
+        // them in host registers. Anything that needs the real 'cpu' (every
+        // exit, a trap, a profiler sample, the host's I/O callbacks) first
+        // leaves the inner loop through 'leave', the one place that writes
+        // them back; the loop reloads them when it carries on. That keeps
+        // every call out of the inner loop, so the locals are never live
+        // across one (which would put them back on the stack).
+        // The flags are lazy here too (see CPU). The pending operation and
+        // both operands are packed into one local, op << 32 | a << 16 | b,
+        // so recording them costs a single register. FLAGS itself is read
+        // so rarely that it stays in 'cpu' (current while 'lazy' is 0).
+        uint16_t ax, bx, cx, dx, sp;
+        uint16_t& flags = cpu.r.flags;
+        uint64_t lazy;
+        auto record = [&](FlagOp op) {
+            lazy = uint64_t(op) << 32 | uint32_t(ax) << 16 | bx;
+        };
+        auto reload = [&]() {
+            ax = cpu.r.ax; bx = cpu.r.bx; cx = cpu.r.cx; dx = cpu.r.dx;
+            sp = cpu.r.sp;
+            lazy = 0;               // run() always enters with the flags materialized
+        };
+        auto materialize = [&]() {
+            if (lazy) {
+                flags = CPU::flagsFor(static_cast<FlagOp>(lazy >> 32), lazy >> 16, lazy & 0xFFFF);
+                lazy = 0;
+            }
+        };
+        auto writeBack = [&]() {
+            materialize();
+            cpu.r.ax = ax; cpu.r.bx = bx; cpu.r.cx = cx; cpu.r.dx = dx;
+            cpu.r.sp = sp;
+        };
+
+        // Why the inner loop was left
+        enum class Leave { Budget, Sample, Halt, Return, Input, Output, Block, Break, DivideByZero };
+        Leave why;
+
+        // Stack helpers without the overflow/underflow checks of push()/pop().
+        // The flat 64 KiB memory is written through a raw pointer; other
+        // backends go through store/load (which may still fault on page
+        // permissions).
+        uint8_t* mem = nullptr;
+        if constexpr (std::is_same_v<Mem, Memory>) mem = memory.raw();
+        auto pushUnchecked = [&](uint16_t val) {
+            uint16_t top = sp - 2;
+            if constexpr (std::is_same_v<Mem, Memory>) {
+                mem[top] = val & 0xff;
+                mem[top + 1] = (val >> 8) & 0xff;
+            } else {
+                memory.store(top, val & 0xff);      // May fault: SP only moves afterwards
+                memory.store(top + 1, (val >> 8) & 0xff);
+            }
+            sp = top;
+        };
+        auto popUnchecked = [&]() -> uint16_t {
+            uint16_t val;
+            if constexpr (std::is_same_v<Mem, Memory>)
+                val = mem[sp] | (mem[sp + 1] << 8);
+            else
+                val = memory.load(sp) | (memory.load(sp + 1) << 8);
+            sp += 2;
+            return val;
+        };
+
+        // Leaves the loop before code[at] runs; run() may resume from there
+        auto suspend = [&](size_t at, RunStatus reason) {
+            cpu.r.ip = code[at].ip;
+            suspendedVerified = true;
+            status = reason;
+            return true;
+        };
+
+        // Basic blocks: the budget, the profiler and the block counters are
+        // looked at once per block. Instructions are counted up front for
+        // the whole stretch being run; leaving it early (trap, input wait,
+        // breakpoint, I/O callback) takes back the ones that didn't run.
+        const BasicBlock* blocks = verified->blocks.data();
+        if (countedProgram != verified.get()) {
+            blockCounts.assign(verified->blocks.size(), 0);
+            countedProgram = verified.get();
+        }
+        uint64_t* counts = blockCounts.data();
+        uint32_t blk = verified->blockOf[pc];  // May start mid-block when resuming
+        size_t end = pc;                       // End of the stretch counted so far
+
+        try {
+            while (true) {
+                reload();
+
+                while (true) {
+                    // ----------- Block boundary -----------
+                    if (instructionsExecuted >= stopAt) { why = Leave::Budget; goto leave; }
+                    if (profiler && profiler->due(instructionsExecuted)) { why = Leave::Sample; goto leave; }
+                    if (pc == blocks[blk].start) counts[blk]++;
+
+                    // Run to the end of the block, or as far as the budget allows
+                    end = blocks[blk].end;
+                    if (end - pc > stopAt - instructionsExecuted) end = pc + (stopAt - instructionsExecuted);
+                    instructionsExecuted += end - pc;
+
+                    while (pc < end) {
+                        const DecodedInstruction& d = code[pc++];
+                        switch (d.handler) {
+                            case Handler::NOP: break;
+                            case Handler::HLT: why = Leave::Halt; goto leave;
+
+                            // ----------- MOV Instructions -----------
+                            case Handler::MOV_AX: ax = d.a1; break;
+                            case Handler::MOV_BX: bx = d.a1; break;
+                            case Handler::MOV_CX: cx = d.a1; break;
+                            case Handler::MOV_DX: dx = d.a1; break;
+                            case Handler::MOV_SP: sp = d.a1; break;
+
+                            // ----------- Flag Set/Clear Instructions -----------
+                            // The other three bits keep what the last operation left, so
+                            // like every flag reader they need the pending flags first
+                            case Handler::STE: if (lazy) goto pendingFlags; flags |= Registers::Equal; break;
+                            case Handler::CLE: if (lazy) goto pendingFlags; flags &= ~Registers::Equal; break;
+                            case Handler::STG: if (lazy) goto pendingFlags; flags |= Registers::Greater; break;
+                            case Handler::CLG: if (lazy) goto pendingFlags; flags &= ~Registers::Greater; break;
+                            case Handler::STH: if (lazy) goto pendingFlags; flags |= Registers::Higher; break;
+                            case Handler::CLH: if (lazy) goto pendingFlags; flags &= ~Registers::Higher; break;
+                            case Handler::STL: if (lazy) goto pendingFlags; flags |= Registers::Lower; break;
+                            case Handler::CLL: if (lazy) goto pendingFlags; flags &= ~Registers::Lower; break;
+
+                            // ----------- Stack Instructions (bounds already proven) -----------
+                            case Handler::PUSH_AX: pushUnchecked(ax); break;
+                            case Handler::PUSH_BX: pushUnchecked(bx); break;
+                            case Handler::PUSH_CX: pushUnchecked(cx); break;
+                            case Handler::PUSH_DX: pushUnchecked(dx); break;
+                            case Handler::POP_AX: ax = popUnchecked(); break;
+                            case Handler::POP_BX: bx = popUnchecked(); break;
+                            case Handler::POP_CX: cx = popUnchecked(); break;
+                            case Handler::POP_DX: dx = popUnchecked(); break;
+                            case Handler::PUSHF: if (lazy) goto pendingFlags; pushUnchecked(flags); break;
+                            case Handler::POPF:
+                                flags = popUnchecked() & Registers::AllFlags;
+                                lazy = 0;
+                                break;
+
+                            // ----------- Arithmetic Instructions (flags recorded, not computed) -----------
+                            case Handler::ADD: record(FlagOp::Add); ax += bx; break;
+                            case Handler::SUB: record(FlagOp::Sub); ax -= bx; break;
+                            case Handler::MUL: record(FlagOp::Mul); ax *= bx; break;
+                            case Handler::CMP: record(FlagOp::Sub); break;
+                            case Handler::DIV: ax /= bx; break;
+                            case Handler::DIV_CHECKED:
+                                if (bx == 0) { why = Leave::DivideByZero; goto leave; }
+                                ax /= bx;
+                                break;
+
+                            // ----------- Control Flow Instructions -----------
+                            // JMP/CALL end their block: chain straight into the target block
+                            case Handler::JMP:
+                                pc = d.target;
+                                blk = blocks[blk].taken;
+                                goto chained;
+                            case Handler::CALL:
+                                pushUnchecked(d.next);
+                                pc = d.target;
+                                blk = blocks[blk].taken;
+                                goto chained;
+                            case Handler::RET: {
+                                // The only dynamic transfer: the target must be a verified
+                                // return point (the instruction right after a CALL) expecting
+                                // exactly this SP, otherwise hand over to the checked interpreter.
+                                uint16_t target = popUnchecked();
+                                int32_t index = target < verified->imageSize ? verified->indexOf[target] : -1;
+                                if (index <= 0 || code[index - 1].handler != Handler::CALL ||
+                                    code[index].sp != sp) {
+                                    cpu.r.ip = target;
+                                    why = Leave::Return;
+                                    goto leave;
+                                }
+                                pc = static_cast<size_t>(index);
+                                blk = verified->blockOf[pc];   // Return points always start a block
+                                goto chained;
+                            }
+
+                            // Conditional jumps end their block too: chain into the target
+                            // block when taken, fall through to the next block otherwise.
+                            // a2 holds the flag the jump tests (see Verifier).
+                            case Handler::JE: case Handler::JNE: case Handler::JG: case Handler::JL:
+                                materialize();
+                                if (((flags & d.a2) != 0) == (d.handler == Handler::JNE)) break;
+                                pc = d.target;
+                                blk = blocks[blk].taken;
+                                goto chained;
+
+                            // ----------- I/O Instructions (register operand already proven) -----------
+                            case Handler::IN_AX: case Handler::IN_BX: case Handler::IN_CX: case Handler::IN_DX:
+                                why = Leave::Input;
+                                goto leave;
+                            case Handler::OUT_AX: case Handler::OUT_BX: case Handler::OUT_CX: case Handler::OUT_DX:
+                                why = Leave::Output;
+                                goto leave;
+
+                            // ----------- Block Instructions (bounds still checked, out of the loop) -----------
+                            case Handler::BSWAP16: case Handler::BSWAP32: case Handler::BSWAP64:
+                                why = Leave::Block;
+                                goto leave;
+
+                            // ----------- Debugging (BRK, or a breakpoint patched in by the debugger) -----------
+                            case Handler::BREAK: why = Leave::Break; goto leave;
+                        }
+                        continue;
+
+                    pendingFlags:
+                        // A flag reader found the flags still pending: work them out
+                        // here (the one copy of that code) and run it again
+                        materialize();
+                        pc--;
+                    }
+
+                    // Fell off the end of the block: the successor is the next block
+                    // (unless the budget cut the block short)
+                    if (pc == blocks[blk].end) blk++;
+                chained:;
+                }
+
+            leave:
+                // ----------- Out of the inner loop: 'cpu' is current again -----------
+                writeBack();
+                switch (why) {
+                    case Leave::Budget:
+                        return suspend(pc, RunStatus::BudgetExhausted);
+
+                    case Leave::Sample:
+                        cpu.r.ip = code[pc].ip;
+                        profiler->sample(*this);
+                        break;
+
+                    case Leave::Halt:
+                        cpu.r.ip = code[pc - 1].next;  // IP is only written back when we leave the loop
+                        status = RunStatus::Halted;
+                        return true;
+
+                    case Leave::Return:
+                        return false;       // IP already holds the RET's target
+
+                    case Leave::Input: {
+                        const DecodedInstruction& d = code[pc - 1];
+                        uint16_t value;
+                        if (!readInput(d.a2, value)) {
+                            instructionsExecuted -= end - (pc - 1);   // The IN runs again when we're resumed
+                            return suspend(pc - 1, RunStatus::WaitingForInput);
+                        }
+                        switch (d.handler) {
+                            case Handler::IN_AX: cpu.r.ax = value; break;
+                            case Handler::IN_BX: cpu.r.bx = value; break;
+                            case Handler::IN_CX: cpu.r.cx = value; break;
+                            default:             cpu.r.dx = value; break;
+                        }
+                        instructionsExecuted -= end - pc;   // Counted again from here
+                        break;
+                    }
+
+                    case Leave::Output: {
+                        const DecodedInstruction& d = code[pc - 1];
+                        switch (d.handler) {
+                            case Handler::OUT_AX: writeOutput(d.a2, cpu.r.ax); break;
+                            case Handler::OUT_BX: writeOutput(d.a2, cpu.r.bx); break;
+                            case Handler::OUT_CX: writeOutput(d.a2, cpu.r.cx); break;
+                            default:              writeOutput(d.a2, cpu.r.dx); break;
+                        }
+                        instructionsExecuted -= end - pc;
+                        break;
+                    }
+
+                    case Leave::Block: {
+                        // A block that overlaps the program would make the decoded
+                        // stream stale under us: let the checked loop run that BSWAP
+                        // (it drops 'verified'). Anything else is swapped here; one
+                        // past the end of memory traps like the checked one.
+                        const DecodedInstruction& d = code[pc - 1];
+                        if (cpu.r.cx != 0 && cpu.r.dx < verified->imageSize) {
+                            cpu.r.ip = d.ip;
+                            instructionsExecuted -= end - (pc - 1);
+                            return false;
+                        }
+                        swapBlock(2u << (static_cast<unsigned>(d.handler) - static_cast<unsigned>(Handler::BSWAP16)));
+                        instructionsExecuted -= end - pc;
+                        break;
+                    }
+
+                    case Leave::Break:
+                        instructionsExecuted -= end - (pc - 1);
+                        return suspend(pc - 1, RunStatus::Breakpoint);
+
+                    case Leave::DivideByZero:
+                        raise(Trap::DivideByZero, "Division by zero");
+                }
+            }
+        } catch (const TrapError&) {
+            // A handler trapped (division by zero, or a page fault on paged
+            // memory): leave IP and the count where the checked loop would.
+            // Only a page fault can come from inside the inner loop.
+            if constexpr (!std::is_same_v<Mem, Memory>) writeBack();
+            cpu.r.ip = code[pc - 1].next;
+            instructionsExecuted -= end - (pc - 1);
+            throw;
+        }
     }
 }
 
+// ---------------------------------------------------------------------------
+// Function: hotBlocks
+// Purpose: Reports where the verified handlers spent their instructions
+template <typename Word, typename Mem>
+std::vector<BasicHotBlock<Word>> BasicVM<Word, Mem>::hotBlocks(size_t n) const {
+    std::vector<BasicHotBlock<Word>> hot;
+    if (!verified || countedProgram != verified.get()) return hot;
+
+    for (size_t i = 0; i < verified->blocks.size(); ++i) {
+        if (blockCounts[i] == 0) continue;
+        const BasicBlock& b = verified->blocks[i];
+        BasicHotBlock<Word> h;
+        h.startIp = verified->code[b.start].ip;
+        h.endIp = verified->code[b.end - 1].next;
+        h.instructions = b.end - b.start;
+        h.count = blockCounts[i];
+        hot.push_back(h);
+    }
+
+    auto weight = [](const BasicHotBlock<Word>& h) { return h.count * h.instructions; };
+    std::sort(hot.begin(), hot.end(), [&](const auto& a, const auto& b) { return weight(a) > weight(b); });
+    if (hot.size() > n) hot.resize(n);
+    return hot;
+}
+
+// ---------------------------------------------------------------------------
+// Function: reset
+// Purpose: Back to the state of a new VM (except memory and host hooks)
+template <typename Word, typename Mem>
+void BasicVM<Word, Mem>::reset() {
+    cpu = BasicCPU<Word>();
+    cpu.r.sp = static_cast<Word>(memory.size() - 1);
+    breakLine = 0;
+    verified.reset();
+    instructionsExecuted = 0;
+    blockCounts.clear();
+    countedProgram = nullptr;    // A new program may be allocated where the old one was
+    suspendedVerified = false;
+    ioPort = 0;
+    trap = Trap::None;
+    trapMessage.clear();
+    pendingBegin = pendingEnd = 0;
+}
+
+// ---------------------------------------------------------------------------
+// Function: printState
+// Purpose: Prints the registers and the top of the stack (what HLT shows)
+template <typename Word, typename Mem>
+void BasicVM<Word, Mem>::printState() {
+    std::cout << "System Halted\n";
+    std::cout << "AX: " << cpu.r.ax << ", BX: " << cpu.r.bx
+              << ", CX: " << cpu.r.cx << ", DX: " << cpu.r.dx
+              << ", SP: " << cpu.r.sp << "\n";
+
+    // Print the last 32 bytes of stack memory (top of memory)
+    uint8_t top[32];
+    for (size_t i = 0; i < sizeof(top); ++i)
+        top[i] = memory.peek(static_cast<Word>(memory.size() - 1 - 32 + i));
+    RohitUtils::printhex(top, sizeof(top), ' ');
+}
+
 // ---------------------------------------------------------------------------
 // Function: push
-// Purpose: Push a 16-bit value onto the stack
+// Purpose: Push a one-word value onto the stack
 // Stack grows downward in memory. SP (Stack Pointer) is decremented.
-void VM::push(uint16_t val) {
-    if (cpu.r.sp < 2) handleError("Stack Overflow");  // Prevent writing before memory start
+template <typename Word, typename Mem>
+void BasicVM<Word, Mem>::push(Word val) {
+    if (cpu.r.sp < sizeof(Word)) raise(Trap::StackOverflow, "Stack Overflow");  // Prevent writing before memory start
 
-    cpu.r.sp -= 2;                    // Make space for 2 bytes
-    memory[cpu.r.sp] = val & 0xff;    // Store low byte
-    memory[cpu.r.sp + 1] = (val >> 8) & 0xff; // Store high byte
+    // Store first and move SP last, so a store that faults (paged memory)
+    // leaves SP where it was
+    Word sp = cpu.r.sp - sizeof(Word); // Make space for one word
+    for (size_t i = 0; i < sizeof(Word); ++i)
+        memory.store(static_cast<Word>(sp + i), (val >> (8 * i)) & 0xff); // Low byte first
+    cpu.r.sp = sp;
 }
 
 // ---------------------------------------------------------------------------
 // Function: pop
-// Purpose: Pop a 16-bit value from the stack
+// Purpose: Pop a one-word value from the stack
 // Stack grows downward, so popping means reading and then incrementing SP.
-uint16_t VM::pop() {
-    if (cpu.r.sp > Memory::SIZE - 2) handleError("Stack Underflow"); // Prevent reading invalid memory
+template <typename Word, typename Mem>
+Word BasicVM<Word, Mem>::pop() {
+    if (cpu.r.sp > memory.size() - sizeof(Word)) raise(Trap::StackUnderflow, "Stack Underflow"); // Prevent reading invalid memory
 
-    // Read two bytes from stack and combine into one 16-bit value
-    uint16_t val = memory[cpu.r.sp] | (memory[cpu.r.sp + 1] << 8);
-    cpu.r.sp += 2; // Move SP up (free the popped space)
+    // Read the word's bytes from the stack and combine them into one value
+    Word val = readWord(cpu.r.sp);
+    cpu.r.sp += sizeof(Word); // Move SP up (free the popped space)
     return val;
 }
 
 // ---------------------------------------------------------------------------
 // Function: loadProgram
 // Purpose: Loads a program (set of instructions) into VM memory starting from address 0
-void VM::loadProgram(const std::vector<Instruction>& program) {
-    uint8_t* mem = memory.raw();  // Get raw pointer to memory array
+// (throws TrapError if the program doesn't fit in memory; the 16-bit flat
+// memory wraps around instead, as it always did)
+template <typename Word, typename Mem>
+void BasicVM<Word, Mem>::loadProgram(const std::vector<InstructionType>& program) {
+    // poke ignores page permissions, so code can be loaded into read-only pages
+    for (uint8_t byte : encode(program)) memory.poke(breakLine++, byte);
+
+    // Try to prove the program safe so execute() can skip the runtime checks.
+    // If verification fails we keep the normal interpreter, which reports
+    // the same errors at runtime as it always did.
+    if constexpr (IS_16BIT) {
+        if constexpr (std::is_same_v<Mem, Memory>) {
+            verified = Verifier::verify(memory.raw(), breakLine, cpu.r.ip, cpu.r.sp);
+        } else {
+            // The stack proofs need the real memory size (a PagedVM may be smaller)
+            std::vector<uint8_t> image(breakLine);
+            for (size_t i = 0; i < image.size(); ++i) image[i] = memory.peek(static_cast<Word>(i));
+            verified = Verifier::verify(image.data(), breakLine, cpu.r.ip, cpu.r.sp, nullptr,
+                                        static_cast<uint32_t>(std::min<size_t>(memory.size(), Memory::SIZE)));
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Function: loadProgram (shared code segment)
+// Purpose: Same as above without encoding or verifying again
+template <typename Word, typename Mem>
+void BasicVM<Word, Mem>::loadProgram(std::shared_ptr<const CodeSegment> code) {
+    if (code->wordSize() != sizeof(Word))
+        throw std::invalid_argument("Code segment was built for a different word size");
+
+    if constexpr (std::is_same_v<Mem, PagedMemory>) {
+        memory.mapShared(0, code);
+    } else {
+        for (size_t i = 0; i < code->size(); ++i) memory.poke(static_cast<Word>(i), code->data()[i]);
+    }
+    breakLine = static_cast<Word>(code->size());
+
+    // The proof was done for IP 0, the segment's entry SP and a full 64 KiB
+    // memory; run() only uses it if the VM actually starts there
+    if constexpr (IS_16BIT) {
+        const auto& proof = code->verified();
+        verified = proof && proof->memorySize == std::min<size_t>(memory.size(), Memory::SIZE) ? proof : nullptr;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Function: encode
+// Purpose: Turns instructions into bytes: the opcode, then each operand as
+// one little-endian word
+template <typename Word, typename Mem>
+std::vector<uint8_t> BasicVM<Word, Mem>::encode(const std::vector<InstructionType>& program) {
+    std::vector<uint8_t> bytes;
+    bytes.reserve(program.size() * (1 + sizeof(Word)));
+
+    // Appends one operand word, low byte first
+    auto putWord = [&](Word val) {
+        for (size_t i = 0; i < sizeof(Word); ++i) bytes.push_back((val >> (8 * i)) & 0xff);
+    };
 
     for (const auto& instr : program) {
         // Store the opcode
-        mem[breakLine++] = static_cast<uint8_t>(instr.op);
+        bytes.push_back(static_cast<uint8_t>(instr.op));
 
         // Store the first operand if applicable
         uint8_t size = getInstructionSize(instr.op);
-        if (size >= 2) {
-            mem[breakLine++] = instr.a1 & 0xff;
-            mem[breakLine++] = (instr.a1 >> 8) & 0xff;
-        }
+        if (size >= 1 + sizeof(Word)) putWord(instr.a1);
 
-        // Store the second operand (only used if instruction needs 5 bytes)
-        if (size == 5) {
-            mem[breakLine++] = instr.a2 & 0xff;
-            mem[breakLine++] = (instr.a2 >> 8) & 0xff;
-        }
+        // Store the second operand (only used by instructions with two operands)
+        if (size == 1 + 2 * sizeof(Word)) putWord(instr.a2);
     }
+    return bytes;
 }
 
 // ---------------------------------------------------------------------------
 // Function: getInstructionSize
 // Purpose: Returns how many bytes each instruction takes in memory
 // Important because different instructions have different sizes
-uint8_t VM::getInstructionSize(Opcode op) {
-    static std::map<Opcode, uint8_t> sizeMap = {
+// (opcode byte + one word per operand: 1/3/5 bytes for 16-bit, 1/5/9 for 32-bit)
+template <typename Word, typename Mem>
+uint8_t BasicVM<Word, Mem>::getInstructionSize(Opcode op) {
+    constexpr uint8_t W = sizeof(Word);
+    static const std::map<Opcode, uint8_t> sizeMap = {
         {Opcode::NOP, 1}, {Opcode::HLT, 1},
-        {Opcode::MOV, 3}, {Opcode::MOV_BX, 3}, {Opcode::MOV_CX, 3},
-        {Opcode::MOV_DX, 3}, {Opcode::MOV_SP, 3},
+        {Opcode::MOV, 1 + W}, {Opcode::MOV_BX, 1 + W}, {Opcode::MOV_CX, 1 + W},
+        {Opcode::MOV_DX, 1 + W}, {Opcode::MOV_SP, 1 + W},
         {Opcode::STE, 1}, {Opcode::CLE, 1},
         {Opcode::STG, 1}, {Opcode::CLG, 1},
         {Opcode::STH, 1}, {Opcode::CLH, 1},
         {Opcode::STL, 1}, {Opcode::CLL, 1},
-        {Opcode::PUSH, 3}, {Opcode::POP, 3},
-        {Opcode::ADD, 1}, {Opcode::SUB, 1}, {Opcode::MUL, 1}, {Opcode::DIV, 1}
+        {Opcode::PUSH, 1 + W}, {Opcode::POP, 1 + W}, {Opcode::PUSHF, 1}, {Opcode::POPF, 1},
+        {Opcode::ADD, 1}, {Opcode::SUB, 1}, {Opcode::MUL, 1}, {Opcode::DIV, 1}, {Opcode::CMP, 1},
+        {Opcode::JMP, 1 + W}, {Opcode::CALL, 1 + W}, {Opcode::RET, 1},
+        {Opcode::JE, 1 + W}, {Opcode::JNE, 1 + W}, {Opcode::JG, 1 + W}, {Opcode::JL, 1 + W},
+        {Opcode::IN, 1 + 2 * W}, {Opcode::OUT, 1 + 2 * W},
+        {Opcode::BSWAP16, 1}, {Opcode::BSWAP32, 1}, {Opcode::BSWAP64, 1},
+        {Opcode::BRK, 1}
     };
-    return sizeMap[op];
+    auto it = sizeMap.find(op);
+    return it == sizeMap.end() ? 0 : it->second; // 0 means "not a valid opcode"
+}
+
+// ---------------------------------------------------------------------------
+// Function: raise
+// Purpose: Stops the current instruction with a trap (caught by VM::run)
+template <typename Word, typename Mem>
+void BasicVM<Word, Mem>::raise(Trap trap, const char* msg) {
+    throw TrapError(trap, msg);
 }
 
 // ---------------------------------------------------------------------------
 // Function: handleError
 // Purpose: Prints an error message. If 'fatal' is true, the VM exits the program.
-void VM::handleError(const std::string& msg, bool fatal) {
+template <typename Word, typename Mem>
+void BasicVM<Word, Mem>::handleError(const std::string& msg, bool fatal) {
     std::cerr << "VM Error: " << msg << std::endl;
     if (fatal) std::exit(EXIT_FAILURE); // Exit the program on fatal error
 }
+
+// ---------------------------------------------------------------------------
+// Function: MappedMemory::MappedMemory
+// Purpose: Reserves 'bytes' of zeroed memory without committing it.
+// MAP_NORESERVE lets a VM ask for gigabytes it may never touch.
+MappedMemory::MappedMemory(size_t bytes) : bytes(bytes) {
+    if (bytes == 0 || bytes > MAX_SIZE) throw std::bad_alloc();
+    void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (p == MAP_FAILED) throw std::bad_alloc();
+    base = static_cast<uint8_t*>(p);
+}
+
+// ---------------------------------------------------------------------------
+// Function: MappedMemory::~MappedMemory
+MappedMemory::~MappedMemory() {
+    if (base) munmap(base, bytes);
+}
+
+// ---------------------------------------------------------------------------
+// Function: MappedMemory::outOfRange
+void MappedMemory::outOfRange() {
+    throw TrapError(Trap::MemoryFault, "Memory access out of range");
+}
+
+// The machines: 16-bit (VM), RohitVM-32 (VM32) and both on paged memory
+template class BasicVM<uint16_t>;
+template class BasicVM<uint32_t>;
+template class BasicVM<uint16_t, PagedMemory>;
+template class BasicVM<uint32_t, PagedMemory>;
@@ -10,31 +10,47 @@
 #include <cstdarg>      // For variadic functions (not used in this file)
 #include <cstdio>       // For printf()
 #include <stdexcept>    // For throwing runtime errors
+#include <string>       // For trap messages
+#include <functional>   // For the host I/O callbacks
+#include <type_traits>  // For picking the memory backend per word width
 
 #include "RohitUtils.hpp" // Include custom utility functions (like printhex, copy, etc.)
 
+struct VerifiedProgram;   // Defined in RohitVerifier.hpp (result of load-time verification)
+class SamplingProfiler;   // Defined in RohitProfiler.hpp (optional guest code profiler)
+class PagedMemory;        // Defined in RohitMMU.hpp (paged memory backend)
+class CodeSegment;        // Defined in RohitMMU.hpp (program image shared between VMs)
+
 // ===========================================================================
 // Author: Rohit Yadav
 // Description: This header file defines the main building blocks of a virtual CPU.
 //              It simulates registers, memory, instruction handling, and the VM class.
 //              This is the core architectural definition of the 16-bit virtual machine.
+//              Registers, CPU, Instruction and VM are templates on the word
+//              width: VM is the original 16-bit machine, VM32 ("RohitVM-32")
+//              has 32-bit registers, immediates and addresses and a memory
+//              of configurable size. Both use the same opcodes; operands
+//              are one word wide, so instruction sizes are 1/3/5 bytes in
+//              the 16-bit encoding and 1/5/9 bytes in the 32-bit one.
 
 // ===========================================================================
 // CLASS: Registers
 // Simulates the actual CPU registers used for computation and memory addressing.
+// 'Word' is the register width (uint16_t, or uint32_t for RohitVM-32).
 // ===========================================================================
 
-class Registers {
+template <typename Word>
+class BasicRegisters {
 public:
-    // General purpose 16-bit registers commonly found in x86-like architectures.
-    uint16_t ax = 0;   // Accumulator Register: Used for arithmetic operations.
-    uint16_t bx = 0;   // Base Register: General-purpose, often used in memory access.
-    uint16_t cx = 0;   // Count Register: Typically used in loops or shifts.
-    uint16_t dx = 0;   // Data Register: Also general-purpose, often paired with AX.
+    // General purpose registers commonly found in x86-like architectures.
+    Word ax = 0;   // Accumulator Register: Used for arithmetic operations.
+    Word bx = 0;   // Base Register: General-purpose, often used in memory access.
+    Word cx = 0;   // Count Register: Typically used in loops or shifts.
+    Word dx = 0;   // Data Register: Also general-purpose, often paired with AX.
 
     // Special-purpose registers
-    uint16_t sp = 0xFFFF; // Stack Pointer: Points to top of the stack in memory (starts at top).
-    uint16_t ip = 0x0000; // Instruction Pointer: Holds the address of the next instruction.
+    Word sp = static_cast<Word>(~Word(0)); // Stack Pointer: Points to top of the stack in memory (starts at top).
+    Word ip = 0;                           // Instruction Pointer: Holds the address of the next instruction.
     uint16_t flags = 0x0000; // Flags Register: Stores results of comparisons/conditions (4 bits used here).
 
     // Enum to represent individual flag bits (used in the FLAGS register)
@@ -42,38 +58,119 @@ public:
         Equal   = 0x08, // Equal flag (bit 3)
         Greater = 0x04, // Greater flag (bit 2)
         Higher  = 0x02, // High-bit flag (bit 1)
-        Lower   = 0x01  // Low-bit flag (bit 0)
+        Lower   = 0x01, // Low-bit flag (bit 0)
+        AllFlags = 0x0F // Every bit POPF can set
     };
 };
 
+using Registers = BasicRegisters<uint16_t>;
+using Registers32 = BasicRegisters<uint32_t>;
+
+// ===========================================================================
+// ENUM: FlagOp
+// The kind of the last flag-setting instruction (see CPU: lazy flags).
+// CMP sets the flags exactly like SUB, so it's recorded as Sub.
+// ===========================================================================
+
+enum class FlagOp : uint8_t {
+    None,   // FLAGS holds the flags: nothing pending
+    Add,
+    Sub,
+    Mul
+};
+
 // ===========================================================================
 // CLASS: CPU
 // A wrapper for Registers, providing utility functions to read/write FLAGS.
+//
+// Lazy flags: ADD, SUB, MUL and CMP define all four flags, but most of
+// those results are never looked at before the next arithmetic instruction
+// replaces them. So the CPU only records the operation and its operands
+// (recordFlags) and works the bits out when something actually reads
+// them: a conditional jump, a flag set/clear, PUSHF, or the host once
+// run() returns (r.flags is always current then). The bits are:
+//
+//     ADD / MUL     Equal = result is 0, Greater = result overflowed the
+//                   word, Lower = 0, Higher = top bit of the result
+//     SUB / CMP     Equal = AX == BX, Greater = AX > BX, Lower = AX < BX
+//                   (unsigned), Higher = top bit of AX - BX
 // ===========================================================================
 
-class CPU {
+template <typename Word>
+class BasicCPU {
+    using R = BasicRegisters<Word>;
+
 public:
-    Registers r;  // 'r' holds all the register values
+    R r;  // 'r' holds all the register values
+
+    // Pending flag-setting operation (FlagOp::None = r.flags is current)
+    FlagOp flagOp = FlagOp::None;
+    Word flagA = 0, flagB = 0;   // Its operands (AX and BX before it ran)
 
     // ------------------------
     // Flag Getters (Check if a specific flag is set)
     // ------------------------
-    bool isEqual() const   { return r.flags & Registers::Equal; }
-    bool isGreater() const { return r.flags & Registers::Greater; }
-    bool isHigher() const  { return r.flags & Registers::Higher; }
-    bool isLower() const   { return r.flags & Registers::Lower; }
+    bool isEqual() const   { return flags() & R::Equal; }
+    bool isGreater() const { return flags() & R::Greater; }
+    bool isHigher() const  { return flags() & R::Higher; }
+    bool isLower() const   { return flags() & R::Lower; }
 
     // ------------------------
     // Flag Setters (Set or clear a specific flag)
     // ------------------------
-    void setEqual(bool val)   { setFlag(Registers::Equal, val); }
-    void setGreater(bool val) { setFlag(Registers::Greater, val); }
-    void setHigher(bool val)  { setFlag(Registers::Higher, val); }
-    void setLower(bool val)   { setFlag(Registers::Lower, val); }
+    void setEqual(bool val)   { setFlag(R::Equal, val); }
+    void setGreater(bool val) { setFlag(R::Greater, val); }
+    void setHigher(bool val)  { setFlag(R::Higher, val); }
+    void setLower(bool val)   { setFlag(R::Lower, val); }
+
+    // ------------------------
+    // Lazy flags
+    // ------------------------
+    // The FLAGS register as the program would see it now
+    uint16_t flags() const { return flagOp == FlagOp::None ? r.flags : flagsFor(flagOp, flagA, flagB); }
+
+    // An instruction just defined all four flags from operands a and b
+    void recordFlags(FlagOp op, Word a, Word b) { flagOp = op; flagA = a; flagB = b; }
+
+    // Writes the pending flags into r.flags
+    void materializeFlags() {
+        if (flagOp != FlagOp::None) {
+            r.flags = flagsFor(flagOp, flagA, flagB);
+            flagOp = FlagOp::None;
+        }
+    }
+
+    // The four flag bits an operation on a and b produces
+    static uint16_t flagsFor(FlagOp op, Word a, Word b) {
+        constexpr Word TOP = static_cast<Word>(Word(1) << (8 * sizeof(Word) - 1));
+        Word result;
+        uint16_t f = 0;
+        switch (op) {
+            case FlagOp::Add:
+                result = static_cast<Word>(a + b);
+                if (result < a) f |= R::Greater;            // Carry out of the top bit
+                break;
+            case FlagOp::Mul:
+                result = static_cast<Word>(uint64_t(a) * b);     // No signed int promotion
+                if (uint64_t(a) * b != result) f |= R::Greater; // Product didn't fit
+                break;
+            case FlagOp::Sub:
+                result = static_cast<Word>(a - b);
+                if (a > b) f |= R::Greater;
+                if (a < b) f |= R::Lower;
+                break;
+            default:
+                return 0;
+        }
+        if (result == 0) f |= R::Equal;
+        if (result & TOP) f |= R::Higher;
+        return f;
+    }
 
 private:
     // Internal utility to set/clear any flag bit using bit masking
     void setFlag(uint16_t mask, bool val) {
+        materializeFlags();     // The other three bits keep what the last operation left
         if (val)
             r.flags |= mask;    // Set bit
         else
@@ -81,6 +178,8 @@ private:
     }
 };
 
+using CPU = BasicCPU<uint16_t>;
+
 // ===========================================================================
 // CLASS: Memory
 // A class that simulates 64KB (65,536 bytes) of memory as a vector of bytes.
@@ -105,6 +204,68 @@ public:
 
     // Returns raw pointer to beginning of memory array (useful for printing, copying, etc.)
     uint8_t* raw() { return data.data(); }
+    const uint8_t* raw() const { return data.data(); }
+
+    static constexpr size_t size() { return SIZE; }
+
+    // Whole-memory reset and snapshots ('out' / 'in' hold SIZE bytes).
+    // RohitUtils::zero / copy move the full 64 KiB in one call.
+    void clear() { RohitUtils::zero(data.data(), SIZE); }
+    void save(uint8_t* out) const { RohitUtils::copy(out, data.data(), SIZE); }
+    void restore(const uint8_t* in) { RohitUtils::copy(data.data(), in, SIZE); }
+
+    // The access interface the VM uses (shared by all memory backends):
+    // guest data loads/stores, instruction fetches, and host-side peek/poke
+    uint8_t load(uint16_t addr) const { return data[addr]; }
+    uint8_t fetch(uint16_t addr) const { return data[addr]; }
+    void store(uint16_t addr, uint8_t val) { data[addr] = val; }
+    uint8_t peek(uint16_t addr) const { return data[addr]; }
+    void poke(uint16_t addr, uint8_t val) { data[addr] = val; }
+};
+
+// ===========================================================================
+// CLASS: MappedMemory
+// Memory for RohitVM-32: a size chosen at runtime (up to 4 GiB, the 32-bit
+// address space), reserved with mmap. The kernel only commits a page when
+// it is first touched and untouched pages read as zero, so a large memory
+// costs nothing until the program uses it. Addresses past the end trap.
+// ===========================================================================
+
+class MappedMemory {
+public:
+    static constexpr size_t DEFAULT_SIZE = size_t(16) << 20; // 16 MiB
+    static constexpr size_t MAX_SIZE = size_t(1) << 32;      // Whole 32-bit address space
+
+    explicit MappedMemory(size_t bytes = DEFAULT_SIZE); // Throws std::bad_alloc if mmap fails
+    ~MappedMemory();
+    MappedMemory(const MappedMemory&) = delete;
+    MappedMemory& operator=(const MappedMemory&) = delete;
+
+    uint8_t& operator[](uint32_t addr) {
+        if (addr >= bytes) outOfRange();
+        return base[addr];
+    }
+
+    const uint8_t& operator[](uint32_t addr) const {
+        if (addr >= bytes) outOfRange();
+        return base[addr];
+    }
+
+    uint8_t* raw() { return base; }
+    size_t size() const { return bytes; }
+
+    // Same access interface as Memory (every access is bounds checked)
+    uint8_t load(uint32_t addr) const { return (*this)[addr]; }
+    uint8_t fetch(uint32_t addr) const { return (*this)[addr]; }
+    void store(uint32_t addr, uint8_t val) { (*this)[addr] = val; }
+    uint8_t peek(uint32_t addr) const { return addr < bytes ? base[addr] : 0; }
+    void poke(uint32_t addr, uint8_t val) { (*this)[addr] = val; }
+
+private:
+    uint8_t* base = nullptr;
+    size_t bytes = 0;
+
+    [[noreturn]] static void outOfRange(); // Throws TrapError(Trap::MemoryFault)
 };
 
 // ===========================================================================
@@ -133,12 +294,36 @@ enum class Opcode : uint8_t {
     // Stack Instructions
     PUSH = 0x1A,      // PUSH register
     POP = 0x1B,       // POP to register
+    PUSHF = 0x1C,     // PUSHF           => push FLAGS
+    POPF = 0x1D,      // POPF            => FLAGS = POP (low four bits)
 
-    // Arithmetic Instructions
+    // Arithmetic Instructions (all but DIV set the flags, see CPU)
     ADD = 0x20,       // ADD AX, BX => AX = AX + BX
     SUB = 0x21,       // SUB AX, BX => AX = AX - BX
     MUL = 0x22,       // MUL AX, BX => AX = AX * BX
-    DIV = 0x23        // DIV AX, BX => AX = AX / BX (if BX != 0)
+    DIV = 0x23,       // DIV AX, BX => AX = AX / BX (if BX != 0)
+    CMP = 0x24,       // CMP AX, BX => flags of AX - BX, AX unchanged
+
+    // Control Flow Instructions
+    JMP = 0x30,       // JMP address     => IP = address
+    CALL = 0x31,      // CALL address    => PUSH return address, IP = address
+    RET = 0x32,       // RET             => IP = POP
+    JE = 0x33,        // JE address      => jump if Equal is set
+    JNE = 0x34,       // JNE address     => jump if Equal is clear
+    JG = 0x35,        // JG address      => jump if Greater is set
+    JL = 0x36,        // JL address      => jump if Lower is set
+
+    // I/O Instructions (5 bytes: register, port)
+    IN = 0x38,        // IN reg, port    => reg = value read from the host's port
+    OUT = 0x39,       // OUT reg, port   => send reg to the host's port
+
+    // Block Instructions (CX elements at address DX; registers and flags unchanged)
+    BSWAP16 = 0x3A,   // BSWAP16         => reverse the bytes of CX 16-bit words at DX
+    BSWAP32 = 0x3B,   // BSWAP32         => same for CX 32-bit values
+    BSWAP64 = 0x3C,   // BSWAP64         => same for CX 64-bit values
+
+    // Debugging
+    BRK = 0xCC        // BRK             => run() stops with RunStatus::Breakpoint (IP stays on the BRK)
 };
 
 // ===========================================================================
@@ -147,36 +332,209 @@ enum class Opcode : uint8_t {
 // a1 and a2 are optional 16-bit operands depending on instruction.
 // ===========================================================================
 
-struct Instruction {
+template <typename Word>
+struct BasicInstruction {
     Opcode op;       // The operation code (what kind of instruction)
-    uint16_t a1 = 0; // First operand (e.g., a register value)
-    uint16_t a2 = 0; // Second operand (if applicable)
+    Word a1 = 0;     // First operand (e.g., a register value)
+    Word a2 = 0;     // Second operand (if applicable)
+};
+
+using Instruction = BasicInstruction<uint16_t>;
+using Instruction32 = BasicInstruction<uint32_t>;
+
+// ===========================================================================
+// ENUM: Trap
+// Why a program stopped. Tools that run programs without the interactive
+// VM::execute loop (e.g. translated code) report these as return codes.
+// ===========================================================================
+
+enum class Trap : uint8_t {
+    None = 0,            // No trap: the program reached HLT
+    DivideByZero,        // DIV with BX == 0
+    StackOverflow,       // PUSH with SP < 2
+    StackUnderflow,      // POP with SP > 0xFFFE
+    InvalidRegister,     // PUSH/POP/IN/OUT with a register operand other than AX-DX
+    IllegalInstruction,  // Unknown opcode
+    MemoryFault,         // Access past the end of memory (or a BSWAP block that runs past it), or against page permissions
+    Breakpoint           // BRK in AOT-translated code (the VM reports RunStatus::Breakpoint instead)
+};
+
+// ===========================================================================
+// ENUM: RunStatus
+// Why VM::run returned. Only Halted and Trapped are final; after the others
+// the host calls run() again to carry on where the program stopped.
+// ===========================================================================
+
+enum class RunStatus : uint8_t {
+    Halted,            // HLT executed (IP points past it)
+    BudgetExhausted,   // The instruction budget ran out
+    WaitingForInput,   // IN found no data on vm.ioPort (IP still points at the IN)
+    Breakpoint,        // BRK reached (IP still points at it; see RohitDebugger.hpp)
+    Trapped,           // Runtime error: see vm.trap / vm.trapMessage
+    WaitingForCode     // The next instruction needs bytes still being loaded (see RohitLoader.hpp)
+};
+
+// Number of RunStatus values: size tables indexed by status with this
+constexpr size_t RUN_STATUS_COUNT = static_cast<size_t>(RunStatus::WaitingForCode) + 1;
+
+// ===========================================================================
+// STRUCT: HotBlock
+// One basic block of a verified program and how often it ran (VM::hotBlocks).
+// ===========================================================================
+
+template <typename Word>
+struct BasicHotBlock {
+    Word startIp = 0;          // Address of the first instruction
+    Word endIp = 0;            // Address just past the last one
+    uint32_t instructions = 0; // Instructions in the block
+    uint64_t count = 0;        // Times the block was entered at the top
+};
+
+using HotBlock = BasicHotBlock<uint16_t>;
+
+// ===========================================================================
+// CLASS: TrapError
+// Thrown inside the VM when an instruction fails. VM::run catches it and
+// reports RunStatus::Trapped; VM::execute reports it as a fatal error.
+// ===========================================================================
+
+class TrapError : public std::runtime_error {
+public:
+    TrapError(Trap trap, const char* msg) : std::runtime_error(msg), trap(trap) {}
+    Trap trap;
 };
 
 // ===========================================================================
 // CLASS: VM (Virtual Machine)
 // The main class that brings together CPU, Memory, and Instruction Execution
+// The member functions are defined in RohitVM.cpp and instantiated there
+// for the supported widths and memory backends, so the 16-bit VM compiles
+// to exactly the code it always did.
+// 'Mem' is the memory backend: by default a 64 KiB vector for the 16-bit VM
+// and mmap-backed memory for RohitVM-32; PagedMemory (RohitMMU.hpp) works
+// with both.
 // ===========================================================================
 
-class VM {
+template <typename Word,
+          typename Mem = std::conditional_t<std::is_same_v<Word, uint16_t>, Memory, MappedMemory>>
+class BasicVM {
 public:
-    CPU cpu;                // Holds registers and flag logic
-    Memory memory;          // Holds 64KB of program memory
-    uint16_t breakLine = 0; // Used to track where the next instruction should be placed
+    static_assert(std::is_same_v<Word, uint16_t> || std::is_same_v<Word, uint32_t>,
+                  "RohitVM supports 16-bit and 32-bit words");
+
+    // The verifier, optimizer, AOT translator and perf counters understand
+    // the 16-bit encoding only; RohitVM-32 always runs on the checked interpreter.
+    static constexpr bool IS_16BIT = std::is_same_v<Word, uint16_t>;
 
-    // Constructor
-    VM() = default;
+    using MemoryType = Mem;
+    using InstructionType = BasicInstruction<Word>;
+
+    BasicCPU<Word> cpu;     // Holds registers and flag logic
+    MemoryType memory;      // Holds program memory (64KB for the 16-bit VM)
+    Word breakLine = 0;     // Used to track where the next instruction should be placed
+
+    // Set by loadProgram when the verifier proved the program safe.
+    // If set (and IP/SP still match what was verified), run() uses the
+    // check-free handler set instead of the normal interpreter.
+    std::shared_ptr<const VerifiedProgram> verified;
+
+    uint64_t instructionsExecuted = 0; // Guest instructions run so far (all runs of this VM)
+
+    // Entries per basic block of 'verified', counted by the verified
+    // handlers (reset when the verified program changes)
+    std::vector<uint64_t> blockCounts;
+
+    // Optional sampling profiler (nullptr = off; see RohitProfiler.hpp)
+    SamplingProfiler* profiler = nullptr;
+
+    // Host side of IN/OUT. onInput returns false when the port has no data
+    // yet: run() then stops with RunStatus::WaitingForInput and re-executes
+    // the IN when called again. Without onInput every IN waits; without
+    // onOutput OUT values are dropped.
+    std::function<bool(Word port, Word& value)> onInput;
+    std::function<void(Word port, Word value)> onOutput;
+    Word ioPort = 0;                   // Port of the IN that is waiting for data
+
+    Trap trap = Trap::None;            // Set when run() returns RunStatus::Trapped
+    std::string trapMessage;           // Same text execute() prints for the error
+
+    // Bytes [pendingBegin, pendingEnd) of the program haven't arrived yet
+    // (StreamLoader in RohitLoader.hpp). An instruction that would be
+    // fetched from them, or read or write them (stack, BSWAP), isn't run:
+    // run() stops with RunStatus::WaitingForCode and IP still on it. Only
+    // the checked interpreter looks at this; the range is empty by default.
+    size_t pendingBegin = 0;
+    size_t pendingEnd = 0;
+
+    static constexpr uint64_t UNLIMITED = UINT64_MAX;
+
+    // Constructor: the stack starts at the top of memory
+    BasicVM() : memory(defaultMemory()) { cpu.r.sp = static_cast<Word>(memory.size() - 1); }
+
+    // RohitVM-32 / paged memory only: memory of 'memoryBytes' bytes
+    template <typename M = MemoryType, typename = std::enable_if_t<!std::is_same_v<M, Memory>>>
+    explicit BasicVM(size_t memoryBytes) : memory(memoryBytes) {
+        cpu.r.sp = static_cast<Word>(memory.size() - 1);
+    }
 
     // Public functions to load and run a program
     void execute();  // Main function to start execution (fetch-decode-execute loop)
-    void loadProgram(const std::vector<Instruction>& program); // Load a program into memory
+    void loadProgram(const std::vector<InstructionType>& program); // Load a program into memory
+
+    // Loads a shared, already encoded (and verified) program at address 0.
+    // Paged VMs map the segment's pages read/execute-only instead of copying
+    // them; other VMs copy the bytes but still share the decoded program.
+    // Throws std::invalid_argument if the segment has a different word size.
+    // A host that patches the code afterwards must reset 'verified' too.
+    void loadProgram(std::shared_ptr<const CodeSegment> code);
+
+    // Runs at most 'budget' instructions and reports why it stopped instead
+    // of printing or exiting. Call it again to continue a program that ran
+    // out of budget or is waiting for input (this is what the coroutine
+    // wrapper in RohitCoroutine.hpp does). Nothing is allocated per call.
+    RunStatus run(uint64_t budget = UNLIMITED);
+
+    static uint8_t getInstructionSize(Opcode op); // Returns size of instruction in bytes (0 = unknown opcode)
+
+    // The bytes loadProgram stores for 'program' (opcode, then operand words low byte first)
+    static std::vector<uint8_t> encode(const std::vector<InstructionType>& program);
+
+    // The 'n' basic blocks that ran the most instructions (count x size),
+    // hottest first. Empty unless the program ran on the verified handlers.
+    std::vector<BasicHotBlock<Word>> hotBlocks(size_t n = 10) const;
+
+    // Makes the VM ready for an unrelated program, as if it had just been
+    // constructed: registers, counters, the verified program, block counts,
+    // the trap, the I/O state and the pending load range. Memory and the host hooks (onInput,
+    // onOutput, profiler) are left alone; clear() the memory first if the
+    // next program must not see what the last one left there. Lets a pool
+    // of VMs be reused for many short jobs without reallocating anything.
+    void reset();
 
 private:
     // Internal helper functions used by the VM
-    void executeInstruction(const Instruction& instr); // Executes one instruction
+    bool executeInstruction(const InstructionType& instr); // Executes one instruction (false = IN has to wait)
+    bool executeVerified(size_t pc, uint64_t stopAt, RunStatus& status); // Verified handlers (false = fall back)
+    bool verifiedEntry(size_t& pc) const; // Can the verified handlers run from the current IP/SP?
+    bool readInput(Word port, Word& value); // onInput, or remember the port we're waiting on
+    void writeOutput(Word port, Word value); // onOutput (if set)
+    void swapBlock(unsigned width); // BSWAP16/32/64 on CX elements at DX
+    bool touchesPending(Word at);   // Does the instruction at 'at' need bytes not loaded yet?
+    [[noreturn]] void raise(Trap trap, const char* msg); // Throws TrapError
+    void printState();      // Prints registers and top of stack (used by HLT)
     void handleError(const std::string& msg, bool fatal = true); // Reports errors
-    uint8_t getInstructionSize(Opcode op); // Returns size of instruction in bytes
-    void push(uint16_t val); // Push value onto the stack
-    uint16_t pop();          // Pop value from the stack
-    Instruction fetchNextInstruction(); // Read next instruction from memory
+    void push(Word val);    // Push value onto the stack
+    Word pop();             // Pop value from the stack
+    Word readWord(Word addr, bool fetch = false); // Little-endian word at 'addr' (wraps like IP does)
+    static MemoryType defaultMemory(); // Whole address space for paged memory, the backend's default otherwise
+    InstructionType fetchNextInstruction(); // Read next instruction from memory
+
+    bool suspendedVerified = false; // Last run() stopped inside the verified handlers
+    const VerifiedProgram* countedProgram = nullptr; // Program blockCounts belongs to
 };
+
+using VM = BasicVM<uint16_t>;    // The original 16-bit machine
+using VM32 = BasicVM<uint32_t>;  // RohitVM-32
+
+extern template class BasicVM<uint16_t>;
+extern template class BasicVM<uint32_t>;
@@ -0,0 +1,365 @@
+// RohitVerifier.cpp
+// This file implements the load-time program verifier.
+// It runs a small abstract interpretation over the program bytes: every
+// reachable instruction is decoded once, and for every instruction we know
+// the exact stack pointer and (when possible) the constant held by each
+// general purpose register. From that we can prove which runtime checks
+// are unnecessary and pick the matching specialized handler.
+
+#include "RohitVerifier.hpp"
+#include <cstdio>        // For snprintf (error messages)
+
+namespace {
+
+    // -------------------------------
+    // Struct: AbstractState
+    // What the verifier knows about the CPU before an instruction runs.
+    // SP is always known exactly; general purpose registers may be unknown.
+    struct AbstractState {
+        uint16_t sp = 0;          // Exact stack pointer
+        uint8_t known = 0;        // Bit i set => reg[i] holds a known constant
+        uint16_t reg[4] = {};     // AX, BX, CX, DX constants (valid when known)
+
+        bool isKnown(int r) const { return known & (1 << r); }
+        void set(int r, uint16_t v) { known |= (1 << r); reg[r] = v; }
+        void forget(int r) { known &= ~(1 << r); }
+    };
+
+    enum { AX = 0, BX = 1, CX = 2, DX = 3 };
+
+    // -------------------------------
+    // Function: fail
+    // Purpose: Formats an error message (if the caller wants one) and returns nullptr.
+    std::shared_ptr<const VerifiedProgram> fail(std::string* error, const char* what, uint16_t ip) {
+        if (error) {
+            char buf[96];
+            snprintf(buf, sizeof(buf), "%s at 0x%04x", what, ip);
+            *error = buf;
+        }
+        return nullptr;
+    }
+
+    // -------------------------------
+    // Function: join
+    // Purpose: Merges the state reaching an instruction from another path.
+    // Returns false if the two paths disagree on SP (stack depth must be the
+    // same on every path, otherwise we can't bound it statically).
+    bool join(AbstractState& into, const AbstractState& from, bool& changed) {
+        if (into.sp != from.sp) return false;
+        for (int r = 0; r < 4; ++r) {
+            if (into.isKnown(r) && (!from.isKnown(r) || from.reg[r] != into.reg[r])) {
+                into.forget(r);
+                changed = true;
+            }
+        }
+        return true;
+    }
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Function: Verifier::verify
+// Purpose: Decodes and checks every instruction reachable from entryIp.
+std::shared_ptr<const VerifiedProgram> Verifier::verify(const uint8_t* image, uint16_t size,
+                                                        uint16_t entryIp, uint16_t entrySp,
+                                                        std::string* error, uint32_t memorySize) {
+    if (entryIp >= size) return fail(error, "entry point outside program", entryIp);
+    if (memorySize < 2 || memorySize > Memory::SIZE) return fail(error, "unsupported memory size", entryIp);
+    const uint32_t topSp = memorySize - 2;   // Highest SP a word can be read or written at
+
+    // Per-address bookkeeping: has this address been reached, and with what state
+    std::vector<bool> reached(size, false);
+    std::vector<AbstractState> states(size);
+    std::vector<DecodedInstruction> decodedAt(size);
+    std::vector<uint16_t> worklist;
+
+    auto program = std::make_shared<VerifiedProgram>();
+    program->entryIp = entryIp;
+    program->entrySp = entrySp;
+    program->imageSize = size;
+    program->memorySize = memorySize;
+    program->minSp = entrySp;
+    program->maxSp = entrySp;
+
+    AbstractState entry;
+    entry.sp = entrySp;             // General purpose registers start unknown
+    reached[entryIp] = true;
+    states[entryIp] = entry;
+    worklist.push_back(entryIp);
+
+    // Records that 'state' flows into 'addr'; false if the stack depths disagree
+    auto reach = [&](uint16_t addr, const AbstractState& state) {
+        if (!reached[addr]) {
+            reached[addr] = true;
+            states[addr] = state;
+            worklist.push_back(addr);
+            return true;
+        }
+        bool changed = false;
+        if (!join(states[addr], state, changed)) return false;
+        if (changed) worklist.push_back(addr);
+        return true;
+    };
+
+    while (!worklist.empty()) {
+        uint16_t ip = worklist.back();
+        worklist.pop_back();
+        AbstractState s = states[ip];
+
+        // ----------- Decode (valid opcode, fits inside the program) -----------
+        Opcode op = static_cast<Opcode>(image[ip]);
+        uint8_t len = VM::getInstructionSize(op);
+        if (len == 0) return fail(error, "illegal instruction", ip);
+        if (ip + len > size) return fail(error, "instruction runs past end of program", ip);
+
+        DecodedInstruction d;
+        d.op = op;
+        d.ip = ip;
+        d.next = static_cast<uint16_t>(ip + len);
+        if (len >= 3) d.a1 = image[ip + 1] | (image[ip + 2] << 8);
+        if (len == 5) d.a2 = image[ip + 3] | (image[ip + 4] << 8);
+
+        // ----------- Transfer function -----------
+        bool halts = false;
+        switch (op) {
+            case Opcode::NOP: d.handler = Handler::NOP; break;
+            case Opcode::HLT: d.handler = Handler::HLT; halts = true; break;
+
+            case Opcode::MOV:    d.handler = Handler::MOV_AX; s.set(AX, d.a1); break;
+            case Opcode::MOV_BX: d.handler = Handler::MOV_BX; s.set(BX, d.a1); break;
+            case Opcode::MOV_CX: d.handler = Handler::MOV_CX; s.set(CX, d.a1); break;
+            case Opcode::MOV_DX: d.handler = Handler::MOV_DX; s.set(DX, d.a1); break;
+            case Opcode::MOV_SP: d.handler = Handler::MOV_SP; s.sp = d.a1; break;
+
+            case Opcode::STE: d.handler = Handler::STE; break;
+            case Opcode::CLE: d.handler = Handler::CLE; break;
+            case Opcode::STG: d.handler = Handler::STG; break;
+            case Opcode::CLG: d.handler = Handler::CLG; break;
+            case Opcode::STH: d.handler = Handler::STH; break;
+            case Opcode::CLH: d.handler = Handler::CLH; break;
+            case Opcode::STL: d.handler = Handler::STL; break;
+            case Opcode::CLL: d.handler = Handler::CLL; break;
+
+            case Opcode::PUSH:
+                if (d.a1 > DX) return fail(error, "invalid register for PUSH", ip);
+                if (s.sp < 2) return fail(error, "stack overflow", ip);
+                s.sp -= 2;
+                if (s.sp < size) return fail(error, "stack overlaps program", ip);
+                if (s.sp > topSp) return fail(error, "stack outside memory", ip);
+                d.handler = static_cast<Handler>(static_cast<uint8_t>(Handler::PUSH_AX) + d.a1);
+                break;
+
+            case Opcode::POP:
+                if (d.a1 > DX) return fail(error, "invalid register for POP", ip);
+                if (s.sp > topSp) return fail(error, "stack underflow", ip);
+                s.sp += 2;                   // Wraps exactly like the interpreter's uint16_t SP
+                s.forget(d.a1);              // Stack contents aren't tracked
+                d.handler = static_cast<Handler>(static_cast<uint8_t>(Handler::POP_AX) + d.a1);
+                break;
+
+            // Same stack proofs as PUSH/POP; flags aren't tracked
+            case Opcode::PUSHF:
+                if (s.sp < 2) return fail(error, "stack overflow", ip);
+                s.sp -= 2;
+                if (s.sp < size) return fail(error, "stack overlaps program", ip);
+                if (s.sp > topSp) return fail(error, "stack outside memory", ip);
+                d.handler = Handler::PUSHF;
+                break;
+
+            case Opcode::POPF:
+                if (s.sp > topSp) return fail(error, "stack underflow", ip);
+                s.sp += 2;
+                d.handler = Handler::POPF;
+                break;
+
+            case Opcode::ADD:
+            case Opcode::SUB:
+            case Opcode::MUL:
+            case Opcode::DIV: {
+                bool bothKnown = s.isKnown(AX) && s.isKnown(BX);
+                uint16_t a = s.reg[AX], b = s.reg[BX];
+                if (op == Opcode::ADD) { d.handler = Handler::ADD; if (bothKnown) s.set(AX, a + b); }
+                if (op == Opcode::SUB) { d.handler = Handler::SUB; if (bothKnown) s.set(AX, a - b); }
+                if (op == Opcode::MUL) { d.handler = Handler::MUL; if (bothKnown) s.set(AX, a * b); }
+                if (op == Opcode::DIV) {
+                    // The handler is chosen after the fixpoint, once BX is final
+                    d.handler = Handler::DIV_CHECKED;
+                    if (bothKnown && b != 0) s.set(AX, a / b);
+                }
+                if (!bothKnown || (op == Opcode::DIV && b == 0)) s.forget(AX);
+                break;
+            }
+
+            case Opcode::CMP: d.handler = Handler::CMP; break;   // Only the flags change
+
+            // ----------- Control flow (targets must be inside the program) -----------
+            case Opcode::JMP:
+                if (d.a1 >= size) return fail(error, "jump target outside program", ip);
+                d.handler = Handler::JMP;
+                halts = true;                 // No fall-through
+                if (!reach(d.a1, s)) return fail(error, "inconsistent stack depth", d.a1);
+                break;
+
+            case Opcode::CALL: {
+                if (d.a1 >= size) return fail(error, "call target outside program", ip);
+                if (s.sp < 2) return fail(error, "stack overflow", ip);
+                AbstractState callee = s;
+                callee.sp -= 2;
+                if (callee.sp < size) return fail(error, "stack overlaps program", ip);
+                if (callee.sp > topSp) return fail(error, "stack outside memory", ip);
+                if (!reach(d.a1, callee)) return fail(error, "inconsistent stack depth", d.a1);
+                if (callee.sp < program->minSp) program->minSp = callee.sp;
+                d.handler = Handler::CALL;
+                s.known = 0;                  // The callee may change any register
+                break;                        // Falls through to the return point
+            }
+
+            // Conditional jumps: both the target and the next instruction are successors
+            case Opcode::JE:
+            case Opcode::JNE:
+            case Opcode::JG:
+            case Opcode::JL:
+                if (d.a1 >= size) return fail(error, "jump target outside program", ip);
+                d.handler = op == Opcode::JE ? Handler::JE : op == Opcode::JNE ? Handler::JNE
+                          : op == Opcode::JG ? Handler::JG : Handler::JL;
+                d.a2 = op == Opcode::JG ? Registers::Greater : op == Opcode::JL ? Registers::Lower
+                     : Registers::Equal;      // The flag the handler tests
+                if (!reach(d.a1, s)) return fail(error, "inconsistent stack depth", d.a1);
+                break;
+
+            case Opcode::RET:
+                if (s.sp > topSp) return fail(error, "stack underflow", ip);
+                d.handler = Handler::RET;
+                halts = true;                 // Successor is only known at runtime
+                break;
+
+            // ----------- I/O (the host supplies IN values, so they're unknown) -----------
+            case Opcode::IN:
+                if (d.a1 > DX) return fail(error, "invalid register for IN", ip);
+                s.forget(d.a1);
+                d.handler = static_cast<Handler>(static_cast<uint8_t>(Handler::IN_AX) + d.a1);
+                break;
+
+            case Opcode::OUT:
+                if (d.a1 > DX) return fail(error, "invalid register for OUT", ip);
+                d.handler = static_cast<Handler>(static_cast<uint8_t>(Handler::OUT_AX) + d.a1);
+                break;
+
+            // ----------- Block instructions (registers unchanged) -----------
+            case Opcode::BSWAP16: d.handler = Handler::BSWAP16; break;
+            case Opcode::BSWAP32: d.handler = Handler::BSWAP32; break;
+            case Opcode::BSWAP64: d.handler = Handler::BSWAP64; break;
+
+            case Opcode::BRK: d.handler = Handler::BREAK; break;
+
+            default:
+                return fail(error, "illegal instruction", ip);
+        }
+        decodedAt[ip] = d;
+
+        if (s.sp < program->minSp) program->minSp = s.sp;
+        if (s.sp > program->maxSp) program->maxSp = s.sp;
+        if (halts) continue;
+
+        // ----------- Successor (fall-through must stay inside the program) -----------
+        if (d.next >= size) return fail(error, "execution runs past end of program", ip);
+        if (!reach(d.next, s)) return fail(error, "inconsistent stack depth", d.next);
+    }
+
+    // ----------- Build the decoded stream in address order -----------
+    program->indexOf.assign(size, -1);
+    for (uint32_t ip = 0; ip < size; ++ip) {
+        if (!reached[ip]) continue;
+        DecodedInstruction d = decodedAt[ip];
+        d.sp = states[ip].sp;
+        if (!program->code.empty() && program->code.back().next > d.ip)
+            return fail(error, "overlapping instructions", d.ip);
+
+        // DIV is unchecked only if BX is a known non-zero constant on every path
+        if (d.op == Opcode::DIV) {
+            const AbstractState& s = states[ip];
+            if (s.isKnown(BX) && s.reg[BX] != 0) d.handler = Handler::DIV;
+        }
+
+        // Count the runtime checks this instruction no longer needs
+        switch (d.op) {
+            case Opcode::PUSH: case Opcode::POP:
+                program->checksRemoved += 2;  // bounds check + register switch
+                break;
+            case Opcode::PUSHF: case Opcode::POPF:
+                program->checksRemoved += 1;  // bounds check
+                break;
+            case Opcode::IN: case Opcode::OUT:
+                program->checksRemoved += 1;  // register switch
+                break;
+            case Opcode::CALL: case Opcode::RET:
+                program->checksRemoved += 1;  // bounds check of the return address
+                break;
+            case Opcode::DIV:
+                if (d.handler == Handler::DIV) program->checksRemoved++;
+                else program->checksKept++;
+                break;
+            case Opcode::BSWAP16: case Opcode::BSWAP32: case Opcode::BSWAP64:
+                program->checksKept++;        // bounds of the block
+                break;
+            default:
+                break;
+        }
+        program->indexOf[ip] = static_cast<int32_t>(program->code.size());
+        program->code.push_back(d);
+    }
+
+    // Resolve JMP/CALL/Jcc targets to decoded-stream indexes
+    auto jumps = [](Handler h) {
+        return h == Handler::JMP || h == Handler::CALL || h == Handler::JE
+            || h == Handler::JNE || h == Handler::JG || h == Handler::JL;
+    };
+    for (auto& d : program->code) {
+        if (jumps(d.handler))
+            d.target = static_cast<uint32_t>(program->indexOf[d.a1]);
+    }
+
+    // ----------- Basic blocks -----------
+    // A block starts at the entry, at every jump/call target, after every
+    // control transfer and after a gap in the addresses.
+    const size_t n = program->code.size();
+    std::vector<bool> leader(n + 1, false);
+    leader[0] = true;
+    leader[n] = true;
+    for (size_t i = 0; i < n; ++i) {
+        const DecodedInstruction& d = program->code[i];
+        switch (d.handler) {
+            case Handler::JMP: case Handler::CALL:
+            case Handler::JE: case Handler::JNE: case Handler::JG: case Handler::JL:
+                leader[d.target] = true;
+                leader[i + 1] = true;
+                break;
+            case Handler::RET: case Handler::HLT:
+                leader[i + 1] = true;
+                break;
+            default:
+                if (i + 1 < n && program->code[i + 1].ip != d.next) leader[i + 1] = true;
+                break;
+        }
+    }
+
+    program->blockOf.assign(n, 0);
+    for (size_t i = 0; i < n; ++i) {
+        if (leader[i]) {
+            BasicBlock b;
+            b.start = static_cast<uint32_t>(i);
+            program->blocks.push_back(b);
+        }
+        program->blocks.back().end = static_cast<uint32_t>(i + 1);
+        program->blockOf[i] = static_cast<uint32_t>(program->blocks.size() - 1);
+    }
+
+    // Chain jump/call blocks to their target block
+    for (auto& b : program->blocks) {
+        const DecodedInstruction& last = program->code[b.end - 1];
+        if (jumps(last.handler))
+            b.taken = program->blockOf[last.target];
+    }
+
+    return program;
+}
@@ -0,0 +1,140 @@
+// RohitVerifier.hpp
+#pragma once  // Ensures this header is only included once during compilation
+
+#include <cstdint>      // For fixed-width integer types like uint16_t
+#include <vector>       // For storing the decoded instruction stream
+#include <memory>       // For std::shared_ptr (verified programs can be shared)
+#include <string>       // For the verification error message
+
+#include "RohitVM.hpp"  // Opcode, Instruction and VM::getInstructionSize
+
+// ===========================================================================
+// Author: Rohit Yadav
+// Description: Load-time verifier for RohitVM programs.
+//              It walks the program bytes once, before execution, and proves
+//              that the runtime checks done by the normal interpreter
+//              (stack bounds, register operands, illegal opcodes, division
+//              by zero) cannot fire. A program that passes is run on a
+//              specialized handler set that skips those checks.
+
+// ===========================================================================
+// ENUM: Handler
+// The specialized handler set used for verified programs.
+// Every entry does exactly one thing, so the handlers don't need to
+// re-check anything the verifier has already proven.
+// CALL is verified as two edges: into the callee (with the return address
+// pushed) and to the return point (assuming the callee returns with the
+// stack balanced). RET is checked at runtime against that assumption.
+// ===========================================================================
+
+enum class Handler : uint8_t {
+    NOP, HLT,
+
+    // MOV, already split by destination register
+    MOV_AX, MOV_BX, MOV_CX, MOV_DX, MOV_SP,
+
+    // Flag set/clear
+    STE, CLE, STG, CLG, STH, CLH, STL, CLL,
+
+    // PUSH/POP, split by register so there's no register switch at runtime
+    PUSH_AX, PUSH_BX, PUSH_CX, PUSH_DX,
+    POP_AX, POP_BX, POP_CX, POP_DX,
+    PUSHF, POPF,
+
+    // Arithmetic
+    ADD, SUB, MUL,
+    DIV,          // BX proven non-zero: no check
+    DIV_CHECKED,  // BX not known: keeps the division-by-zero check
+    CMP,
+
+    // Control flow: JMP/CALL/Jcc targets are resolved to decoded-stream indexes
+    JMP, CALL,
+    RET,          // Target comes from the stack: must be a verified return point (checked at runtime)
+    JE, JNE, JG, JL,
+
+    // IN/OUT, split by register like PUSH/POP (the port is in a2)
+    IN_AX, IN_BX, IN_CX, IN_DX,
+    OUT_AX, OUT_BX, OUT_CX, OUT_DX,
+
+    // Block instructions: the bounds of the block (CX, DX) are checked at runtime
+    BSWAP16, BSWAP32, BSWAP64,
+
+    // BRK, and what the debugger patches over an instruction to break on it
+    BREAK
+};
+
+// ===========================================================================
+// STRUCT: DecodedInstruction
+// One instruction of a verified program, already decoded from memory.
+// ===========================================================================
+
+struct DecodedInstruction {
+    Handler handler;   // Which specialized handler runs this instruction
+    Opcode op;         // Original opcode (for debugging and reports)
+    uint16_t a1 = 0;   // First operand
+    uint16_t a2 = 0;   // Second operand (Jcc: the flag it tests)
+    uint16_t ip = 0;   // Address of this instruction in memory
+    uint16_t next = 0; // Address of the instruction that follows it
+    uint16_t sp = 0;   // SP the verifier proved on entry to this instruction
+    uint32_t target = 0; // JMP/CALL/Jcc: index of the target in the decoded stream
+};
+
+// ===========================================================================
+// STRUCT: BasicBlock
+// A run of decoded instructions that is only entered at the top and only
+// left at the bottom: it starts at a jump/call target or after a control
+// transfer, and ends before the next such start or after JMP/CALL/Jcc/RET/HLT.
+// The verified handlers check the budget and the profiler once per block
+// and chain straight into the successor block.
+// ===========================================================================
+
+struct BasicBlock {
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    uint32_t start = 0;     // Index of the first instruction in the decoded stream
+    uint32_t end = 0;       // One past the last one (a terminator is always code[end - 1])
+    uint32_t taken = NONE;  // Block a JMP/CALL/Jcc at the end transfers to (chained at verify time)
+    // The fall-through successor, when there is one, is always the next block
+};
+
+// ===========================================================================
+// STRUCT: VerifiedProgram
+// The result of a successful verification.
+// The decoded stream is stored in address order, so the fall-through
+// successor of code[i] is always code[i + 1].
+// ===========================================================================
+
+struct VerifiedProgram {
+    std::vector<DecodedInstruction> code; // Reachable instructions, in address order
+    std::vector<int32_t> indexOf;         // Address -> index in 'code' (-1 = not an instruction start)
+    std::vector<BasicBlock> blocks;       // Basic blocks, in address order
+    std::vector<uint32_t> blockOf;        // Index in 'code' -> index in 'blocks'
+    uint16_t entryIp = 0;      // IP the proof was done for
+    uint16_t entrySp = 0;      // SP the proof was done for
+    uint16_t imageSize = 0;    // Number of program bytes that were verified
+    uint32_t memorySize = 0;   // Bytes of memory the stack proofs assumed
+    uint16_t minSp = 0;        // Lowest SP reached on any path (stack depth bound)
+    uint16_t maxSp = 0;        // Highest SP reached on any path
+    size_t checksRemoved = 0;  // Runtime checks proven unnecessary
+    size_t checksKept = 0;     // Runtime checks that still have to run (DIV_CHECKED, BSWAP bounds)
+};
+
+// ===========================================================================
+// CLASS: Verifier
+// Proves properties of a program image. Verification fails (returns nullptr)
+// whenever any reachable instruction could hit one of the interpreter's
+// fatal errors other than division by zero; such programs simply keep
+// running on the normal, fully checked interpreter.
+// ===========================================================================
+
+class Verifier {
+public:
+    // Verify the program stored in image[0 .. size) when started with the
+    // given IP and SP, in a memory of 'memorySize' bytes (a PagedVM can
+    // have less than the full 64 KiB). On failure, 'error' (if given)
+    // describes the reason.
+    static std::shared_ptr<const VerifiedProgram> verify(const uint8_t* image, uint16_t size,
+                                                         uint16_t entryIp, uint16_t entrySp,
+                                                         std::string* error = nullptr,
+                                                         uint32_t memorySize = Memory::SIZE);
+};
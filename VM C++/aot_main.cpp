@@ -0,0 +1,35 @@
+// aot_main.cpp
+// Command-line front end for the ahead-of-time translator.
+// Reads a raw RohitVM program image (the bytes VM::loadProgram writes to
+// memory, starting at address 0) and prints the generated C++ to stdout.
+//
+// Usage: rohit-aot <image.bin> [function_name] > program.cpp
+
+#include "RohitAOT.hpp"    // AotTranslator
+#include <fstream>         // For reading the image file
+#include <iostream>        // For std::cout / std::cerr
+#include <iterator>        // For std::istreambuf_iterator
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <image.bin> [function_name]\n";
+        return 1;
+    }
+
+    std::ifstream in(argv[1], std::ios::binary);
+    if (!in) {
+        std::cerr << "Cannot open " << argv[1] << "\n";
+        return 1;
+    }
+    std::vector<uint8_t> image((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    // The image has to fit in the 16-bit address space
+    if (image.size() >= Memory::SIZE) {
+        std::cerr << "Image too large (" << image.size() << " bytes)\n";
+        return 1;
+    }
+
+    std::string name = argc > 2 ? argv[2] : "rohit_program";
+    std::cout << AotTranslator::translate(image.data(), static_cast<uint16_t>(image.size()), name);
+    return 0;
+}
@@ -0,0 +1,121 @@
+// batch_main.cpp
+// Runs a batch of jobs on the multi-process executor (RohitSupervisor.hpp)
+// and prints the aggregate results and how each worker did. The crash
+// options make the worker processes die on purpose, to watch the
+// supervisor restart them and re-run their jobs.
+//
+// Usage: rohit-batch [options]
+//          --workers <n>        Worker processes (default: one per hardware thread)
+//          --jobs <n>           Jobs in the batch (default 100000)
+//          --depth <n>          Jobs in flight per worker (default 8)
+//          --program <p>        tiny (default) or loop:<n> (AX counts up to n)
+//          --budget <n>         Instruction budget per job (default 1000000)
+//          --crash-rate <p>     Each job kills its worker with probability p (abort())
+//          --poison <i>         Job i kills every worker that runs it
+//          --timeout <ms>       Kill a worker stuck on one job this long
+//          --batches <n>        Run the batch n times on the same workers (default 1)
+
+#include "RohitSupervisor.hpp"  // BatchSupervisor
+#include <cstdio>               // For printf
+#include <cstdlib>              // For strtoull / strtod / abort
+#include <iostream>             // For std::cerr
+#include <random>               // For --crash-rate
+
+int main(int argc, char** argv) {
+    BatchSupervisor::Options options;
+    uint64_t jobs = 100000, budget = 1000000, poison = UINT64_MAX, batches = 1;
+    double crashRate = 0;
+    std::string program = "tiny";
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string name = argv[i];
+        const char* value = argv[i + 1];
+        if (name == "--workers") options.workers = strtoull(value, nullptr, 0);
+        else if (name == "--jobs") jobs = strtoull(value, nullptr, 0);
+        else if (name == "--depth") options.depth = strtoull(value, nullptr, 0);
+        else if (name == "--program") program = value;
+        else if (name == "--budget") budget = strtoull(value, nullptr, 0);
+        else if (name == "--crash-rate") crashRate = strtod(value, nullptr);
+        else if (name == "--poison") poison = strtoull(value, nullptr, 0);
+        else if (name == "--timeout") options.jobTimeoutMs = static_cast<unsigned>(strtoul(value, nullptr, 0));
+        else if (name == "--batches") batches = std::max<uint64_t>(1, strtoull(value, nullptr, 0));
+        else {
+            std::cerr << "Unknown option " << name << "\n";
+            return 1;
+        }
+    }
+    if (argc % 2 == 0) {
+        std::cerr << "Usage: " << argv[0] << " [--workers n] [--jobs n] [--depth n] [--program tiny|loop:<n>]"
+                  << " [--budget n] [--crash-rate p] [--poison i] [--timeout ms] [--batches n]\n";
+        return 1;
+    }
+
+    // The programs halt with a known AX, so every response can be checked
+    std::vector<Instruction> code;
+    uint16_t expectedAx;
+    if (program.rfind("loop:", 0) == 0) {
+        expectedAx = static_cast<uint16_t>(strtoul(program.c_str() + 5, nullptr, 0));
+        code = {{Opcode::MOV, 0},
+                {Opcode::MOV_BX, 1}, {Opcode::ADD}, {Opcode::MOV_BX, expectedAx}, {Opcode::CMP},
+                {Opcode::JNE, 3}, {Opcode::HLT}};
+    } else {
+        expectedAx = 30;
+        code = {{Opcode::MOV, 20}, {Opcode::MOV_BX, 10}, {Opcode::ADD}, {Opcode::OUT, 0, 1}, {Opcode::HLT}};
+    }
+    std::vector<JobRequest> batch(jobs);
+    for (JobRequest& job : batch) {
+        job.budget = budget;
+        job.image = VM::encode(code);
+    }
+
+    // Runs in the worker processes (each seeds its own generator on first use)
+    if (crashRate > 0 || poison != UINT64_MAX) {
+        options.beforeJob = [crashRate, poison](const JobRequest& request) {
+            static std::mt19937_64 random(std::random_device{}());
+            if (request.id == poison) abort();
+            if (crashRate > 0 && std::uniform_real_distribution<double>(0, 1)(random) < crashRate) abort();
+        };
+    }
+
+    BatchSupervisor supervisor(options);
+    int exitCode = 0;
+    for (uint64_t b = 0; b < batches; ++b) {
+        BatchResult result = supervisor.run(batch);
+
+        uint64_t byStatus[RUN_STATUS_COUNT] = {}, failed = 0, wrong = 0, instructions = 0;
+        for (size_t i = 0; i < batch.size(); ++i) {
+            if (result.failed[i]) {
+                failed++;
+                continue;
+            }
+            const JobResponse& r = result.responses[i];
+            byStatus[static_cast<int>(r.status)]++;
+            instructions += r.instructions;
+            if (r.status != RunStatus::Halted || r.regs.ax != expectedAx || r.id != i) wrong++;
+        }
+
+        printf("%zu jobs on %zu workers in %.2f s: %.0f jobs/sec, %llu instructions\n", batch.size(),
+               supervisor.workerCount(), result.seconds, result.completed / result.seconds,
+               static_cast<unsigned long long>(instructions));
+        static const char* names[] = {"halted", "budget", "waiting", "breakpoint", "trapped", "code"};
+        static_assert(sizeof(names) / sizeof(names[0]) == RUN_STATUS_COUNT, "One name per RunStatus");
+        printf(" ");
+        for (size_t s = 0; s < RUN_STATUS_COUNT; ++s)
+            printf(" %s=%llu", names[s], static_cast<unsigned long long>(byStatus[s]));
+        printf(" failed=%llu\n", static_cast<unsigned long long>(failed));
+        printf("  %llu worker crashes, %llu jobs re-queued, %llu restarts so far\n",
+               static_cast<unsigned long long>(result.crashes), static_cast<unsigned long long>(result.requeued),
+               static_cast<unsigned long long>(supervisor.restarts()));
+        for (size_t w = 0; w < result.workers.size(); ++w) {
+            const BatchResult::Worker& worker = result.workers[w];
+            printf("  worker %zu: %llu jobs (%.0f/s), %llu instructions, %llu crashes\n", w,
+                   static_cast<unsigned long long>(worker.jobs), worker.jobsPerSecond,
+                   static_cast<unsigned long long>(worker.instructions),
+                   static_cast<unsigned long long>(worker.crashes));
+        }
+        if (wrong) {
+            printf("  %llu responses with an unexpected result\n", static_cast<unsigned long long>(wrong));
+            exitCode = 1;
+        }
+    }
+    return exitCode;
+}
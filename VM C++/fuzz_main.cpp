@@ -0,0 +1,125 @@
+// fuzz_main.cpp
+// Command-line front end for the differential fuzzer (RohitFuzz.hpp).
+//
+// Usage: rohit-fuzz <input>...            Check each file (AFL: rohit-fuzz @@)
+//        rohit-fuzz                       Check one input read from stdin
+//        rohit-fuzz --random <count> [seed]
+//                                         Check <count> random inputs, printing
+//                                         execs/sec as it goes; a mismatching
+//                                         input is saved as crash-<n>.bin
+//
+// Exits with 1 (after printing the report) on the first mismatch.
+//
+// libFuzzer: clang++ -std=c++17 -g -O1 -fsanitize=fuzzer,address
+//                    -DROHIT_LIBFUZZER fuzz_main.cpp Rohit*.cpp -o rohit-fuzz-lf
+
+#include "RohitFuzz.hpp"   // DifferentialFuzzer
+#include <chrono>          // For execs/sec
+#include <cstdlib>         // For abort / strtoull
+#include <cstring>         // For strcmp
+#include <fstream>         // For input and crash files
+#include <iostream>        // For std::cout / std::cerr
+#include <iterator>        // For std::istreambuf_iterator
+#include <random>          // For --random
+
+// libFuzzer entry point: one fuzzer for the whole process, abort on mismatch
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    static DifferentialFuzzer fuzzer;
+    std::string report;
+    if (!fuzzer.check(data, size, &report)) {
+        std::cerr << report;
+        abort();
+    }
+    return 0;
+}
+
+#ifndef ROHIT_LIBFUZZER
+
+namespace {
+
+    // -------------------------------
+    // Function: checkOne
+    // Purpose: Checks one input; prints the report and returns false on a mismatch
+    bool checkOne(DifferentialFuzzer& fuzzer, const std::vector<uint8_t>& input, const std::string& name) {
+        std::string report;
+        if (fuzzer.check(input.data(), input.size(), &report)) return true;
+        std::cerr << name << ": " << report;
+        return false;
+    }
+
+    // -------------------------------
+    // Function: printSummary
+    void printSummary(const DifferentialFuzzer& fuzzer, double seconds) {
+        static const char* names[] = {"halted", "budget", "waiting", "breakpoint", "trapped", "code"};
+        static_assert(sizeof(names) / sizeof(names[0]) == RUN_STATUS_COUNT, "One name per RunStatus");
+        std::cout << fuzzer.executions << " inputs in " << seconds << " s ("
+                  << static_cast<uint64_t>(fuzzer.executions / (seconds > 0 ? seconds : 1)) << " execs/sec), "
+                  << fuzzer.mismatches << " mismatches\n  reference:";
+        for (size_t i = 0; i < RUN_STATUS_COUNT; ++i) std::cout << " " << names[i] << "=" << fuzzer.byStatus[i];
+        std::cout << "\n  engines:";
+        for (const auto& engine : fuzzer.engineStats()) std::cout << " " << engine.name << "=" << engine.runs;
+        std::cout << "\n";
+    }
+
+    // -------------------------------
+    // Function: randomMode
+    // Purpose: Stand-alone fuzzing with random inputs (no coverage feedback)
+    int randomMode(uint64_t count, uint64_t seed) {
+        DifferentialFuzzer fuzzer;
+        std::mt19937_64 rng(seed);
+        std::vector<uint8_t> input;
+
+        auto start = std::chrono::steady_clock::now();
+        auto lastReport = start;
+        for (uint64_t i = 0; i < count; ++i) {
+            input.resize(rng() % 512);
+            for (uint8_t& byte : input) byte = static_cast<uint8_t>(rng());
+
+            if (!checkOne(fuzzer, input, "random input " + std::to_string(i))) {
+                std::string file = "crash-" + std::to_string(i) + ".bin";
+                std::ofstream(file, std::ios::binary).write(reinterpret_cast<const char*>(input.data()), input.size());
+                std::cerr << "Input saved as " << file << "\n";
+                return 1;
+            }
+
+            auto now = std::chrono::steady_clock::now();
+            if (now - lastReport >= std::chrono::seconds(1)) {
+                double seconds = std::chrono::duration<double>(now - start).count();
+                std::cout << "#" << fuzzer.executions << " execs/sec: "
+                          << static_cast<uint64_t>(fuzzer.executions / seconds) << "\n";
+                lastReport = now;
+            }
+        }
+        printSummary(fuzzer, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        return 0;
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc >= 2 && strcmp(argv[1], "--random") == 0) {
+        if (argc < 3) {
+            std::cerr << "Usage: " << argv[0] << " --random <count> [seed]\n";
+            return 1;
+        }
+        return randomMode(strtoull(argv[2], nullptr, 0), argc > 3 ? strtoull(argv[3], nullptr, 0) : 1);
+    }
+
+    DifferentialFuzzer fuzzer;
+    if (argc < 2) {
+        std::vector<uint8_t> input((std::istreambuf_iterator<char>(std::cin)), std::istreambuf_iterator<char>());
+        return checkOne(fuzzer, input, "stdin") ? 0 : 1;
+    }
+    for (int i = 1; i < argc; ++i) {
+        std::ifstream in(argv[i], std::ios::binary);
+        if (!in) {
+            std::cerr << "Cannot open " << argv[i] << "\n";
+            return 1;
+        }
+        std::vector<uint8_t> input((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        if (!checkOne(fuzzer, input, argv[i])) return 1;
+    }
+    return 0;
+}
+
+#endif // ROHIT_LIBFUZZER
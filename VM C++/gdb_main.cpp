@@ -0,0 +1,59 @@
+// gdb_main.cpp
+// Command-line GDB server for RohitVM.
+// Loads a raw program image (the bytes VM::loadProgram writes to memory,
+// starting at address 0) into a 16-bit VM and waits for GDB to connect.
+//
+// Usage: rohit-gdbserver <image.bin> [port | unix-socket-path]
+//        (default: TCP port 1234 on 127.0.0.1; then "target remote :1234")
+
+#include "RohitDebugger.hpp" // Debugger, GdbStub
+#include "RohitVerifier.hpp" // Verifier (same fast path as loadProgram)
+#include <cstdlib>           // For std::atoi
+#include <cstring>           // For strerror
+#include <cerrno>            // For errno
+#include <fstream>           // For reading the image file
+#include <iostream>          // For std::cout / std::cerr
+#include <iterator>          // For std::istreambuf_iterator
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <image.bin> [port | unix-socket-path]\n";
+        return 1;
+    }
+
+    std::ifstream in(argv[1], std::ios::binary);
+    if (!in) {
+        std::cerr << "Cannot open " << argv[1] << "\n";
+        return 1;
+    }
+    std::vector<uint8_t> image((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    // The image has to fit in the 16-bit address space
+    if (image.size() >= Memory::SIZE) {
+        std::cerr << "Image too large (" << image.size() << " bytes)\n";
+        return 1;
+    }
+
+    VM vm;
+    for (uint8_t byte : image) vm.memory.poke(vm.breakLine++, byte);
+    vm.verified = Verifier::verify(image.data(), vm.breakLine, vm.cpu.r.ip, vm.cpu.r.sp);
+
+    Debugger dbg(vm);
+    GdbStub stub(dbg);
+
+    std::string where = argc > 2 ? argv[2] : "1234";
+    bool isPort = where.find_first_not_of("0123456789") == std::string::npos;
+    bool ok = isPort ? stub.listenTcp(static_cast<uint16_t>(std::atoi(where.c_str())))
+                     : stub.listenUnix(where);
+    if (!ok) {
+        std::cerr << "Cannot listen on " << where << ": " << strerror(errno) << "\n";
+        return 1;
+    }
+
+    std::cout << "Listening on " << (isPort ? "127.0.0.1:" : "") << where << "\n";
+    if (!stub.serve()) {
+        std::cerr << "Connection failed: " << strerror(errno) << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,226 @@
+// loadgen_main.cpp
+// Load generator for rohit-server. Opens several connections, keeps a
+// fixed number of requests in flight on each, checks every response, and
+// prints requests/sec and the p50 / p90 / p99 / p99.9 / max latency (time
+// from sending a request to reading its response).
+//
+// Usage: rohit-loadgen <unix-socket-path> [options]
+//          --connections <n>    Client connections, one thread each (default 4)
+//          --depth <n>          Requests in flight per connection (default 1)
+//          --requests <n>       Requests per connection (default 100000)
+//          --program <p>        tiny (default: a few instructions),
+//                               loop:<n> (n iterations of a 5-instruction loop),
+//                               or a raw image file
+//          --budget <n>         Instruction budget per request (default 1000000)
+//          --distinct <n>       Start each request with DX drawn at random from
+//                               n values (the programs ignore DX), so a server
+//                               run with --memoize sees about 1 - n/requests
+//                               repeats (default 0: every request the same)
+
+#include "RohitServer.hpp"  // JobRequest / JobResponse / JobWire
+#include <algorithm>        // For std::sort
+#include <cerrno>           // For errno
+#include <chrono>           // For latencies
+#include <cstdlib>          // For strtoull
+#include <cstring>          // For strcmp / strncpy / strerror
+#include <fstream>          // For --program <file>
+#include <iostream>         // For std::cout / std::cerr
+#include <iterator>         // For std::istreambuf_iterator
+#include <sys/socket.h>     // socket, connect
+#include <sys/un.h>         // sockaddr_un
+#include <unistd.h>         // close
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        std::string path;
+        size_t connections = 4;
+        size_t depth = 1;
+        uint64_t requests = 100000;
+        uint64_t budget = 1000000;
+        uint64_t distinct = 0;
+        std::vector<uint8_t> image;
+        uint16_t expectedAx = 0;   // AX the built-in programs halt with
+        bool checkAx = false;
+    };
+
+    // Per connection: latencies in nanoseconds and anything that went wrong
+    struct Result {
+        std::vector<uint64_t> latencies;
+        uint64_t bad = 0;          // Responses that didn't halt with the expected AX
+        std::string error;         // Socket / protocol failure (stops the connection)
+    };
+
+    // -------------------------------
+    // Function: builtin
+    // Purpose: The built-in programs: "tiny" and "loop:<n>"
+    bool builtin(const std::string& name, Options& options) {
+        std::vector<Instruction> program;
+        if (name == "tiny") {
+            program = {{Opcode::MOV, 20}, {Opcode::MOV_BX, 10}, {Opcode::ADD}, {Opcode::OUT, 0, 1}, {Opcode::HLT}};
+            options.expectedAx = 30;
+        } else if (name.rfind("loop:", 0) == 0) {
+            // AX counts up to n: MOV BX,1; ADD; MOV BX,n; CMP; JNE top
+            uint16_t n = static_cast<uint16_t>(strtoul(name.c_str() + 5, nullptr, 0));
+            if (n == 0) return false;
+            program = {{Opcode::MOV, 0},
+                       {Opcode::MOV_BX, 1}, {Opcode::ADD}, {Opcode::MOV_BX, n}, {Opcode::CMP},
+                       {Opcode::JNE, 3}, {Opcode::HLT}};
+            options.expectedAx = n;
+        } else {
+            return false;
+        }
+        options.image = VM::encode(program);
+        options.checkAx = true;
+        return true;
+    }
+
+    // -------------------------------
+    // Function: connectUnix
+    int connectUnix(const std::string& path) {
+        sockaddr_un addr{};
+        if (path.size() >= sizeof(addr.sun_path)) return -1;
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) return -1;
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    // -------------------------------
+    // Function: client
+    // Purpose: One connection: 'depth' requests in flight, a new one sent
+    // for every response, until 'requests' have been answered. Request ids
+    // index the send times, so responses may come back in any order.
+    void client(const Options& options, Result& result) {
+        int fd = connectUnix(options.path);
+        if (fd < 0) {
+            result.error = std::string("connect: ") + strerror(errno);
+            return;
+        }
+
+        std::vector<Clock::time_point> sentAt(options.requests);
+        result.latencies.reserve(options.requests);
+
+        JobRequest request;
+        request.budget = options.budget;
+        request.image = options.image;
+        std::vector<uint8_t> frame;
+        uint64_t sent = 0;
+        uint64_t random = reinterpret_cast<uintptr_t>(&result) | 1;   // xorshift state, different per connection
+        auto sendBatch = [&](uint64_t count) {
+            frame.clear();
+            for (; count > 0 && sent < options.requests; --count, ++sent) {
+                request.id = static_cast<uint32_t>(sent);
+                if (options.distinct) {
+                    random ^= random << 13;
+                    random ^= random >> 7;
+                    random ^= random << 17;
+                    request.regs.dx = static_cast<uint16_t>(random % options.distinct);
+                }
+                JobWire::encode(request, frame);
+                sentAt[sent] = Clock::now();
+            }
+            return JobWire::sendAll(fd, frame.data(), frame.size());
+        };
+
+        JobWire::Reader reader(fd);
+        JobResponse response;
+        const uint8_t* body;
+        size_t size;
+        if (!sendBatch(options.depth)) result.error = "send failed";
+        while (result.error.empty() && result.latencies.size() < options.requests) {
+            if (!reader.next(body, size, size_t(1) << 20) || !JobWire::decode(body, size, response) ||
+                response.id >= sent) {
+                result.error = "bad or missing response";
+                break;
+            }
+            result.latencies.push_back(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - sentAt[response.id]).count()));
+            if (options.checkAx && (response.status != RunStatus::Halted || response.regs.ax != options.expectedAx))
+                result.bad++;
+            if (!sendBatch(1)) result.error = "send failed";
+        }
+        close(fd);
+    }
+
+    // -------------------------------
+    // Function: percentile
+    double percentile(const std::vector<uint64_t>& sorted, double p) {
+        if (sorted.empty()) return 0;
+        size_t index = static_cast<size_t>(p / 100 * (sorted.size() - 1) + 0.5);
+        return sorted[index] / 1000.0;   // Microseconds
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <unix-socket-path> [--connections n] [--depth n]"
+                  << " [--requests n] [--program tiny|loop:<n>|<image.bin>] [--budget n] [--distinct n]\n";
+        return 1;
+    }
+
+    Options options;
+    options.path = argv[1];
+    builtin("tiny", options);
+    for (int i = 2; i + 1 < argc; i += 2) {
+        std::string name = argv[i];
+        const char* value = argv[i + 1];
+        if (name == "--connections") options.connections = std::max<size_t>(1, strtoull(value, nullptr, 0));
+        else if (name == "--depth") options.depth = std::max<size_t>(1, strtoull(value, nullptr, 0));
+        else if (name == "--requests") options.requests = std::max<uint64_t>(1, strtoull(value, nullptr, 0));
+        else if (name == "--budget") options.budget = strtoull(value, nullptr, 0);
+        else if (name == "--distinct") options.distinct = std::min<uint64_t>(strtoull(value, nullptr, 0), 65536);
+        else if (name == "--program") {
+            if (!builtin(value, options)) {
+                std::ifstream in(value, std::ios::binary);
+                if (!in) {
+                    std::cerr << "Cannot open " << value << "\n";
+                    return 1;
+                }
+                options.image.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+                options.checkAx = false;
+                if (options.image.size() >= Memory::SIZE) {
+                    std::cerr << "Image too large (" << options.image.size() << " bytes)\n";
+                    return 1;
+                }
+            }
+        } else {
+            std::cerr << "Unknown option " << name << "\n";
+            return 1;
+        }
+    }
+
+    std::vector<Result> results(options.connections);
+    std::vector<std::thread> threads;
+    auto start = Clock::now();
+    for (size_t i = 0; i < options.connections; ++i)
+        threads.emplace_back([&, i] { client(options, results[i]); });
+    for (std::thread& t : threads) t.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<uint64_t> all;
+    uint64_t bad = 0;
+    for (const Result& r : results) {
+        if (!r.error.empty()) std::cerr << "Connection failed: " << r.error << "\n";
+        all.insert(all.end(), r.latencies.begin(), r.latencies.end());
+        bad += r.bad;
+    }
+    std::sort(all.begin(), all.end());
+
+    printf("%zu connections x depth %zu, %zu-byte program: %zu requests in %.2f s\n",
+           options.connections, options.depth, options.image.size(), all.size(), seconds);
+    printf("  %.0f requests/sec\n", all.size() / seconds);
+    printf("  latency us: p50 %.1f  p90 %.1f  p99 %.1f  p99.9 %.1f  max %.1f\n",
+           percentile(all, 50), percentile(all, 90), percentile(all, 99), percentile(all, 99.9),
+           all.empty() ? 0.0 : all.back() / 1000.0);
+    if (bad) printf("  %llu responses with an unexpected result\n", static_cast<unsigned long long>(bad));
+    return bad == 0 && all.size() == options.connections * options.requests ? 0 : 1;
+}
@@ -21,6 +21,11 @@ std::string runProgram(const std::vector<Instruction>& prog, const std::string&
     out << "Running Program: " << title << "\n";
     out << "===============================\n";
 
+    // Values written with OUT are printed (nothing supplies IN data here)
+    vm.onOutput = [](uint16_t port, uint16_t value) {
+        std::cout << "OUT [port " << port << "]: " << value << "\n";
+    };
+
     vm.loadProgram(prog); // Load the program (set of instructions) into memory
     vm.execute();         // Begin execution of the program (fetch-decode-execute loop)
 
@@ -113,6 +118,34 @@ int main() {
                 {Opcode::HLT}
             }
         },
+        {
+            "Control Flow: JMP",
+            {
+                {Opcode::JMP, 0x0006},     // 0x0000: JMP 0x0006 (skip the next MOV)
+                {Opcode::MOV, 0xDEAD},     // 0x0003: MOV AX, 0xDEAD (never runs)
+                {Opcode::MOV, 0x0001},     // 0x0006: MOV AX, 0x0001
+                {Opcode::HLT}              // 0x0009: HLT
+            }
+        },
+        {
+            "Control Flow: CALL & RET",
+            {
+                {Opcode::MOV, 0x0005},     // 0x0000: MOV AX, 0x0005
+                {Opcode::CALL, 0x0007},    // 0x0003: CALL 0x0007 (AX = AX * 3)
+                {Opcode::HLT},             // 0x0006: HLT
+                {Opcode::MOV_BX, 0x0003},  // 0x0007: MOV BX, 0x0003
+                {Opcode::MUL},             // 0x000A: AX = AX * BX
+                {Opcode::RET}              // 0x000B: RET (back to 0x0006)
+            }
+        },
+        {
+            "I/O: OUT",
+            {
+                {Opcode::MOV, 0x002A},     // MOV AX, 0x002A
+                {Opcode::OUT, 0x00, 0x0001}, // OUT AX, port 1 (printed by runProgram)
+                {Opcode::HLT}
+            }
+        },
         {
             "Arithmetic: DIV by zero (error)",
             {
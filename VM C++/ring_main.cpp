@@ -0,0 +1,159 @@
+// ring_main.cpp
+// Command-line front end for the shared-memory job ring (RohitRing.hpp).
+//
+// Usage: rohit-ring serve <name> [workers] [slots] [--memoize]
+//            Creates the ring (e.g. /rohit-jobs) and runs jobs from it until
+//            SIGINT or SIGTERM, then prints how many it ran. --memoize
+//            answers repeated jobs from a ResultCache (RohitCache.hpp).
+//        rohit-ring bench <name|-> [jobs] [inflight] [workers]
+//            Submits small jobs (AX = 20 + 10) to a ring served by another
+//            process, keeping 'inflight' of them outstanding, checks every
+//            result and prints the cost of a submission (acquire + fill +
+//            submit), jobs/sec and round-trip latency percentiles. With "-"
+//            it creates a private ring and serves it in-process.
+
+#include "RohitRing.hpp"    // JobRing / RingWorkers
+#include "RohitCache.hpp"   // ResultCache (--memoize)
+#include <algorithm>        // For std::sort
+#include <cerrno>           // For errno
+#include <chrono>           // For timings
+#include <csignal>          // For sigwait
+#include <cstdio>           // For printf
+#include <cstdlib>          // For strtoul
+#include <cstring>          // For memcpy / strcmp / strerror
+#include <iostream>         // For std::cout / std::cerr
+#include <pthread.h>        // For pthread_sigmask
+#include <unistd.h>         // For getpid
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    uint64_t nanosSince(Clock::time_point start) {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+    }
+
+    double percentile(const std::vector<uint64_t>& sorted, double p) {
+        if (sorted.empty()) return 0;
+        size_t index = static_cast<size_t>(p / 100 * (sorted.size() - 1) + 0.5);
+        return sorted[index] / 1000.0;   // Microseconds
+    }
+
+    // -------------------------------
+    // Function: serve
+    int serve(const std::string& name, size_t workers, uint32_t slots, bool memoize) {
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGINT);
+        sigaddset(&signals, SIGTERM);
+        pthread_sigmask(SIG_BLOCK, &signals, nullptr);   // Inherited by the workers
+
+        std::unique_ptr<JobRing> ring = JobRing::create(name, slots);
+        if (!ring) {
+            std::cerr << "Cannot create " << name << ": " << strerror(errno) << "\n";
+            return 1;
+        }
+        std::unique_ptr<ResultCache> results(memoize ? new ResultCache() : nullptr);
+        RingWorkers pool(*ring, workers, results.get());
+        std::cout << "Serving " << name << " (" << ring->slots() << " slots of "
+                  << ring->imageCapacity() << " bytes)\n";
+
+        int signal;
+        sigwait(&signals, &signal);
+        ring->shutdown();
+        std::cout << pool.jobs << " jobs";
+        if (results) std::cout << ", " << results->stats().hits << " answered from the result cache";
+        std::cout << "\n";
+        return 0;
+    }
+
+    // -------------------------------
+    // Function: bench
+    // Purpose: Tags index the submit times, so completions may come back in
+    // any order
+    int bench(const std::string& name, uint64_t jobs, size_t inflight, size_t workers) {
+        std::unique_ptr<JobRing> ring;
+        std::unique_ptr<RingWorkers> pool;
+        if (name == "-") {
+            ring = JobRing::create("/rohit-ring-" + std::to_string(getpid()), JobRing::DEFAULT_SLOTS, 256);
+            if (ring) pool.reset(new RingWorkers(*ring, workers));
+        } else {
+            ring = JobRing::open(name);
+        }
+        if (!ring) {
+            std::cerr << "Cannot open " << name << ": " << strerror(errno) << "\n";
+            return 1;
+        }
+        inflight = std::max<size_t>(1, std::min<size_t>(inflight, ring->slots()));
+
+        const std::vector<uint8_t> image = VM::encode(
+            {{Opcode::MOV, 20}, {Opcode::MOV_BX, 10}, {Opcode::ADD}, {Opcode::OUT, 0, 1}, {Opcode::HLT}});
+
+        std::vector<Clock::time_point> sentAt(jobs);
+        std::vector<uint64_t> latencies;
+        latencies.reserve(jobs);
+        uint64_t submitNanos = 0, sent = 0, bad = 0;
+
+        auto submitOne = [&] {
+            auto start = Clock::now();
+            RingSlot* slot = ring->acquire();
+            if (!slot) return false;
+            memcpy(slot->image(), image.data(), image.size());
+            slot->imageSize = static_cast<uint32_t>(image.size());
+            slot->regs = Registers();
+            slot->budget = 1000;
+            slot->tag = sent;
+            sentAt[sent++] = start;
+            ring->submit(slot);
+            submitNanos += nanosSince(start);
+            return true;
+        };
+
+        auto begin = Clock::now();
+        while (sent < jobs && sent < inflight && submitOne()) {}
+        while (latencies.size() < sent) {
+            RingSlot* done = ring->wait();
+            if (!done) break;
+            if (done->tag >= sent) {   // Not one of ours: the ring routes completions by producer
+                bad++;
+                ring->release(done);
+                continue;
+            }
+            latencies.push_back(nanosSince(sentAt[done->tag]));
+            if (done->status != RunStatus::Halted || done->result.ax != 30 || done->outputs != 1) bad++;
+            ring->release(done);
+            if (sent < jobs) submitOne();
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+        std::sort(latencies.begin(), latencies.end());
+
+        printf("%zu jobs, %zu in flight, %zu-byte program, %.2f s\n",
+               latencies.size(), inflight, image.size(), seconds);
+        printf("  submit (acquire + fill + submit): %.0f ns\n", sent ? double(submitNanos) / sent : 0.0);
+        printf("  %.0f jobs/sec\n", latencies.size() / seconds);
+        printf("  round trip us: p50 %.1f  p90 %.1f  p99 %.1f  p99.9 %.1f  max %.1f\n",
+               percentile(latencies, 50), percentile(latencies, 90), percentile(latencies, 99),
+               percentile(latencies, 99.9), latencies.empty() ? 0.0 : latencies.back() / 1000.0);
+        if (bad) printf("  %llu jobs with an unexpected result\n", static_cast<unsigned long long>(bad));
+        return bad == 0 && latencies.size() == jobs ? 0 : 1;
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bool memoize = argc > 1 && strcmp(argv[argc - 1], "--memoize") == 0;
+    if (memoize) argc--;
+    std::string command = argc > 1 ? argv[1] : "";
+    if (argc < 3 || (command != "serve" && command != "bench")) {
+        std::cerr << "Usage: " << argv[0] << " serve <name> [workers] [slots] [--memoize]\n"
+                  << "       " << argv[0] << " bench <name|-> [jobs] [inflight] [workers]\n";
+        return 1;
+    }
+    auto arg = [&](int i, unsigned long fallback) {
+        return argc > i ? strtoul(argv[i], nullptr, 0) : fallback;
+    };
+    if (command == "serve")
+        return serve(argv[2], arg(3, 0), static_cast<uint32_t>(arg(4, JobRing::DEFAULT_SLOTS)), memoize);
+    return bench(argv[2], arg(3, 1000000), arg(4, 1), arg(5, 0));
+}
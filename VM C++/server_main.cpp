@@ -0,0 +1,81 @@
+// server_main.cpp
+// Command-line job server for RohitVM (see RohitServer.hpp for the protocol).
+// Runs until SIGINT or SIGTERM, then prints how many jobs it ran.
+//
+// Usage: rohit-server <unix-socket-path> [workers] [--memoize [MiB]]
+//        (default: one worker per hardware thread; --memoize answers
+//        repeated jobs from a result cache of that size, default 16 MiB)
+
+#include "RohitServer.hpp"  // JobServer
+#include "RohitCache.hpp"   // ProgramCache statistics, ResultCache
+#include <cctype>           // For isdigit
+#include <cerrno>           // For errno
+#include <csignal>          // For sigwait
+#include <cstdlib>          // For strtoul
+#include <cstring>          // For strcmp / strerror
+#include <iostream>         // For std::cout / std::cerr
+#include <pthread.h>        // For pthread_sigmask
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <unix-socket-path> [workers] [--memoize [MiB]]\n";
+        return 1;
+    }
+
+    size_t workers = 0;
+    std::unique_ptr<ResultCache> results;
+    for (int i = 2; i < argc; ++i) {
+        if (strcmp(argv[i], "--memoize") == 0) {
+            size_t mib = i + 1 < argc && isdigit(static_cast<unsigned char>(argv[i + 1][0]))
+                             ? strtoul(argv[++i], nullptr, 0) : ResultCache::DEFAULT_CAPACITY >> 20;
+            results.reset(new ResultCache(mib << 20));
+        } else {
+            workers = strtoul(argv[i], nullptr, 0);
+        }
+    }
+
+    // Every thread (the server's too) inherits this mask, so SIGINT/SIGTERM
+    // only ever reach the sigwait below, which stops the server cleanly
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    JobServer server(workers, results.get());
+    if (!server.listenUnix(argv[1])) {
+        std::cerr << "Cannot listen on " << argv[1] << ": " << strerror(errno) << "\n";
+        return 1;
+    }
+
+    std::thread waiter([&] {
+        int signal;
+        sigwait(&signals, &signal);
+        server.stop();
+    });
+
+    std::cout << "Listening on " << argv[1] << " with " << server.workerCount() << " workers\n";
+    bool ok = server.serve();
+    if (!ok) std::cerr << "Accept failed: " << strerror(errno) << "\n";
+
+    // serve() also returns on its own after an error: wake the waiter then
+    if (!ok) pthread_kill(waiter.native_handle(), SIGTERM);
+    waiter.join();
+
+    static const char* names[] = {"halted", "budget", "waiting", "breakpoint", "trapped", "code"};
+    static_assert(sizeof(names) / sizeof(names[0]) == RUN_STATUS_COUNT, "One name per RunStatus");
+    std::cout << server.jobs << " jobs, " << server.instructions << " instructions, "
+              << server.connections << " connections\n ";
+    for (size_t i = 0; i < RUN_STATUS_COUNT; ++i) std::cout << " " << names[i] << "=" << server.byStatus[i];
+    ProgramCache::Stats cache = ProgramCache::global().stats();
+    std::cout << "\nProgram cache: " << cache.hits << " hits, " << cache.misses << " misses, "
+              << cache.evictions << " evictions, " << cache.entries << " programs (" << cache.bytes / 1024 << " KiB)\n";
+    if (results) {
+        ResultCache::Stats memo = results->stats();
+        uint64_t lookups = memo.hits + memo.misses;
+        std::cout << "Result cache: " << memo.hits << " hits (" << (lookups ? memo.hits * 100 / lookups : 0)
+                  << "%), " << memo.misses << " misses, " << memo.evictions << " evictions, " << memo.entries
+                  << " results (" << memo.bytes / 1024 << " KiB)\n";
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,148 @@
+// stream_main.cpp
+// Runs a program image while it is still being read (RohitLoader.hpp).
+//
+// Usage: rohit-stream run <image.bin|-> [size]
+//            Streams the image (raw bytes as VM::encode makes them, loaded
+//            at address 0) from the file or stdin, runs it and prints the
+//            time to the first instruction, the total time and how often
+//            the program had to wait for its code. 'size' announces the
+//            image size when reading from a pipe.
+//        rohit-stream bench [delay-us]
+//            Feeds generated images of 4 to 63 KiB through a pipe, one
+//            chunk every 'delay-us' microseconds (default 100), and prints
+//            the time to the first instruction when streaming against
+//            reading the whole image first.
+
+#include "RohitLoader.hpp"   // StreamLoader
+#include "RohitVerifier.hpp" // Verifier (the read-it-all baseline)
+#include <chrono>            // For timings
+#include <cstdio>            // For printf
+#include <cstdlib>           // For strtoul
+#include <cstring>           // For strerror
+#include <cerrno>            // For errno
+#include <fcntl.h>           // For open
+#include <iostream>          // For std::cerr
+#include <sys/stat.h>        // For fstat
+#include <thread>            // The bench's writer
+#include <unistd.h>          // For pipe / read / write / close
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    double microsSince(Clock::time_point start) {
+        return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+    }
+
+    // -------------------------------
+    // Function: run
+    int run(const char* path, size_t size) {
+        int fd = strcmp(path, "-") == 0 ? 0 : open(path, O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "Cannot open " << path << ": " << strerror(errno) << "\n";
+            return 1;
+        }
+        struct stat st;
+        if (!size && fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) size = static_cast<size_t>(st.st_size);
+
+        VM vm;
+        StreamLoader loader(vm, size);
+        auto start = Clock::now();
+        RunStatus status = loader.run(fd, 1);   // Returns once the first instruction has run
+        double first = microsSince(start);
+        if (status == RunStatus::BudgetExhausted) status = loader.run(fd);
+        double total = microsSince(start);
+        while (!loader.complete() && loader.pull(fd, true) > 0) {}   // Count what was left unread
+        if (fd != 0) close(fd);
+
+        printf("%zu-byte image: first instruction after %.1f us, %s after %.1f us\n", loader.loaded(), first,
+               status == RunStatus::Halted ? "halted" : "stopped", total);
+        printf("  %llu instructions, %llu waits for code%s\n",
+               static_cast<unsigned long long>(vm.instructionsExecuted),
+               static_cast<unsigned long long>(loader.stalls),
+               vm.verified ? ", verified" : "");
+        printf("  AX: %u, BX: %u, CX: %u, DX: %u, SP: %u\n", vm.cpu.r.ax, vm.cpu.r.bx, vm.cpu.r.cx,
+               vm.cpu.r.dx, vm.cpu.r.sp);
+        if (status == RunStatus::Trapped) std::cerr << "Trapped: " << vm.trapMessage << "\n";
+        else if (status == RunStatus::WaitingForInput) std::cerr << "Waiting for input on port " << vm.ioPort << "\n";
+        return status == RunStatus::Halted ? 0 : 1;
+    }
+
+    // -------------------------------
+    // Function: feed
+    // Purpose: The bench's producer: the image, a chunk at a time
+    std::thread feed(int fd, const std::vector<uint8_t>& image, unsigned delayUs) {
+        return std::thread([fd, &image, delayUs] {
+            for (size_t at = 0; at < image.size(); at += StreamLoader::CHUNK) {
+                if (at) std::this_thread::sleep_for(std::chrono::microseconds(delayUs));
+                size_t n = std::min(StreamLoader::CHUNK, image.size() - at);
+                if (write(fd, image.data() + at, n) != static_cast<ssize_t>(n)) break;
+            }
+            close(fd);
+        });
+    }
+
+    // -------------------------------
+    // Function: bench
+    // Purpose: A NOP sled ending in HLT: the program catches up with the
+    // loader at every chunk, the worst case for streaming
+    int bench(unsigned delayUs) {
+        printf("%8s  %14s  %14s  %14s  %14s  %6s\n", "image", "stream first", "read-all first", "stream done",
+               "read-all done", "waits");
+        for (size_t kib : {4, 8, 16, 32, 63}) {
+            std::vector<uint8_t> image(std::min(kib * 1024, StreamLoader::MAX_IMAGE),
+                                       static_cast<uint8_t>(Opcode::NOP));
+            image.back() = static_cast<uint8_t>(Opcode::HLT);
+
+            // Streaming
+            int pipes[2];
+            if (pipe(pipes) != 0) return 1;
+            VM streamed;
+            std::thread writer = feed(pipes[1], image, delayUs);
+            auto start = Clock::now();
+            StreamLoader loader(streamed, image.size());
+            RunStatus status = loader.run(pipes[0], 1);
+            double streamFirst = microsSince(start);
+            if (status == RunStatus::BudgetExhausted) status = loader.run(pipes[0]);
+            double streamDone = microsSince(start);
+            writer.join();
+            close(pipes[0]);
+
+            // Read everything, verify, then run (what loadProgram needs)
+            if (pipe(pipes) != 0) return 1;
+            VM whole;
+            writer = feed(pipes[1], image, delayUs);
+            start = Clock::now();
+            size_t got = 0;
+            ssize_t n;
+            while ((n = read(pipes[0], whole.memory.raw() + got, image.size() - got)) > 0) got += n;
+            whole.breakLine = static_cast<uint16_t>(got);
+            whole.verified = Verifier::verify(whole.memory.raw(), whole.breakLine, whole.cpu.r.ip, whole.cpu.r.sp);
+            RunStatus wholeStatus = whole.run(1);
+            double wholeFirst = microsSince(start);
+            if (wholeStatus == RunStatus::BudgetExhausted) wholeStatus = whole.run();
+            double wholeDone = microsSince(start);
+            writer.join();
+            close(pipes[0]);
+
+            if (status != RunStatus::Halted || wholeStatus != RunStatus::Halted ||
+                streamed.instructionsExecuted != whole.instructionsExecuted) {
+                std::cerr << "Streamed and whole runs disagree at " << kib << " KiB\n";
+                return 1;
+            }
+            printf("%5zu KiB  %11.1f us  %11.1f us  %11.1f us  %11.1f us  %6llu\n", kib, streamFirst, wholeFirst,
+                   streamDone, wholeDone, static_cast<unsigned long long>(loader.stalls));
+        }
+        return 0;
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string command = argc > 1 ? argv[1] : "";
+    if (command == "run" && argc > 2) return run(argv[2], argc > 3 ? strtoul(argv[3], nullptr, 0) : 0);
+    if (command == "bench") return bench(argc > 2 ? static_cast<unsigned>(strtoul(argv[2], nullptr, 0)) : 100);
+    std::cerr << "Usage: " << argv[0] << " run <image.bin|-> [size]\n"
+              << "       " << argv[0] << " bench [delay-us]\n";
+    return 1;
+}